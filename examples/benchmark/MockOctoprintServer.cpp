@@ -0,0 +1,476 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "MockOctoprintServer.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "WebSocketConnection.h"
+
+namespace octoprint {
+namespace benchmark {
+
+namespace {
+
+constexpr size_t chunkSize = 256;
+constexpr unsigned historySamples = 300;
+constexpr unsigned smallFilesCount = 5;
+constexpr unsigned largeFilesCount = 200;
+
+std::string format(const char *pattern, ...) __attribute__((format(printf, 1, 2)));
+
+std::string format(const char *pattern, ...) {
+    char text[2048];
+    va_list args;
+    va_start(args, pattern);
+    vsnprintf(text, sizeof(text), pattern, args);
+    va_end(args);
+    return text;
+}
+
+std::string versionBody() {
+    return R"({"api":"0.1","server":"1.9.3","text":"OctoPrint 1.9.3"})";
+}
+
+std::string temperatureEntry(const char *heater, float actual, float target) {
+    return format(R"("%s":{"actual":%.2f,"offset":0,"target":%.1f})", heater, actual, target);
+}
+
+std::string printerBody(bool isLarge) {
+    std::string body = R"({"sd":{"ready":true},"state":{"error":"","flags":{"cancelling":false,"closedOrError":false,)"
+                       R"("error":false,"finishing":false,"operational":true,"paused":false,"pausing":false,)"
+                       R"("printing":true,"ready":false,"resuming":false,"sdReady":true},"text":"Printing"},)"
+                       R"("temperature":{)";
+    body += temperatureEntry("bed", 60.1f, 60.0f) + "," + temperatureEntry("tool0", 214.8f, 215.0f);
+    if (isLarge) {
+        body += "," + temperatureEntry("tool1", 24.3f, 0.0f) + "," + temperatureEntry("chamber", 31.7f, 0.0f);
+        body += R"(,"history":[)";
+        for (unsigned idx = 0; idx < historySamples; idx++) {
+            if (idx > 0) body += ",";
+            body += format(R"({"time":%u,)", 1700000000u + idx * 2);
+            body += temperatureEntry("bed", 59.5f + (idx % 10) * 0.1f, 60.0f) + ",";
+            body += temperatureEntry("tool0", 214.0f + (idx % 20) * 0.1f, 215.0f) + ",";
+            body += temperatureEntry("tool1", 24.3f, 0.0f) + "}";
+        }
+        body += "]";
+    }
+    body += "}}";
+    return body;
+}
+
+std::string jobBody(bool isLarge) {
+    const std::string name = isLarge
+                             ? "calibration/2023-11-14/very_long_descriptive_file_name_of_a_multi_part_assembly_"
+                               "with_supports_and_brim_0.2mm_PLA_215C_60C_8h47m_rev17.gcode"
+                             : "benchy.gcode";
+    std::string body = format(R"({"job":{"averagePrintTime":null,"estimatedPrintTime":8811.4,"filament":{)"
+                              R"("tool0":{"length":7281.6,"volume":17.5})");
+    if (isLarge) body += R"(,"tool1":{"length":1204.2,"volume":2.9},"tool2":{"length":0.0,"volume":0.0})";
+    body += format(R"(},"file":{"date":1700000000,"display":"%s","name":"%s","origin":"local","path":"%s",)"
+                   R"("size":3528451},"lastPrintTime":null,"user":"octo"},"progress":{"completion":42.7,)"
+                   R"("filepos":1506649,"printTime":3762,"printTimeLeft":5049,"printTimeLeftOrigin":"estimate"},)"
+                   R"("state":"Printing"})", name.c_str(), name.c_str(), name.c_str());
+    return body;
+}
+
+std::string filesBody(bool isLarge) {
+    const unsigned count = isLarge ? largeFilesCount : smallFilesCount;
+    std::string body = R"({"files":[)";
+    for (unsigned idx = 0; idx < count; idx++) {
+        if (idx > 0) body += ",";
+        body += format(R"({"date":%u,"display":"part_%03u.gcode","gcodeAnalysis":{"estimatedPrintTime":%u,)"
+                       R"("filament":{"tool0":{"length":%u.4,"volume":%u.2}}},"hash":"%040x","name":"part_%03u.gcode",)"
+                       R"("origin":"local","path":"part_%03u.gcode","prints":{"failure":0,"success":3},)"
+                       R"("refs":{"download":"http://127.0.0.1/downloads/files/local/part_%03u.gcode",)"
+                       R"("resource":"http://127.0.0.1/api/files/local/part_%03u.gcode"},"size":%u,)"
+                       R"("type":"machinecode","typePath":["machinecode","gcode"]})",
+                       1700000000u + idx, idx, 3600 + idx * 7, 1000 + idx, 2 + idx % 10, idx * 2654435761u, idx, idx,
+                       idx, idx, 100000 + idx * 1337);
+    }
+    body += R"(],"free":12876492800,"total":31025332224})";
+    return body;
+}
+
+std::string loginBody() {
+    return R"({"_is_external_client":false,"active":true,"admin":true,"apikey":null,"groups":["admins","users"],)"
+           R"("name":"octo","needs":{"group":["admins","users"],"role":["admin","connection","control","files",)"
+           R"("print","settings","status","timelapse","user"]},"permissions":[],"roles":["admin","user"],)"
+           R"("session":"5a7c2f0e9b6d4e1fa3c8b27d90e4f615","settings":{},"user":true})";
+}
+
+/**
+ * Push api state as in "current" and "history" messages, temperatures and progress advance with the tick.
+ * @param temps number of temperature samples, 1 for current messages
+ */
+std::string pushedState(unsigned tick, unsigned temps) {
+    std::string body = R"({"state":{"text":"Printing","flags":{"operational":true,"printing":true,)"
+                       R"("cancelling":false,"pausing":false,"resuming":false,"finishing":false,)"
+                       R"("closedOrError":false,"error":false,"paused":false,"ready":false,"sdReady":true},)"
+                       R"("error":""},"job":{"file":{"name":"benchy.gcode","path":"benchy.gcode",)"
+                       R"("display":"benchy.gcode","origin":"local","size":3528451,"date":1700000000},)"
+                       R"("estimatedPrintTime":8811.4,"averagePrintTime":null,"lastPrintTime":null,)"
+                       R"("filament":{"tool0":{"length":7281.6,"volume":17.5}},"user":"octo"},)";
+    body += format(R"("progress":{"completion":%.1f,"filepos":%u,"printTime":%u,"printTimeLeft":%u,)"
+                   R"("printTimeLeftOrigin":"estimate"},"currentZ":0.2,"offsets":{},"temps":[)",
+                   (tick % 1000) / 10.0, tick * 1000, tick, 8811 - tick % 8811);
+    for (unsigned idx = 0; idx < temps; idx++) {
+        const unsigned sample = tick + idx + 1 - temps;
+        if (idx > 0) body += ",";
+        body += format(R"({"time":%u,)", 1700000000u + sample);
+        body += temperatureEntry("bed", 59.5f + (sample % 10) * 0.1f, 60.0f) + ",";
+        body += temperatureEntry("tool0", 214.0f + (sample % 20) * 0.1f, 215.0f) + "}";
+    }
+    body += R"(],"logs":[],"messages":[],"busyFiles":[],"markings":[],"resends":{"count":0,"transmitted":0,)"
+            R"("ratio":0}})";
+    return body;
+}
+
+std::string webSocketFrame(uint8_t opcode, const std::string &payload) {
+    std::string frame(1, static_cast<char>(0x80 | opcode));
+    if (payload.size() < 126) {
+        frame += static_cast<char>(payload.size());
+    } else if (payload.size() <= 0xffff) {
+        frame += static_cast<char>(126);
+        frame += static_cast<char>(payload.size() >> 8);
+        frame += static_cast<char>(payload.size() & 0xff);
+    } else {
+        frame += static_cast<char>(127);
+        for (int shift = 56; shift >= 0; shift -= 8) frame += static_cast<char>((payload.size() >> shift) & 0xff);
+    }
+    return frame + payload;
+}
+
+/**
+ * Takes the first complete client frame off the buffer.
+ * @return false if the buffer does not hold a complete frame yet
+ */
+bool takeWebSocketFrame(std::string &buffer, uint8_t &opcode, std::string &payload) {
+    if (buffer.size() < 2) return false;
+    const auto byteAt = [&buffer](size_t idx) { return static_cast<uint8_t>(buffer[idx]); };
+    size_t offset = 2;
+    uint64_t length = byteAt(1) & 0x7f;
+    const size_t lengthBytes = (length == 126) ? 2 : (length == 127) ? 8 : 0;
+    if (buffer.size() < offset + lengthBytes + 4) return false;
+    if (lengthBytes > 0) length = 0;
+    for (size_t idx = 0; idx < lengthBytes; idx++) length = (length << 8) | byteAt(offset++);
+    // clients always mask
+    const size_t maskOffset = offset;
+    offset += 4;
+    if (buffer.size() < offset + length) return false;
+
+    opcode = byteAt(0) & 0x0f;
+    payload.resize(length);
+    for (size_t idx = 0; idx < length; idx++) {
+        payload[idx] = static_cast<char>(byteAt(offset + idx) ^ byteAt(maskOffset + idx % 4));
+    }
+    buffer.erase(0, offset + length);
+    return true;
+}
+
+/** @return the value of a header or an empty string */
+std::string headerValue(const std::string &request, const char *name) {
+    for (size_t lineBegin = request.find("\r\n"); lineBegin != std::string::npos;) {
+        lineBegin += 2;
+        const size_t lineEnd = request.find("\r\n", lineBegin);
+        const size_t nameLength = strlen(name);
+        if (lineEnd == std::string::npos) break;
+        if (strncasecmp(request.c_str() + lineBegin, name, nameLength) == 0 &&
+            request[lineBegin + nameLength] == ':') {
+            const size_t valueBegin = request.find_first_not_of(' ', lineBegin + nameLength + 1);
+            return request.substr(valueBegin, lineEnd - valueBegin);
+        }
+        lineBegin = lineEnd;
+    }
+    return "";
+}
+
+std::string contentLengthResponse(const std::string &body) {
+    return format("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n\r\n", body.size()) +
+           body;
+}
+
+std::string chunkedResponse(const std::string &body) {
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n";
+    for (size_t offset = 0; offset < body.size(); offset += chunkSize) {
+        const std::string chunk = body.substr(offset, chunkSize);
+        response += format("%zx\r\n", chunk.size()) + chunk + "\r\n";
+    }
+    return response + "0\r\n\r\n";
+}
+
+bool sendAll(int fd, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t result = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) return false;
+        sent += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+} // namespace
+
+MockOctoprintServer::~MockOctoprintServer() {
+    stop();
+}
+
+bool MockOctoprintServer::start(uint16_t port) {
+    render();
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) return false;
+    const int isReuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &isReuse, sizeof(isReuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength = sizeof(address);
+    if (bind(listenFd, reinterpret_cast<const sockaddr *>(&address), addressLength) != 0 ||
+        listen(listenFd, 64) != 0 ||
+        getsockname(listenFd, reinterpret_cast<sockaddr *>(&address), &addressLength) != 0) {
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    this->port = ntohs(address.sin_port);
+    acceptThread = std::thread(&MockOctoprintServer::acceptConnections, this);
+    return true;
+}
+
+void MockOctoprintServer::stop() {
+    if (listenFd < 0) return;
+
+    shutdown(listenFd, SHUT_RDWR);
+    if (acceptThread.joinable()) acceptThread.join();
+    close(listenFd);
+    listenFd = -1;
+
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        for (int fd : connectionFds) shutdown(fd, SHUT_RDWR);
+    }
+    for (std::thread &thread : connectionThreads) thread.join();
+    connectionThreads.clear();
+    connectionFds.clear();
+}
+
+uint16_t MockOctoprintServer::getPort() const {
+    return port;
+}
+
+void MockOctoprintServer::setVariant(Variant variant) {
+    this->variant = static_cast<uint8_t>(variant);
+}
+
+size_t MockOctoprintServer::getBodySize(const char *path) const {
+    for (const Endpoint &endpoint : endpoints) {
+        if (endpoint.path == path) return endpoint.body[variant].size();
+    }
+    return 0;
+}
+
+const char *MockOctoprintServer::toString(Variant variant) {
+    switch (variant) {
+        case Variant::Small:
+            return "small";
+        case Variant::Large:
+            return "large";
+        case Variant::Chunked:
+            return "chunked";
+    }
+    return "";
+}
+
+void MockOctoprintServer::render() {
+    endpoints.clear();
+    const struct {
+        const char *path;
+        std::string (*small)();
+        std::string (*large)();
+    } sources[] = {
+            {"/api/version", [] { return versionBody(); }, [] { return versionBody(); }},
+            {"/api/printer", [] { return printerBody(false); }, [] { return printerBody(true); }},
+            {"/api/job", [] { return jobBody(false); }, [] { return jobBody(true); }},
+            {"/api/files", [] { return filesBody(false); }, [] { return filesBody(true); }},
+            {"/api/login", [] { return loginBody(); }, [] { return loginBody(); }},
+    };
+
+    for (const auto &source : sources) {
+        Endpoint endpoint;
+        endpoint.path = source.path;
+        endpoint.body[static_cast<uint8_t>(Variant::Small)] = source.small();
+        endpoint.body[static_cast<uint8_t>(Variant::Large)] = source.large();
+        endpoint.body[static_cast<uint8_t>(Variant::Chunked)] = source.large();
+        for (uint8_t idx = 0; idx < variantsCount; idx++) {
+            endpoint.response[idx] = (idx == static_cast<uint8_t>(Variant::Chunked))
+                                     ? chunkedResponse(endpoint.body[idx])
+                                     : contentLengthResponse(endpoint.body[idx]);
+        }
+        endpoints.push_back(endpoint);
+    }
+    notFoundResponse = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+}
+
+void MockOctoprintServer::acceptConnections() {
+    for (;;) {
+        const int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+        const int isNoDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &isNoDelay, sizeof(isNoDelay));
+
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        connectionFds.push_back(fd);
+        connectionThreads.emplace_back(&MockOctoprintServer::serve, this, fd);
+    }
+}
+
+void MockOctoprintServer::serve(int fd) {
+    std::string received;
+    char buffer[2048];
+    for (;;) {
+        const size_t headerEnd = received.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            const ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+            if (length < 0 && errno == EINTR) continue;
+            if (length <= 0) break;
+            received.append(buffer, static_cast<size_t>(length));
+            continue;
+        }
+
+        // GET /api/printer?history=true HTTP/1.1
+        const size_t pathBegin = received.find(' ') + 1;
+        const size_t pathEnd = received.find_first_of(" ?", pathBegin);
+        const std::string path = received.substr(pathBegin, pathEnd - pathBegin);
+        const std::string request = received.substr(0, headerEnd + 2);
+        // the content of request bodies, e.g. of the login, does not matter
+        const size_t messageLength = headerEnd + 4 + strtoul(headerValue(request, "Content-Length").c_str(),
+                                                             nullptr, 10);
+        if (received.size() < messageLength) {
+            const ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+            if (length < 0 && errno == EINTR) continue;
+            if (length <= 0) break;
+            received.append(buffer, static_cast<size_t>(length));
+            continue;
+        }
+        received.erase(0, messageLength);
+
+        if (path == "/sockjs/websocket" && isPushEnabled) {
+            servePush(fd, request);
+            break;
+        }
+        if (!sendAll(fd, respond(path))) break;
+    }
+
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (size_t idx = 0; idx < connectionFds.size(); idx++) {
+        if (connectionFds[idx] != fd) continue;
+        connectionFds.erase(connectionFds.begin() + static_cast<long>(idx));
+        break;
+    }
+    close(fd);
+}
+
+void MockOctoprintServer::setPush(bool isEnabled, unsigned intervalMs) {
+    isPushEnabled = isEnabled;
+    pushIntervalMs = intervalMs;
+}
+
+void MockOctoprintServer::dropPushSockets() {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (int fd : pushFds) shutdown(fd, SHUT_RDWR);
+}
+
+void MockOctoprintServer::requestReauth() {
+    isReauthRequested = true;
+}
+
+std::vector<std::string> MockOctoprintServer::getPushReceived() {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    return pushReceived;
+}
+
+void MockOctoprintServer::servePush(int fd, const std::string &request) {
+    char accept[29];
+    internal::computeWebSocketAccept(headerValue(request, "Sec-WebSocket-Key").c_str(), accept);
+    std::string opening = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Accept: ";
+    opening += accept;
+    opening += "\r\n\r\n";
+    opening += webSocketFrame(0x1, R"({"connected":{"version":"1.9.3","display_version":"1.9.3","branch":null,)"
+                                   R"("python_version":"3.11.2","debug":false,"safe_mode":null,"permissions":[]}})");
+    opening += webSocketFrame(0x1, R"({"history":)" + pushedState(60, 60) + "}");
+    if (!sendAll(fd, opening)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        pushFds.push_back(fd);
+    }
+    std::string received;
+    char buffer[512];
+    for (unsigned tick = 61;;) {
+        pollfd readable{fd, POLLIN, 0};
+        const int ready = ::poll(&readable, 1, static_cast<int>(pushIntervalMs.load()));
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready == 0) {
+            if (isReauthRequested.exchange(false)) {
+                if (!sendAll(fd, webSocketFrame(0x1, R"({"reauthRequired":{"reason":"logout"}})"))) break;
+                continue;
+            }
+            if (!sendAll(fd, webSocketFrame(0x1, R"({"current":)" + pushedState(tick++, 1) + "}"))) break;
+            continue;
+        }
+
+        const ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+        if (length < 0 && errno == EINTR) continue;
+        if (length <= 0) break;
+        received.append(buffer, static_cast<size_t>(length));
+
+        uint8_t opcode;
+        std::string payload;
+        bool isClosing = false;
+        while (!isClosing && takeWebSocketFrame(received, opcode, payload)) {
+            if (opcode == 0x1) {
+                std::lock_guard<std::mutex> lock(connectionsMutex);
+                pushReceived.push_back(payload);
+            } else if (opcode == 0x8) {
+                sendAll(fd, webSocketFrame(0x8, payload.substr(0, 2)));
+                isClosing = true;
+            } else if (opcode == 0x9) {
+                sendAll(fd, webSocketFrame(0xa, payload));
+            }
+        }
+        if (isClosing) break;
+    }
+
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (size_t idx = 0; idx < pushFds.size(); idx++) {
+        if (pushFds[idx] != fd) continue;
+        pushFds.erase(pushFds.begin() + static_cast<long>(idx));
+        break;
+    }
+}
+
+const std::string &MockOctoprintServer::respond(const std::string &path) const {
+    for (const Endpoint &endpoint : endpoints) {
+        if (endpoint.path == path) return endpoint.response[variant];
+    }
+    return notFoundResponse;
+}
+
+} // namespace benchmark
+} // namespace octoprint
@@ -0,0 +1,109 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace octoprint {
+namespace benchmark {
+
+/**
+ * Loopback HTTP/1.1 server answering like OctoPrint with canned payloads.
+ * Responses are rendered once on start, serving them costs a send() per request so that the measured time is
+ * dominated by the client. Connections are kept alive.
+ *
+ * Also stands in for the push api: /api/login answers a session and /sockjs/websocket upgrades to a WebSocket that
+ * sends "connected" and "history", then a "current" message per push interval with advancing temperatures and
+ * progress.
+ */
+struct MockOctoprintServer {
+
+    enum class Variant : uint8_t {
+        // payloads as returned by a single tool printer
+        Small,
+        // temperature history, many files, long names
+        Large,
+        // large payloads with Transfer-Encoding: chunked
+        Chunked
+    };
+
+    static constexpr uint8_t variantsCount = 3;
+
+    ~MockOctoprintServer();
+
+    /**
+     * @param port 0 picks a free port
+     * @return false if the listening socket could not be set up
+     */
+    bool start(uint16_t port = 0);
+
+    void stop();
+
+    uint16_t getPort() const;
+
+    void setVariant(Variant variant);
+
+    /** @return size of the body served for the endpoint in the current variant, 0 if unknown */
+    size_t getBodySize(const char *path) const;
+
+    static const char *toString(Variant variant);
+
+    /**
+     * @param isEnabled a disabled push api answers the upgrade with 404
+     * @param intervalMs time between two current messages
+     */
+    void setPush(bool isEnabled, unsigned intervalMs = 500);
+
+    /** Closes all open push sockets, without close frame. */
+    void dropPushSockets();
+
+    /** Open push sockets send {"reauthRequired": ..} instead of their next current message. */
+    void requestReauth();
+
+    /** @return text messages received on push sockets, e.g. auth and subscribe */
+    std::vector<std::string> getPushReceived();
+
+private:
+    struct Endpoint {
+        std::string path;
+        std::string body[variantsCount];
+        std::string response[variantsCount];
+    };
+
+    std::vector<Endpoint> endpoints;
+    std::string notFoundResponse;
+    std::atomic<uint8_t> variant{0};
+    std::atomic<bool> isPushEnabled{true};
+    std::atomic<unsigned> pushIntervalMs{500};
+    std::atomic<bool> isReauthRequested{false};
+    // guarded by connectionsMutex
+    std::vector<int> pushFds;
+    std::vector<std::string> pushReceived;
+
+    int listenFd{-1};
+    uint16_t port{0};
+    std::thread acceptThread;
+    std::mutex connectionsMutex;
+    std::vector<int> connectionFds;
+    std::vector<std::thread> connectionThreads;
+
+    void render();
+
+    void acceptConnections();
+
+    void serve(int fd);
+
+    void servePush(int fd, const std::string &request);
+
+    const std::string &respond(const std::string &path) const;
+};
+
+} // namespace benchmark
+} // namespace octoprint
@@ -0,0 +1,250 @@
+/**
+ * Author: https://github.com/rubienr
+ *
+ * Measures request round trips of OctoprintClient against MockOctoprintServer on the loopback interface.
+ *
+ * usage: octoprintclient-benchmark [--iterations N] [--no-reuse]
+ *                                  [--max-p99-us N] [--max-allocs N] [--min-rps N]
+ *
+ * One line of key=value pairs is printed per endpoint and payload variant. The --max and --min options turn the
+ * run into a regression gate: the exit code is 1 if any case violates a limit or any request fails.
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <sys/resource.h>
+#include <vector>
+#include "MockOctoprintServer.h"
+#include "OctoprintClient.h"
+#include "PosixClient.h"
+
+using namespace octoprint;
+using benchmark::MockOctoprintServer;
+
+namespace {
+
+/**
+ * Heap usage of the measuring thread, the server's threads are not counted.
+ */
+struct AllocationCounter {
+    unsigned long allocations{0};
+    unsigned long allocatedBytes{0};
+    long liveBytes{0};
+    long peakLiveBytes{0};
+};
+
+thread_local bool isCounting{false};
+thread_local AllocationCounter counter;
+
+void *allocate(size_t size) {
+    void *ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    if (isCounting) {
+        const size_t usable = malloc_usable_size(ptr);
+        counter.allocations++;
+        counter.allocatedBytes += size;
+        counter.liveBytes += static_cast<long>(usable);
+        if (counter.liveBytes > counter.peakLiveBytes) counter.peakLiveBytes = counter.liveBytes;
+    }
+    return ptr;
+}
+
+void deallocate(void *ptr) {
+    if (ptr == nullptr) return;
+    if (isCounting) counter.liveBytes -= static_cast<long>(malloc_usable_size(ptr));
+    free(ptr);
+}
+
+} // namespace
+
+void *operator new(size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    deallocate(ptr);
+}
+
+namespace {
+
+struct Options {
+    unsigned iterations{2000};
+    bool isReuseEnabled{true};
+    unsigned long maxP99Us{0};
+    double maxAllocationsPerRequest{-1};
+    double minRequestsPerSecond{0};
+};
+
+struct Case {
+    const char *path;
+    bool (*run)(OctoprintClient &client);
+};
+
+struct Result {
+    unsigned requests{0};
+    unsigned failed{0};
+    double requestsPerSecond{0};
+    unsigned long p50Us{0};
+    unsigned long p90Us{0};
+    unsigned long p99Us{0};
+    unsigned long maxUs{0};
+    double allocationsPerRequest{0};
+    double allocatedBytesPerRequest{0};
+    long peakHeapBytes{0};
+    unsigned long firstByteAvgUs{0};
+    uint32_t connects{0};
+    unsigned long connectAvgUs{0};
+};
+
+RequestMetrics metrics;
+
+NullBodySink discarded;
+
+const Case cases[] = {
+        {"/api/version", [](OctoprintClient &client) { return client.fetchOctoprintVersion(); }},
+        {"/api/printer", [](OctoprintClient &client) { return client.fetchPrinterStatistics(); }},
+        {"/api/job", [](OctoprintClient &client) { return client.fetchPrintJob(); }},
+        {"/api/files", [](OctoprintClient &client) { return client.sendCustomCommand("files", discarded); }},
+};
+
+unsigned long percentile(const std::vector<unsigned long> &sorted, unsigned percent) {
+    if (sorted.empty()) return 0;
+    return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+Result measure(OctoprintClient &client, const Case &benchmarkCase, unsigned iterations) {
+    std::vector<unsigned long> latenciesUs;
+    latenciesUs.reserve(iterations);
+
+    // warm up connection and caches
+    for (unsigned idx = 0; idx < iterations / 10 + 1; idx++) benchmarkCase.run(client);
+
+    Result result;
+    metrics.reset();
+    counter = AllocationCounter{};
+    isCounting = true;
+    const unsigned long startUs = micros();
+    for (unsigned idx = 0; idx < iterations; idx++) {
+        const unsigned long requestStartUs = micros();
+        if (!benchmarkCase.run(client)) result.failed++;
+        latenciesUs.push_back(micros() - requestStartUs);
+    }
+    const unsigned long elapsedUs = micros() - startUs;
+    isCounting = false;
+
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    result.requests = iterations;
+    result.requestsPerSecond = elapsedUs > 0 ? iterations * 1e6 / elapsedUs : 0;
+    result.p50Us = percentile(latenciesUs, 50);
+    result.p90Us = percentile(latenciesUs, 90);
+    result.p99Us = percentile(latenciesUs, 99);
+    result.maxUs = latenciesUs.empty() ? 0 : latenciesUs.back();
+    result.allocationsPerRequest = static_cast<double>(counter.allocations) / iterations;
+    result.allocatedBytesPerRequest = static_cast<double>(counter.allocatedBytes) / iterations;
+    result.peakHeapBytes = counter.peakLiveBytes;
+
+    const EndpointMetrics total = metrics.getTotal();
+    if (total.firstBytes > 0) {
+        result.firstByteAvgUs = static_cast<unsigned long>(total.firstByteUsTotal / total.firstBytes);
+    }
+    result.connects = total.connects;
+    if (total.connects > 0) result.connectAvgUs = static_cast<unsigned long>(total.connectUsTotal / total.connects);
+    return result;
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int idx = 1; idx < argc; idx++) {
+        const String option(argv[idx]);
+        const bool hasValue = idx + 1 < argc;
+        if (option == "--no-reuse") {
+            options.isReuseEnabled = false;
+        } else if (option == "--iterations" && hasValue) {
+            options.iterations = static_cast<unsigned>(strtoul(argv[++idx], nullptr, 10));
+        } else if (option == "--max-p99-us" && hasValue) {
+            options.maxP99Us = strtoul(argv[++idx], nullptr, 10);
+        } else if (option == "--max-allocs" && hasValue) {
+            options.maxAllocationsPerRequest = strtod(argv[++idx], nullptr);
+        } else if (option == "--min-rps" && hasValue) {
+            options.minRequestsPerSecond = strtod(argv[++idx], nullptr);
+        } else {
+            return false;
+        }
+    }
+    return options.iterations > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--iterations N] [--no-reuse] [--max-p99-us N] [--max-allocs N] [--min-rps N]\n",
+                argv[0]);
+        return 2;
+    }
+
+    MockOctoprintServer server;
+    if (!server.start()) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 2;
+    }
+
+    const String apiKey("benchmark");
+    host::PosixClient connection;
+    OctoprintClient client(apiKey, connection, IPAddress(127, 0, 0, 1), server.getPort());
+    client.setConnectionReuse(options.isReuseEnabled);
+    client.setMetrics(&metrics);
+
+    bool isPassed = true;
+    for (uint8_t variantIdx = 0; variantIdx < MockOctoprintServer::variantsCount; variantIdx++) {
+        const auto variant = static_cast<MockOctoprintServer::Variant>(variantIdx);
+        server.setVariant(variant);
+
+        for (const Case &benchmarkCase : cases) {
+            const Result result = measure(client, benchmarkCase, options.iterations);
+            printf("endpoint=%s variant=%s body_bytes=%zu requests=%u failed=%u rps=%.0f p50_us=%lu p90_us=%lu "
+                   "p99_us=%lu max_us=%lu ttfb_avg_us=%lu connects=%u connect_avg_us=%lu allocs_per_req=%.2f "
+                   "alloc_bytes_per_req=%.0f peak_heap_bytes=%ld\n",
+                   benchmarkCase.path, MockOctoprintServer::toString(variant), server.getBodySize(benchmarkCase.path),
+                   result.requests, result.failed, result.requestsPerSecond, result.p50Us, result.p90Us,
+                   result.p99Us, result.maxUs, result.firstByteAvgUs, result.connects, result.connectAvgUs,
+                   result.allocationsPerRequest, result.allocatedBytesPerRequest,
+                   result.peakHeapBytes);
+
+            if (result.failed > 0 ||
+                (options.maxP99Us > 0 && result.p99Us > options.maxP99Us) ||
+                (options.maxAllocationsPerRequest >= 0 &&
+                 result.allocationsPerRequest > options.maxAllocationsPerRequest) ||
+                result.requestsPerSecond < options.minRequestsPerSecond) {
+                printf("FAILED endpoint=%s variant=%s\n", benchmarkCase.path, MockOctoprintServer::toString(variant));
+                isPassed = false;
+            }
+        }
+    }
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    printf("max_rss_kb=%ld\n", usage.ru_maxrss);
+    server.stop();
+    return isPassed ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+/**
+ * Author: https://github.com/rubienr
+ *
+ * Polls a fleet of OctoPrint servers from a Linux host.
+ *
+ * usage: octoprintclient-host <api key> <host>[:port] [<host>[:port] ...]
+ */
+
+#include <Arduino.h>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "OctoprintFleet.h"
+#include "PosixClient.h"
+
+using namespace octoprint;
+
+static constexpr size_t maxPrinters = 64;
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <api key> <host>[:port] [<host>[:port] ...]\n", argv[0]);
+        return 1;
+    }
+
+    const String apiKey(argv[1]);
+    host::PosixPoller poller;
+    host::PosixResolver resolver;
+    std::vector<std::unique_ptr<host::PosixClient>> connections;
+    std::vector<std::unique_ptr<OctoprintClient>> clients;
+    OctoprintFleet<maxPrinters> fleet;
+
+    for (int idx = 2; idx < argc && clients.size() < maxPrinters; idx++) {
+        String host(argv[idx]);
+        uint16_t port = 5000;
+        const int colon = host.indexOf(':');
+        if (colon >= 0) {
+            port = static_cast<uint16_t>(host.substring(colon + 1).toInt());
+            host = host.substring(0, colon);
+        }
+
+        connections.emplace_back(new host::PosixClient(&poller));
+        IPAddress ip;
+        if (ip.fromString(host.c_str())) {
+            clients.emplace_back(new OctoprintClient(apiKey, *connections.back(), ip, port));
+        } else {
+            clients.emplace_back(new OctoprintClient(apiKey, *connections.back(), host, port));
+            // getaddrinfo() blocks, resolve once per TTL rather than per connect
+            clients.back()->setHostResolver(&resolver);
+        }
+        clients.back()->setConnectionReuse(true);
+        fleet.add(*clients.back());
+    }
+
+    unsigned long lastReportMs = millis();
+    for (;;) {
+        fleet.poll();
+        // wakes up on socket events, the timeout keeps the poll schedule going
+        poller.wait(10);
+
+        if (millis() - lastReportMs >= 1000) {
+            lastReportMs = millis();
+            const FleetSummary summary = fleet.summarize();
+            printf("printers:%u reachable:%u operational:%u printing:%u paused:%u error:%u\n",
+                   summary.printers, summary.reachable, summary.operational, summary.printing, summary.paused,
+                   summary.error);
+            fflush(stdout);
+        }
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * Author: https://github.com/rubienr
+ *
+ * Follows printers through OctoPrint's push api from a Linux host.
+ *
+ * usage: octoprintclient-push [<api key> <host>[:port]]
+ *
+ * Without arguments the client runs against an in-process stand-in server and checks that updates are pushed, that
+ * polling takes over while the push api is gone and that push is restored afterwards. The exit code is 1 if any of
+ * these phases fails.
+ */
+
+#include <Arduino.h>
+#include <cstdio>
+#include "../benchmark/MockOctoprintServer.h"
+#include "OctoprintPushClient.h"
+#include "PosixClient.h"
+
+using namespace octoprint;
+
+namespace {
+
+void printTemperature(const PrinterState::Thermal &temperature) {
+    for (uint8_t idx = 0; idx < temperature.heatersCount; idx++) {
+        const PrinterState::Heater &heater = temperature.heaters[idx];
+        printf("%s%s:%.1f/%.1f", idx > 0 ? " " : "", heater.name, heater.currentCelsius, heater.targetCelsius);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+int follow(const String &apiKey, const String &hostAndPort) {
+    String host = hostAndPort;
+    uint16_t port = 5000;
+    const int colon = host.indexOf(':');
+    if (colon >= 0) {
+        port = static_cast<uint16_t>(host.substring(colon + 1).toInt());
+        host = host.substring(0, colon);
+    }
+
+    host::PosixClient connection;
+    host::PosixClient pushConnection;
+    OctoprintClient printer(apiKey, connection, host, port);
+    OctoprintPushClient push(printer, pushConnection);
+    printer.onTemperatureChanged(0.5f, printTemperature);
+    printer.onProgress(1.0f, [](const internal::JobRequest &job) {
+        printf("%s %.1f%%\n", job.jobFileName.c_str(), job.progressCompletion);
+    });
+
+    bool wasPushActive = false;
+    for (;;) {
+        const bool isPushActive = push.poll();
+        if (isPushActive != wasPushActive) printf(isPushActive ? "push\n" : "polling\n");
+        wasPushActive = isPushActive;
+        delay(10);
+    }
+}
+
+/**
+ * Polls for durationMs.
+ * @return number of thermal updates seen
+ */
+uint32_t run(OctoprintPushClient &push, const OctoprintClient &printer, unsigned long durationMs) {
+    const uint32_t firstGeneration = printer.getState().generations.thermal;
+    const unsigned long startMs = millis();
+    while (millis() - startMs < durationMs) {
+        push.poll();
+        delay(5);
+    }
+    return printer.getState().generations.thermal - firstGeneration;
+}
+
+bool report(const char *phase, bool isPassed) {
+    printf("%s %s\n", isPassed ? "PASSED" : "FAILED", phase);
+    return isPassed;
+}
+
+int selfTest() {
+    benchmark::MockOctoprintServer server;
+    if (!server.start()) {
+        fprintf(stderr, "stand-in server failed to start\n");
+        return 1;
+    }
+    server.setPush(true, 100);
+
+    const String apiKey("stand-in");
+    host::PosixClient connection;
+    host::PosixClient pushConnection;
+    OctoprintClient printer(apiKey, connection, IPAddress(127, 0, 0, 1), server.getPort());
+    RequestMetrics metrics;
+    printer.setMetrics(&metrics);
+
+    PushSettings settings;
+    settings.staleTimeoutMs = 1000;
+    settings.reconnectIntervalMs = 500;
+    PollSchedulerSettings fallbackSettings;
+    fallbackSettings.active = {100, 200};
+    fallbackSettings.idle = {100, 200};
+    OctoprintPushClient push(printer, pushConnection, settings, fallbackSettings);
+
+    bool isPassed = true;
+    uint32_t updates = run(push, printer, 1500);
+    const uint32_t polledBefore = metrics.get(Operation::FetchPrinterStatistics).requests;
+    isPassed &= report("push", push.isPushActive() && updates > 0);
+
+    server.setPush(false);
+    server.dropPushSockets();
+    updates = run(push, printer, 1500);
+    const uint32_t polled = metrics.get(Operation::FetchPrinterStatistics).requests - polledBefore;
+    isPassed &= report("fallback to polling", !push.isPushActive() && polled > 0 && updates > 0);
+
+    server.setPush(true, 100);
+    updates = run(push, printer, 1500);
+    isPassed &= report("push restored", push.isPushActive() && updates > 0);
+
+    bool isSubscribed = false;
+    for (const std::string &message : server.getPushReceived()) {
+        isSubscribed |= message.find("\"subscribe\"") != std::string::npos;
+    }
+    isPassed &= report("subscribed", isSubscribed);
+
+    push.close();
+    server.stop();
+    return isPassed ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc == 3) return follow(String(argv[1]), String(argv[2]));
+    if (argc == 1) return selfTest();
+    fprintf(stderr, "usage: %s [<api key> <host>[:port]]\n", argv[0]);
+    return 1;
+}
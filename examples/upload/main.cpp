@@ -0,0 +1,75 @@
+/**
+ * Author: https://github.com/rubienr
+ *
+ * Uploads a G-code file to OctoPrint from a Linux host, streamed in blocks like it would be from an SD card.
+ *
+ * usage: octoprintclient-upload <api key> <host>[:port] <file> [select|print]
+ */
+
+#include <Arduino.h>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <unistd.h>
+#include "FileDescriptorStream.h"
+#include "OctoprintClient.h"
+#include "PosixClient.h"
+
+using namespace octoprint;
+
+int main(int argc, char **argv) {
+    if (argc < 4 || argc > 5) {
+        fprintf(stderr, "usage: %s <api key> <host>[:port] <file> [select|print]\n", argv[0]);
+        return 1;
+    }
+
+    String host(argv[2]);
+    uint16_t port = 5000;
+    const int colon = host.indexOf(':');
+    if (colon >= 0) {
+        port = static_cast<uint16_t>(host.substring(colon + 1).toInt());
+        host = host.substring(0, colon);
+    }
+
+    const int fd = open(argv[3], O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(argv[3]);
+        return 1;
+    }
+    host::FileDescriptorStream file(fd);
+    const long size = file.getSize();
+    if (size < 0) {
+        fprintf(stderr, "%s: not a regular file\n", argv[3]);
+        close(fd);
+        return 1;
+    }
+
+    UploadOptions options;
+    options.isSelected = argc == 5 && strcmp(argv[4], "select") == 0;
+    options.isPrinted = argc == 5 && strcmp(argv[4], "print") == 0;
+    options.progress = [](const UploadProgress &progress) {
+        printf("\r%zu/%zu bytes %lu B/s", progress.bytesSent, progress.totalBytes,
+               static_cast<unsigned long>(progress.bytesPerSecond));
+        fflush(stdout);
+    };
+
+    // the file name on the server, without the local directories
+    const char *slash = strrchr(argv[3], '/');
+    const String fileName(slash != nullptr ? slash + 1 : argv[3]);
+
+    host::PosixClient connection;
+    IPAddress ip;
+    std::unique_ptr<OctoprintClient> printer;
+    if (ip.fromString(host.c_str())) {
+        printer.reset(new OctoprintClient(String(argv[1]), connection, ip, port));
+    } else {
+        printer.reset(new OctoprintClient(String(argv[1]), connection, host, port));
+    }
+    const bool isUploaded = printer->uploadFile(fileName, file, static_cast<size_t>(size), options);
+    close(fd);
+
+    printf("\n%s, http status %d %s\n", isUploaded ? "uploaded" : "failed",
+           printer->getRequestStatus().httpStatusCode, printer->getCachedState().httpErrorBody.c_str());
+    return isUploaded ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "BodySink.h"
+
+namespace octoprint {
+
+BufferBodySink::BufferBodySink(char *buffer, size_t capacity) :
+        buffer{buffer},
+        capacity{capacity} {
+    clear();
+}
+
+bool BufferBodySink::write(const char *data, size_t length) {
+    if (capacity == 0) return length == 0;
+    // one byte is reserved for the terminating null
+    const size_t free = capacity - 1 - used;
+    const size_t accepted = (length < free) ? length : free;
+    memcpy(buffer + used, data, accepted);
+    used += accepted;
+    buffer[used] = '\0';
+    return accepted == length;
+}
+
+void BufferBodySink::clear() {
+    used = 0;
+    if (capacity > 0) buffer[0] = '\0';
+}
+
+const char *BufferBodySink::c_str() const {
+    return buffer;
+}
+
+size_t BufferBodySink::length() const {
+    return used;
+}
+
+} // namespace octoprint
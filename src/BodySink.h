@@ -0,0 +1,71 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace octoprint {
+
+/**
+ * Receives the bytes of a HTTP response body as they arrive.
+ */
+struct BodySink {
+    virtual ~BodySink() = default;
+
+    /**
+     * @param data next body bytes, not null terminated
+     * @param length number of bytes
+     * @return false if not all bytes could be accepted, the response is then reported as truncated
+     */
+    virtual bool write(const char *data, size_t length) = 0;
+};
+
+/**
+ * Collects the body into a caller provided buffer and keeps it null terminated.
+ * Bytes not fitting into the buffer are dropped.
+ */
+struct BufferBodySink : public BodySink {
+
+    BufferBodySink(char *buffer, size_t capacity);
+
+    bool write(const char *data, size_t length) override;
+
+    void clear();
+
+    const char *c_str() const;
+
+    size_t length() const;
+
+private:
+    char *buffer;
+    size_t capacity;
+    size_t used{0};
+};
+
+/**
+ * Forwards the body to any Print, e.g. a file or Serial, without size limit.
+ */
+struct PrintBodySink : public BodySink {
+
+    explicit PrintBodySink(Print &out) : out(out) {}
+
+    bool write(const char *data, size_t length) override {
+        return out.write(reinterpret_cast<const uint8_t *>(data), length) == length;
+    }
+
+private:
+    Print &out;
+};
+
+/**
+ * Discards the body.
+ */
+struct NullBodySink : public BodySink {
+    bool write(const char *, size_t) override {
+        return true;
+    }
+};
+
+} // namespace octoprint
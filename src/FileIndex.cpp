@@ -0,0 +1,400 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "FileIndex.h"
+#include "HttpResponseParser.h"
+#include <limits>
+
+namespace octoprint {
+
+FileIndex::FileIndex(FileEntry *entries, uint16_t capacity, const String &folder, bool isRecursive) :
+        entries{entries},
+        capacity{capacity},
+        folder{folder},
+        isRecursiveListing{isRecursive} {}
+
+const String &FileIndex::getFolder() const {
+    return folder;
+}
+
+bool FileIndex::isRecursive() const {
+    return isRecursiveListing;
+}
+
+void FileIndex::setPageOffset(uint16_t offset) {
+    if (offset == pageOffset) return;
+    pageOffset = offset;
+    invalidate();
+}
+
+uint16_t FileIndex::getPageOffset() const {
+    return pageOffset;
+}
+
+uint16_t FileIndex::size() const {
+    return count;
+}
+
+const FileEntry &FileIndex::operator[](uint16_t idx) const {
+    return entries[idx];
+}
+
+uint16_t FileIndex::getTotalCount() const {
+    return totalCount;
+}
+
+uint32_t FileIndex::getGeneration() const {
+    return generation;
+}
+
+void FileIndex::invalidate() {
+    etag = "";
+    lastModified = "";
+}
+
+String FileIndex::getConditionalHeaders() const {
+    String headers;
+    if (!etag.isEmpty()) {
+        headers += "If-None-Match: ";
+        headers += etag;
+        headers += "\r\n";
+    }
+    if (!lastModified.isEmpty()) {
+        headers += "If-Modified-Since: ";
+        headers += lastModified;
+        headers += "\r\n";
+    }
+    return headers;
+}
+
+void FileIndex::beginListing() {
+    count = 0;
+    totalCount = 0;
+}
+
+void FileIndex::add(const FileEntry &entry) {
+    if (totalCount >= pageOffset && count < capacity) entries[count++] = entry;
+    if (totalCount < UINT16_MAX) totalCount++;
+}
+
+void FileIndex::endListing(bool isComplete, const char *etag, const char *lastModified) {
+    generation++;
+    // a validator cut off by the response parser would never match
+    const bool isEtagComplete = strlen(etag) < internal::HttpResponseParser::maxEtagLength;
+    this->etag = (isComplete && isEtagComplete) ? etag : "";
+    this->lastModified = isComplete ? lastModified : "";
+}
+
+namespace internal {
+namespace {
+
+// folders nested deeper are skipped in recursive listings
+constexpr uint8_t maxFolderDepth = 8;
+
+/**
+ * Scans a listing with one byte lookahead, nothing but the current entry is held in memory.
+ */
+struct FileListingReader {
+
+    FileListingReader(Stream &body, FileIndex &index) : body(body), index(index) {}
+
+    DeserializationError read() {
+        readObject([this](const char *key) -> bool {
+            if (strcmp(key, "files") == 0 || strcmp(key, "children") == 0) return readEntries(0);
+            return skipValue();
+        });
+        return error;
+    }
+
+private:
+    Stream &body;
+    FileIndex &index;
+    DeserializationError error{DeserializationError::Ok};
+
+    bool fail(DeserializationError::Code code) {
+        if (!error) error = code;
+        return false;
+    }
+
+    bool failOn(int c) {
+        return fail((c < 0) ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput);
+    }
+
+    /** Skips whitespace. @return the next character, not consumed, -1 at the end of the body */
+    int peekToken() {
+        int c = body.peek();
+        while (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            body.read();
+            c = body.peek();
+        }
+        return c;
+    }
+
+    bool expect(char token) {
+        const int c = peekToken();
+        if (c != token) return failOn(c);
+        body.read();
+        return true;
+    }
+
+    /**
+     * Reads the members of an object, member(key) has to consume the value.
+     */
+    template<typename MemberReader>
+    bool readObject(MemberReader member) {
+        if (!expect('{')) return false;
+        if (peekToken() == '}') return expect('}');
+        for (;;) {
+            char key[24];
+            bool isKeyTruncated = false;
+            if (!expect('"') || !readString(key, sizeof(key), isKeyTruncated) || !expect(':')) return false;
+            // a long key is none of the ones looked for
+            if (isKeyTruncated) key[0] = '\0';
+            if (!member(key)) return false;
+
+            const int c = peekToken();
+            body.read();
+            if (c == '}') return true;
+            if (c != ',') return failOn(c);
+        }
+    }
+
+    bool readEntries(uint8_t depth) {
+        if (peekToken() != '[') return skipValue();
+        body.read();
+        if (peekToken() == ']') return expect(']');
+        for (;;) {
+            if (!((peekToken() == '{') ? readEntry(depth) : skipValue())) return false;
+
+            const int c = peekToken();
+            body.read();
+            if (c == ']') return true;
+            if (c != ',') return failOn(c);
+        }
+    }
+
+    bool readEntry(uint8_t depth) {
+        FileEntry entry;
+        const bool isRead = readObject([this, &entry, depth](const char *key) -> bool {
+            if (strcmp(key, "path") == 0) {
+                return readStringValue(entry.path, sizeof(entry.path), entry.isPathTruncated);
+            }
+            if (strcmp(key, "type") == 0) {
+                char type[16];
+                bool isTruncated = false;
+                if (!readStringValue(type, sizeof(type), isTruncated)) return false;
+                entry.isFolder = strcmp(type, "folder") == 0;
+                return true;
+            }
+            if (strcmp(key, "size") == 0) return readNumber(entry.size);
+            if (strcmp(key, "date") == 0) return readNumber(entry.date);
+            if (strcmp(key, "gcodeAnalysis") == 0) {
+                if (peekToken() != '{') return skipValue();
+                return readObject([this, &entry](const char *analysisKey) -> bool {
+                    if (strcmp(analysisKey, "estimatedPrintTime") == 0) return readNumber(entry.estimatedPrintTime);
+                    return skipValue();
+                });
+            }
+            if (strcmp(key, "children") == 0 && depth < maxFolderDepth) return readEntries(depth + 1);
+            return skipValue();
+        });
+        if (isRead && entry.path[0] != '\0') index.add(entry);
+        return isRead;
+    }
+
+    /** Reads a string or null into buffer, which is empty for null. */
+    bool readStringValue(char *buffer, size_t capacity, bool &isTruncated) {
+        buffer[0] = '\0';
+        if (peekToken() != '"') return skipValue();
+        body.read();
+        return readString(buffer, capacity, isTruncated);
+    }
+
+    /**
+     * Reads the rest of a string after its opening quote and decodes its escapes to UTF-8.
+     * @param buffer may be null to skip the string
+     */
+    bool readString(char *buffer, size_t capacity, bool &isTruncated) {
+        size_t length = 0;
+        for (;;) {
+            int c = body.read();
+            if (c < 0) return failOn(c);
+            if (c == '"') break;
+            uint32_t codePoint = static_cast<uint8_t>(c);
+            if (c == '\\') {
+                c = body.read();
+                switch (c) {
+                    case 'b':
+                        codePoint = '\b';
+                        break;
+                    case 'f':
+                        codePoint = '\f';
+                        break;
+                    case 'n':
+                        codePoint = '\n';
+                        break;
+                    case 'r':
+                        codePoint = '\r';
+                        break;
+                    case 't':
+                        codePoint = '\t';
+                        break;
+                    case 'u':
+                        if (!readCodePoint(codePoint)) return false;
+                        break;
+                    default:
+                        if (c < 0) return failOn(c);
+                        codePoint = static_cast<uint8_t>(c);
+                        break;
+                }
+                if (buffer != nullptr) append(buffer, capacity, length, isTruncated, codePoint);
+            } else if (buffer != nullptr) {
+                // raw bytes of UTF-8 sequences are copied as they are
+                appendByte(buffer, capacity, length, isTruncated, static_cast<char>(c));
+            }
+        }
+        if (buffer != nullptr) buffer[length] = '\0';
+        return true;
+    }
+
+    /** Reads the hex digits of a \u escape, and those of the low surrogate following a high one. */
+    bool readCodePoint(uint32_t &codePoint) {
+        if (!readHex(codePoint)) return false;
+        if (codePoint < 0xd800 || codePoint > 0xdbff) return true;
+        uint32_t low = 0;
+        if (body.read() != '\\' || body.read() != 'u' || !readHex(low)) return fail(DeserializationError::InvalidInput);
+        codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+        return true;
+    }
+
+    bool readHex(uint32_t &value) {
+        value = 0;
+        for (uint8_t idx = 0; idx < 4; idx++) {
+            const int c = body.read();
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                value |= c - 'A' + 10;
+            } else {
+                return failOn(c);
+            }
+        }
+        return true;
+    }
+
+    static void appendByte(char *buffer, size_t capacity, size_t &length, bool &isTruncated, char c) {
+        if (length + 1 < capacity) {
+            buffer[length++] = c;
+        } else {
+            isTruncated = true;
+        }
+    }
+
+    static void append(char *buffer, size_t capacity, size_t &length, bool &isTruncated, uint32_t codePoint) {
+        char encoded[4];
+        uint8_t encodedLength;
+        if (codePoint < 0x80) {
+            encoded[0] = static_cast<char>(codePoint);
+            encodedLength = 1;
+        } else if (codePoint < 0x800) {
+            encoded[0] = static_cast<char>(0xc0 | (codePoint >> 6));
+            encoded[1] = static_cast<char>(0x80 | (codePoint & 0x3f));
+            encodedLength = 2;
+        } else if (codePoint < 0x10000) {
+            encoded[0] = static_cast<char>(0xe0 | (codePoint >> 12));
+            encoded[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+            encoded[2] = static_cast<char>(0x80 | (codePoint & 0x3f));
+            encodedLength = 3;
+        } else {
+            encoded[0] = static_cast<char>(0xf0 | (codePoint >> 18));
+            encoded[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+            encoded[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+            encoded[3] = static_cast<char>(0x80 | (codePoint & 0x3f));
+            encodedLength = 4;
+        }
+        // a character is not split
+        if (length + encodedLength >= capacity) {
+            isTruncated = true;
+            return;
+        }
+        memcpy(buffer + length, encoded, encodedLength);
+        length += encodedLength;
+    }
+
+    /** Reads a number, null reads as 0. */
+    template<typename T>
+    bool readNumber(T &value) {
+        char text[24];
+        size_t length = 0;
+        int c = peekToken();
+        while ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            if (length + 1 < sizeof(text)) text[length++] = static_cast<char>(c);
+            body.read();
+            c = body.peek();
+        }
+        if (length == 0) {
+            value = 0;
+            return skipValue();
+        }
+        text[length] = '\0';
+        value = saturatedCast<T>(strtod(text, nullptr));
+        return true;
+    }
+
+    /** Casting a double out of the target's range is undefined, e.g. a negative size, so it is clamped first. */
+    template<typename T>
+    static T saturatedCast(double value) {
+        // NaN
+        if (value != value) return 0;
+        if (value <= static_cast<double>(std::numeric_limits<T>::lowest())) return std::numeric_limits<T>::lowest();
+        if (value >= static_cast<double>(std::numeric_limits<T>::max())) return std::numeric_limits<T>::max();
+        return static_cast<T>(value);
+    }
+
+    /** Consumes any value without storing it. */
+    bool skipValue() {
+        int c = peekToken();
+        if (c == '"') {
+            body.read();
+            bool isTruncated = false;
+            return readString(nullptr, 0, isTruncated);
+        }
+        if (c == '{' || c == '[') {
+            uint16_t nesting = 0;
+            do {
+                c = body.read();
+                if (c < 0) return failOn(c);
+                if (c == '"') {
+                    bool isTruncated = false;
+                    if (!readString(nullptr, 0, isTruncated)) return false;
+                } else if (c == '{' || c == '[') {
+                    // the counter must not wrap around and end the value early
+                    if (nesting == UINT16_MAX) return fail(DeserializationError::TooDeep);
+                    nesting++;
+                } else if (c == '}' || c == ']') {
+                    nesting--;
+                }
+            } while (nesting > 0);
+            return true;
+        }
+        // number, true, false or null
+        while (c >= 0 && c != ',' && c != '}' && c != ']' && c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            body.read();
+            c = body.peek();
+        }
+        return (c < 0) ? failOn(c) : true;
+    }
+};
+
+} // namespace
+
+DeserializationError readFileListing(Stream &body, FileIndex &index) {
+    return FileListingReader(body, index).read();
+}
+
+} // namespace internal
+} // namespace octoprint
@@ -0,0 +1,120 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+namespace octoprint {
+
+struct FileEntry {
+    static constexpr uint8_t maxPathLength = 95;
+
+    // relative to the storage root, e.g. "prints/benchy.gcode"
+    char path[maxPathLength + 1]{};
+    // the path did not fit and was cut off, it cannot be used to select the file
+    bool isPathTruncated{false};
+    bool isFolder{false};
+    // bytes, 0 for folders
+    uint32_t size{0};
+    // upload time, unix time
+    uint32_t date{0};
+    // seconds as estimated by OctoPrint's analysis, 0 if not analysed yet
+    float estimatedPrintTime{0};
+};
+
+/**
+ * Listing of one folder of OctoPrint's local storage, filled by OctoprintClient::fetchFiles().
+ *
+ * The entries live in caller provided storage: only the page of entries from getPageOffset() on is kept, the others
+ * are counted, so that libraries with thousands of files can be paged through with a few entries of RAM. In a
+ * recursive listing the content of a folder precedes the folder's entry.
+ * The folder's ETag and Last-Modified are kept with the listing; a refresh of an unchanged folder is answered with
+ * 304 Not Modified and leaves the index as it is, see getGeneration().
+ */
+struct FileIndex {
+
+    /**
+     * @param folder listed folder, "" for the root, e.g. "prints/calibration"
+     * @param isRecursive include the content of sub folders
+     */
+    FileIndex(FileEntry *entries, uint16_t capacity, const String &folder = "", bool isRecursive = false);
+
+    const String &getFolder() const;
+
+    bool isRecursive() const;
+
+    /** Selects the page to keep. The next fetch lists the folder again even if it did not change. */
+    void setPageOffset(uint16_t offset);
+
+    uint16_t getPageOffset() const;
+
+    /** @return number of entries on the page */
+    uint16_t size() const;
+
+    /** @param idx 0 is the entry at the page offset */
+    const FileEntry &operator[](uint16_t idx) const;
+
+    /** @return number of entries in the folder, including those not on the page */
+    uint16_t getTotalCount() const;
+
+    /** @return incremented whenever the listing was read, unchanged if the folder was found unchanged */
+    uint32_t getGeneration() const;
+
+    /** Forgets the validators, the next fetch lists the folder again. */
+    void invalidate();
+
+    /** @return the validator headers for a conditional request, one line each, empty if there is no listing yet */
+    String getConditionalHeaders() const;
+
+    /** Called by OctoprintClient before the listing is read. */
+    void beginListing();
+
+    /** Called by OctoprintClient per entry, in listing order. */
+    void add(const FileEntry &entry);
+
+    /**
+     * Called by OctoprintClient after the listing was read.
+     * @param isComplete false if the listing broke off, the entries read so far are kept but not validated
+     */
+    void endListing(bool isComplete, const char *etag, const char *lastModified);
+
+private:
+    FileEntry *entries;
+    uint16_t capacity;
+    String folder;
+    bool isRecursiveListing;
+    uint16_t pageOffset{0};
+    uint16_t count{0};
+    uint16_t totalCount{0};
+    uint32_t generation{0};
+    // validators of the listing, empty if there is none
+    String etag;
+    String lastModified;
+};
+
+/**
+ * FileIndex with its own storage.
+ * @tparam pageCapacity number of entries per page
+ */
+template<uint16_t pageCapacity>
+struct StaticFileIndex : public FileIndex {
+    explicit StaticFileIndex(const String &folder = "", bool isRecursive = false) :
+            FileIndex(storage, pageCapacity, folder, isRecursive) {}
+
+private:
+    FileEntry storage[pageCapacity];
+};
+
+namespace internal {
+
+/**
+ * Reads a listing of /api/files/local ({"files": [..]}) or of a folder ({.., "children": [..]}) entry by entry, the
+ * values not needed are skipped without being stored.
+ */
+DeserializationError readFileListing(Stream &body, FileIndex &index);
+
+} // namespace internal
+} // namespace octoprint
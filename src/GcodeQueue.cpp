@@ -0,0 +1,160 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "GcodeQueue.h"
+
+namespace octoprint {
+
+namespace {
+
+constexpr char bodyPrefix[] = "{\"commands\": [";
+constexpr char bodySuffix[] = "]}";
+constexpr size_t bodyPrefixLength = sizeof(bodyPrefix) - 1;
+constexpr size_t bodySuffixLength = sizeof(bodySuffix) - 1;
+
+} // namespace
+
+GcodeQueue::GcodeQueue(OctoprintClient &client, const GcodeQueueSettings &settings) :
+        client(client),
+        settings(settings) {
+    body[0] = '\0';
+}
+
+bool GcodeQueue::add(const char *line) {
+    if (queuedCount >= settings.maxCommands && !send()) return false;
+
+    if (queuedCount == 0) {
+        strcpy(body, bodyPrefix);
+        bodyLength = bodyPrefixLength;
+    }
+    // the suffix has to fit as well
+    const size_t capacity = sizeof(body) - bodySuffixLength;
+    const size_t previousLength = bodyLength;
+    if (queuedCount > 0) {
+        body[bodyLength++] = ',';
+        body[bodyLength] = '\0';
+    }
+    if (!internal::appendJsonString(body, capacity, bodyLength, line)) {
+        bodyLength = previousLength;
+        body[bodyLength] = '\0';
+        // a batch of its own would not take it either
+        if (queuedCount == 0 || !send()) return false;
+        return add(line);
+    }
+
+    if (queuedCount == 0) firstQueuedMs = millis();
+    queuedCount++;
+    return true;
+}
+
+void GcodeQueue::flush() {
+    if (queuedCount > 0) isFlushRequested = true;
+}
+
+bool GcodeQueue::poll() {
+    // a request of other code is driven as well, the batch due waits for it
+    if (inFlightCount > 0 || client.isBusy()) {
+        client.poll();
+        if (inFlightCount > 0) return true;
+    }
+    if (queuedCount == 0) return false;
+
+    const bool isDue = isFlushRequested || queuedCount >= settings.maxCommands ||
+                       millis() - firstQueuedMs >= settings.latencyWindowMs;
+    if (isDue) send();
+    return true;
+}
+
+bool GcodeQueue::awaitSent() {
+    flush();
+    while (poll()) {
+        yield();
+    }
+    const bool isSent = !hasFailed;
+    hasFailed = false;
+    return isSent;
+}
+
+void GcodeQueue::onBatchSent(GcodeBatchCallback batchCallback) {
+    callback = std::move(batchCallback);
+}
+
+uint8_t GcodeQueue::getQueuedCount() const {
+    return queuedCount;
+}
+
+bool GcodeQueue::isInFlight() const {
+    return inFlightCount > 0;
+}
+
+bool GcodeQueue::send() {
+    if (inFlightCount > 0 || client.isBusy()) return false;
+
+    memcpy(body + bodyLength, bodySuffix, bodySuffixLength + 1);
+    // the client copies the body, the buffer collects the next batch right away
+    if (!client.requestPost("/api/printer/command", body,
+                            [this](const RequestStatus &status) { onCompleted(status); })) {
+        body[bodyLength] = '\0';
+        return false;
+    }
+    inFlightCount = queuedCount;
+    queuedCount = 0;
+    bodyLength = 0;
+    isFlushRequested = false;
+    // connecting happens in the first poll, get it going right away
+    client.poll();
+    return true;
+}
+
+void GcodeQueue::onCompleted(const RequestStatus &status) {
+    GcodeBatchStatus batch;
+    batch.commandsCount = inFlightCount;
+    batch.request = status;
+    inFlightCount = 0;
+    if (!status.isSuccess) hasFailed = true;
+    if (callback) callback(batch);
+}
+
+namespace internal {
+
+bool appendJsonString(char *buffer, size_t capacity, size_t &length, const char *text) {
+    static const char hexDigits[] = "0123456789abcdef";
+    size_t end = length;
+    // one byte is reserved for the terminating null
+    auto put = [&](char c) {
+        if (end + 1 >= capacity) return false;
+        buffer[end++] = c;
+        return true;
+    };
+
+    bool isFitting = put('"');
+    for (const char *c = text; isFitting && *c != '\0'; c++) {
+        const uint8_t byte = static_cast<uint8_t>(*c);
+        if (byte == '"' || byte == '\\') {
+            isFitting = put('\\') && put(*c);
+        } else if (byte == '\n') {
+            isFitting = put('\\') && put('n');
+        } else if (byte == '\r') {
+            isFitting = put('\\') && put('r');
+        } else if (byte == '\t') {
+            isFitting = put('\\') && put('t');
+        } else if (byte < 0x20) {
+            isFitting = put('\\') && put('u') && put('0') && put('0') && put(hexDigits[byte >> 4]) &&
+                        put(hexDigits[byte & 0x0f]);
+        } else {
+            isFitting = put(*c);
+        }
+    }
+    isFitting = isFitting && put('"');
+    if (!isFitting) {
+        buffer[length] = '\0';
+        return false;
+    }
+    length = end;
+    buffer[length] = '\0';
+    return true;
+}
+
+} // namespace internal
+} // namespace octoprint
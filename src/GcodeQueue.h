@@ -0,0 +1,99 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "OctoprintClient.h"
+
+namespace octoprint {
+
+struct GcodeQueueSettings {
+    // a batch is sent as soon as it holds this many lines
+    uint8_t maxCommands{16};
+    // the first line of a batch waits at most this long for more lines to join
+    unsigned long latencyWindowMs{20};
+};
+
+struct GcodeBatchStatus {
+    // number of lines in the batch
+    uint8_t commandsCount{0};
+    RequestStatus request;
+};
+
+using GcodeBatchCallback = std::function<void(const GcodeBatchStatus &status)>;
+
+/**
+ * Collects G-code lines and sends them as one POST /api/printer/command {"commands": [..]}, once the batch is full or
+ * its latency window expired. A macro of dozens of lines, e.g. a purge script, takes a single round trip.
+ * The batch is built in a fixed buffer, lines are escaped as Json strings. While a batch is in flight the next one
+ * is collected. Call poll() from loop(), requests are issued with the client's non-blocking engine.
+ */
+struct GcodeQueue {
+
+    // {"commands": [..]} including the terminating null
+    static constexpr size_t maxBodyLength = 512;
+
+    /** @param client must outlive the queue, requests of other code are waited for */
+    explicit GcodeQueue(OctoprintClient &client, const GcodeQueueSettings &settings = GcodeQueueSettings{});
+
+    /**
+     * Queues a line, e.g. "G28". A full batch is sent first.
+     * @return false if the line does not fit into a batch at all, or the batch is full and cannot be sent yet
+     * because the client is busy; poll() and retry
+     */
+    bool add(const char *line);
+
+    /** Sends the lines queued so far at the next poll() without waiting for the latency window. */
+    void flush();
+
+    /**
+     * Makes progress on the batch in flight or sends the batch due.
+     * @return true while lines are queued or a batch is in flight
+     */
+    bool poll();
+
+    /**
+     * Sends all queued lines and blocks until OctoPrint answered.
+     * @return false if any batch failed since the previous call
+     */
+    bool awaitSent();
+
+    /** @param callback invoked from poll() once a batch was answered */
+    void onBatchSent(GcodeBatchCallback callback);
+
+    /** @return number of lines waiting to be sent */
+    uint8_t getQueuedCount() const;
+
+    bool isInFlight() const;
+
+private:
+    OctoprintClient &client;
+    GcodeQueueSettings settings;
+    GcodeBatchCallback callback;
+
+    char body[maxBodyLength];
+    size_t bodyLength{0};
+    uint8_t queuedCount{0};
+    unsigned long firstQueuedMs{0};
+    bool isFlushRequested{false};
+
+    uint8_t inFlightCount{0};
+    bool hasFailed{false};
+
+    /** Starts the POST of the queued lines. @return false if the client is busy */
+    bool send();
+
+    void onCompleted(const RequestStatus &status);
+};
+
+namespace internal {
+
+/**
+ * Appends text as a quoted Json string to a null terminated buffer.
+ * @return false if it does not fit, the buffer is left as it was
+ */
+bool appendJsonString(char *buffer, size_t capacity, size_t &length, const char *text);
+
+} // namespace internal
+} // namespace octoprint
@@ -0,0 +1,64 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "HostResolver.h"
+
+namespace octoprint {
+namespace internal {
+
+bool HostCache::lookup(const char *hostName, IPAddress &ip) {
+    const bool isCached = (state == State::Resolved && !isExpired(settings.ttlMs)) ||
+                          (state == State::Failed && !isExpired(settings.negativeTtlMs));
+    if (!isCached) resolve(hostName);
+    if (state != State::Resolved) return false;
+    ip = address;
+    return true;
+}
+
+void HostCache::refresh(const char *hostName) {
+    if (settings.refreshAheadMs == 0 || state != State::Resolved || isExpired(settings.ttlMs)) return;
+    // due once less than refreshAheadMs are left
+    const unsigned long refreshAfterMs = (settings.ttlMs > settings.refreshAheadMs)
+                                         ? settings.ttlMs - settings.refreshAheadMs
+                                         : 0;
+    if (!isExpired(refreshAfterMs)) return;
+    if (hasRefreshFailed && millis() - refreshFailedMs < settings.negativeTtlMs) return;
+
+    IPAddress refreshed;
+    hasRefreshFailed = !resolver->resolve(hostName, refreshed);
+    if (hasRefreshFailed) {
+        refreshFailedMs = millis();
+    } else {
+        address = refreshed;
+        sinceMs = millis();
+    }
+}
+
+void HostCache::invalidate() {
+    // a failed resolution stays cached
+    if (state == State::Resolved) state = State::Empty;
+}
+
+bool HostCache::getPinned(IPAddress &ip) const {
+    if (state != State::Resolved || isExpired(settings.ttlMs)) return false;
+    ip = address;
+    return true;
+}
+
+bool HostCache::isExpired(unsigned long ttlMs) const {
+    return millis() - sinceMs >= ttlMs;
+}
+
+bool HostCache::resolve(const char *hostName) {
+    IPAddress resolved;
+    const bool isResolved = resolver->resolve(hostName, resolved);
+    state = isResolved ? State::Resolved : State::Failed;
+    if (isResolved) address = resolved;
+    sinceMs = millis();
+    hasRefreshFailed = false;
+    return isResolved;
+}
+
+} // namespace internal
+} // namespace octoprint
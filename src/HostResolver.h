@@ -0,0 +1,95 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#if defined(ESP32)
+#include <WiFi.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#endif
+
+namespace octoprint {
+
+/**
+ * Resolves host names to addresses, see OctoprintClient::setHostResolver().
+ */
+struct HostResolver {
+    virtual ~HostResolver() = default;
+
+    /** Blocks until the name is resolved. @return false if it cannot be resolved */
+    virtual bool resolve(const char *hostName, IPAddress &ip) = 0;
+};
+
+#if defined(ESP32) || defined(ESP8266)
+
+/**
+ * Resolves with the WiFi stack's DNS client, and on ESP32 with mDNS for .local names if lwIP was built with it.
+ */
+struct WiFiHostResolver : public HostResolver {
+    bool resolve(const char *hostName, IPAddress &ip) override {
+        return WiFi.hostByName(hostName, ip) == 1;
+    }
+};
+
+#endif
+
+struct HostCacheSettings {
+    // a resolved address is used for this long
+    unsigned long ttlMs{300000};
+    // a failed resolution is not retried for this long, connects fail right away meanwhile
+    unsigned long negativeTtlMs{10000};
+    // 0 (default) resolves an expired address on the next connect. Otherwise an address this close to expiry is
+    // resolved again by OctoprintClient::poll() while the client is idle, which blocks that poll() and so the caller's
+    // loop for the lookup; it is kept if that fails and the refresh is retried after negativeTtlMs
+    unsigned long refreshAheadMs{0};
+};
+
+namespace internal {
+
+/**
+ * Single entry cache of the client's host name: pins the resolved address for the connects within its TTL.
+ */
+struct HostCache {
+
+    HostResolver *resolver{nullptr};
+    HostCacheSettings settings;
+
+    /**
+     * Resolves the name unless a result is cached.
+     * @return false if the name cannot be resolved, also while that result is cached
+     */
+    bool lookup(const char *hostName, IPAddress &ip);
+
+    /** Re-resolves an address close to its expiry, the address is kept if that fails. */
+    void refresh(const char *hostName);
+
+    /** Forgets the address, e.g. after connecting to it failed. A failed resolution stays cached. */
+    void invalidate();
+
+    /** @return true and the address if one is pinned */
+    bool getPinned(IPAddress &ip) const;
+
+private:
+    enum class State : uint8_t {
+        Empty,
+        Resolved,
+        Failed
+    };
+
+    State state{State::Empty};
+    IPAddress address;
+    unsigned long sinceMs{0};
+    bool hasRefreshFailed{false};
+    unsigned long refreshFailedMs{0};
+
+    bool isExpired(unsigned long ttlMs) const;
+
+    bool resolve(const char *hostName);
+};
+
+} // namespace internal
+} // namespace octoprint
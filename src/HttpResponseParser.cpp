@@ -0,0 +1,298 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "HttpResponseParser.h"
+
+namespace octoprint {
+namespace internal {
+
+namespace {
+
+char toLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equalsIgnoreCase(const char *text, size_t textLength, const char *other) {
+    size_t idx = 0;
+    for (; idx < textLength && other[idx] != '\0'; idx++) {
+        if (toLower(text[idx]) != toLower(other[idx])) return false;
+    }
+    return idx == textLength && other[idx] == '\0';
+}
+
+bool containsIgnoreCase(const char *text, const char *token) {
+    const size_t tokenLength = strlen(token);
+    for (const char *start = text; *start != '\0'; start++) {
+        size_t idx = 0;
+        while (idx < tokenLength && start[idx] != '\0' && toLower(start[idx]) == toLower(token[idx])) idx++;
+        if (idx == tokenLength) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+HttpResponseParser::HttpResponseParser() {
+    reset();
+}
+
+void HttpResponseParser::reset() {
+    state = State::StatusLine;
+    bodyMode = BodyMode::None;
+    chunkState = ChunkState::Size;
+    chunkRemaining = 0;
+    lineLength = 0;
+    line[0] = '\0';
+    statusCode = 0;
+    contentLength = -1;
+    bodyLength = 0;
+    isChunkedEncoding = false;
+    isHttp10 = false;
+    isKeepAliveRequested = false;
+    isCloseRequested = false;
+    isTruncated = false;
+    etag[0] = '\0';
+    lastModified[0] = '\0';
+}
+
+size_t HttpResponseParser::feed(const char *data, size_t length, BodySink *sink) {
+    size_t consumed = 0;
+    while (consumed < length) {
+        if (state == State::StatusLine || state == State::Headers) {
+            const char c = data[consumed++];
+            if (c == '\n') {
+                line[lineLength] = '\0';
+                processLine();
+                lineLength = 0;
+            } else if (c != '\r' && lineLength < maxLineLength) {
+                // overlong lines are cut, none of the evaluated headers comes close to the limit
+                line[lineLength++] = c;
+            }
+        } else if (state == State::Body && sink != nullptr) {
+            consumed += feedBody(data + consumed, length - consumed, *sink);
+        } else {
+            break;
+        }
+    }
+    return consumed;
+}
+
+void HttpResponseParser::onConnectionClosed() {
+    if (state == State::Body && bodyMode == BodyMode::UntilClose) {
+        state = State::Complete;
+    }
+}
+
+void HttpResponseParser::processLine() {
+    if (state == State::StatusLine) {
+        // tolerate empty lines left over from a previous message
+        if (lineLength > 0) processStatusLine();
+    } else if (lineLength == 0) {
+        beginBody();
+    } else {
+        processHeaderLine();
+    }
+}
+
+void HttpResponseParser::processStatusLine() {
+    // HTTP/1.1 200 OK
+    if (lineLength < 12 || strncmp(line, "HTTP/1.", 7) != 0 || line[8] != ' ') {
+        state = State::Malformed;
+        return;
+    }
+    isHttp10 = line[7] == '0';
+
+    int code = 0;
+    for (uint8_t idx = 9; idx < 12; idx++) {
+        if (line[idx] < '0' || line[idx] > '9') {
+            state = State::Malformed;
+            return;
+        }
+        code = code * 10 + (line[idx] - '0');
+    }
+    statusCode = code;
+    state = State::Headers;
+}
+
+void HttpResponseParser::processHeaderLine() {
+    const char *colon = strchr(line, ':');
+    if (colon == nullptr) return;
+
+    const size_t nameLength = colon - line;
+    const char *value = colon + 1;
+    while (*value == ' ' || *value == '\t') value++;
+    for (char *end = line + lineLength - 1; end >= value && (*end == ' ' || *end == '\t'); end--) *end = '\0';
+
+    if (equalsIgnoreCase(line, nameLength, "Content-Length")) {
+        contentLength = strtol(value, nullptr, 10);
+    } else if (equalsIgnoreCase(line, nameLength, "Transfer-Encoding")) {
+        isChunkedEncoding = containsIgnoreCase(value, "chunked");
+    } else if (equalsIgnoreCase(line, nameLength, "Connection")) {
+        isCloseRequested = containsIgnoreCase(value, "close");
+        isKeepAliveRequested = containsIgnoreCase(value, "keep-alive");
+    } else if (equalsIgnoreCase(line, nameLength, "ETag")) {
+        strncpy(etag, value, maxEtagLength);
+        etag[maxEtagLength] = '\0';
+    } else if (equalsIgnoreCase(line, nameLength, "Last-Modified")) {
+        strncpy(lastModified, value, maxLastModifiedLength);
+        lastModified[maxLastModifiedLength] = '\0';
+    }
+}
+
+void HttpResponseParser::beginBody() {
+    if (statusCode >= 100 && statusCode < 200) {
+        // interim response (e.g. 100 Continue), the final response follows
+        const bool isClosing = isCloseRequested;
+        reset();
+        isCloseRequested = isClosing;
+        return;
+    }
+
+    if (statusCode == 204 || statusCode == 304 || contentLength == 0) {
+        bodyMode = BodyMode::None;
+        state = State::Complete;
+    } else if (isChunkedEncoding) {
+        bodyMode = BodyMode::Chunked;
+        chunkState = ChunkState::Size;
+        chunkRemaining = 0;
+        state = State::Body;
+    } else if (contentLength > 0) {
+        bodyMode = BodyMode::ContentLength;
+        state = State::Body;
+    } else {
+        bodyMode = BodyMode::UntilClose;
+        state = State::Body;
+    }
+}
+
+size_t HttpResponseParser::feedBody(const char *data, size_t length, BodySink &sink) {
+    if (bodyMode == BodyMode::Chunked) return feedChunked(data, length, sink);
+
+    size_t run = length;
+    if (bodyMode == BodyMode::ContentLength) {
+        const unsigned long remaining = static_cast<unsigned long>(contentLength) - bodyLength;
+        if (run > remaining) run = remaining;
+    }
+
+    if (run > 0 && !sink.write(data, run)) isTruncated = true;
+    bodyLength += run;
+
+    if (bodyMode == BodyMode::ContentLength && bodyLength >= static_cast<unsigned long>(contentLength)) {
+        state = State::Complete;
+    }
+    return run;
+}
+
+size_t HttpResponseParser::feedChunked(const char *data, size_t length, BodySink &sink) {
+    // 1a;extension\r\n<0x1a bytes>\r\n ... 0\r\n<trailer lines>\r\n
+    size_t consumed = 0;
+    while (consumed < length && state == State::Body) {
+        if (chunkState == ChunkState::Data) {
+            size_t run = length - consumed;
+            if (run > chunkRemaining) run = chunkRemaining;
+            if (!sink.write(data + consumed, run)) isTruncated = true;
+            bodyLength += run;
+            chunkRemaining -= run;
+            consumed += run;
+            if (chunkRemaining == 0) chunkState = ChunkState::DataEnd;
+            continue;
+        }
+
+        const char c = data[consumed++];
+        switch (chunkState) {
+            case ChunkState::Size:
+                if (c >= '0' && c <= '9') {
+                    chunkRemaining = chunkRemaining * 16 + (c - '0');
+                } else if (toLower(c) >= 'a' && toLower(c) <= 'f') {
+                    chunkRemaining = chunkRemaining * 16 + (toLower(c) - 'a' + 10);
+                } else if (c == ';' || c == ' ' || c == '\t') {
+                    chunkState = ChunkState::Extension;
+                } else if (c == '\n') {
+                    endChunkSizeLine();
+                } else if (c != '\r') {
+                    state = State::Malformed;
+                }
+                if (chunkRemaining > 0x0FFFFFFFUL) state = State::Malformed;
+                break;
+            case ChunkState::Extension:
+                if (c == '\n') endChunkSizeLine();
+                break;
+            case ChunkState::DataEnd:
+                if (c == '\n') {
+                    chunkState = ChunkState::Size;
+                } else if (c != '\r') {
+                    state = State::Malformed;
+                }
+                break;
+            case ChunkState::Trailer:
+                // trailer headers are ignored, an empty line ends the message
+                if (c == '\n') {
+                    if (lineLength == 0) state = State::Complete;
+                    lineLength = 0;
+                } else if (c != '\r') {
+                    lineLength = 1;
+                }
+                break;
+            case ChunkState::Data:
+                break;
+        }
+    }
+    return consumed;
+}
+
+void HttpResponseParser::endChunkSizeLine() {
+    if (chunkRemaining == 0) {
+        chunkState = ChunkState::Trailer;
+        lineLength = 0;
+    } else {
+        chunkState = ChunkState::Data;
+    }
+}
+
+HttpResponseParser::State HttpResponseParser::getState() const {
+    return state;
+}
+
+bool HttpResponseParser::isHeaderComplete() const {
+    return state == State::Body || state == State::Complete;
+}
+
+bool HttpResponseParser::isComplete() const {
+    return state == State::Complete;
+}
+
+bool HttpResponseParser::isBodyTruncated() const {
+    return isTruncated;
+}
+
+int HttpResponseParser::getStatusCode() const {
+    return statusCode;
+}
+
+long HttpResponseParser::getContentLength() const {
+    return contentLength;
+}
+
+bool HttpResponseParser::isChunked() const {
+    return isChunkedEncoding;
+}
+
+bool HttpResponseParser::isConnectionClosing() const {
+    return isCloseRequested || (isHttp10 && !isKeepAliveRequested) || bodyMode == BodyMode::UntilClose;
+}
+
+const char *HttpResponseParser::getEtag() const {
+    return etag;
+}
+
+const char *HttpResponseParser::getLastModified() const {
+    return lastModified;
+}
+
+unsigned long HttpResponseParser::getBodyLength() const {
+    return bodyLength;
+}
+
+} // namespace internal
+} // namespace octoprint
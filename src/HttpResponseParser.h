@@ -0,0 +1,146 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "BodySink.h"
+
+namespace octoprint {
+
+/**
+ * Result of a request/response exchange.
+ */
+enum class RequestOutcome : uint8_t {
+    InProgress,
+    Complete,
+    // no complete response within the timeout
+    Timeout,
+    // the body did not fit into the body sink, the response was consumed but the body is incomplete
+    Truncated,
+    // the server closed the connection before the response was complete
+    ConnectionClosed,
+    ConnectionFailed,
+    Malformed,
+    // the request body could not be read completely from its source, e.g. of an upload
+    SourceFailed
+};
+
+namespace internal {
+
+/**
+ * Incremental HTTP/1.x response parser.
+ * Bytes may be fed in blocks of any size. The parser keeps no heap state: it extracts the status code and the few
+ * headers the client needs (Content-Length, Transfer-Encoding, Connection, ETag, Last-Modified) and hands the body to a BodySink.
+ * Chunked bodies are decoded on the fly, the response completes with the terminating zero-length chunk.
+ */
+struct HttpResponseParser {
+
+    enum class State : uint8_t {
+        StatusLine,
+        Headers,
+        Body,
+        Complete,
+        Malformed
+    };
+
+    static constexpr uint8_t maxLineLength = 127;
+    static constexpr uint8_t maxEtagLength = 63;
+    // e.g. "Wed, 21 Oct 2015 07:28:00 GMT"
+    static constexpr uint8_t maxLastModifiedLength = 31;
+
+    HttpResponseParser();
+
+    void reset();
+
+    /**
+     * Consumes bytes until the response is complete.
+     * Without sink the parser stops after the header section so that the body can be consumed later.
+     * @return number of bytes consumed, remaining bytes belong to the body (if sink is null) or are not part of this
+     * response
+     */
+    size_t feed(const char *data, size_t length, BodySink *sink);
+
+    /**
+     * Tells the parser that the peer closed the connection, which terminates bodies without length information.
+     */
+    void onConnectionClosed();
+
+    State getState() const;
+
+    bool isHeaderComplete() const;
+
+    bool isComplete() const;
+
+    bool isBodyTruncated() const;
+
+    int getStatusCode() const;
+
+    long getContentLength() const;
+
+    bool isChunked() const;
+
+    /** @return true if the server will close the connection after this response */
+    bool isConnectionClosing() const;
+
+    /** @return the ETag header value or an empty string */
+    const char *getEtag() const;
+
+    /** @return the Last-Modified header value or an empty string */
+    const char *getLastModified() const;
+
+    unsigned long getBodyLength() const;
+
+private:
+    enum class BodyMode : uint8_t {
+        None,
+        ContentLength,
+        Chunked,
+        UntilClose
+    };
+
+    enum class ChunkState : uint8_t {
+        Size,
+        Extension,
+        Data,
+        DataEnd,
+        Trailer
+    };
+
+    State state;
+    BodyMode bodyMode;
+    ChunkState chunkState;
+    unsigned long chunkRemaining;
+
+    char line[maxLineLength + 1];
+    uint8_t lineLength;
+
+    int statusCode;
+    long contentLength;
+    unsigned long bodyLength;
+    bool isChunkedEncoding;
+    bool isHttp10;
+    bool isKeepAliveRequested;
+    bool isCloseRequested;
+    bool isTruncated;
+    char etag[maxEtagLength + 1];
+    char lastModified[maxLastModifiedLength + 1];
+
+    void processLine();
+
+    void processStatusLine();
+
+    void processHeaderLine();
+
+    void beginBody();
+
+    size_t feedBody(const char *data, size_t length, BodySink &sink);
+
+    size_t feedChunked(const char *data, size_t length, BodySink &sink);
+
+    void endChunkSizeLine();
+};
+
+} // namespace internal
+} // namespace octoprint
@@ -0,0 +1,165 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "HttpResponseReader.h"
+
+namespace octoprint {
+namespace internal {
+
+namespace {
+
+/**
+ * Moves decoded body bytes to the front of the receive buffer.
+ * Decoding never expands the data, so the write position always stays behind the parser's read position.
+ */
+struct InPlaceBodySink : public BodySink {
+
+    explicit InPlaceBodySink(char *buffer) : buffer{buffer} {}
+
+    bool write(const char *data, size_t length) override {
+        memmove(buffer + used, data, length);
+        used += length;
+        return true;
+    }
+
+    char *buffer;
+    size_t used{0};
+};
+
+} // namespace
+
+HttpResponseReader::HttpResponseReader(Client &client, char *buffer, size_t bufferSize, unsigned long timeoutMs) :
+        client(client),
+        buffer{buffer},
+        bufferSize{bufferSize},
+        startMs{millis()},
+        timeoutMs{timeoutMs} {
+    // read() blocks on its own deadline, Stream's per byte timeout must not add to it
+    setTimeout(0);
+}
+
+void HttpResponseReader::reset() {
+    parser.reset();
+    bufferBegin = bufferEnd = 0;
+    decodedBegin = decodedEnd = 0;
+    bytesReceived = 0;
+    startMs = millis();
+}
+
+void HttpResponseReader::setBlocking(bool isBlocking) {
+    this->isBlocking = isBlocking;
+}
+
+RequestOutcome HttpResponseReader::readHeaders() {
+    while (!parser.isHeaderComplete()) {
+        if (parser.getState() == HttpResponseParser::State::Malformed) return RequestOutcome::Malformed;
+
+        if (bufferBegin == bufferEnd) {
+            const RequestOutcome outcome = receive();
+            if (outcome == RequestOutcome::ConnectionClosed) return outcomeOnClose();
+            if (outcome != RequestOutcome::InProgress) return outcome;
+            if (bufferBegin == bufferEnd) return RequestOutcome::InProgress;
+        }
+        bufferBegin += parser.feed(buffer + bufferBegin, bufferEnd - bufferBegin, nullptr);
+    }
+    return parser.isComplete() ? RequestOutcome::Complete : RequestOutcome::InProgress;
+}
+
+RequestOutcome HttpResponseReader::readBody(BodySink &sink) {
+    // body bytes decoded for the Stream interface but not yet read belong to the sink
+    const bool isPendingTruncated =
+            decodedBegin < decodedEnd && !sink.write(buffer + decodedBegin, decodedEnd - decodedBegin);
+    decodedBegin = decodedEnd = 0;
+    for (;;) {
+        if (bufferBegin < bufferEnd) {
+            bufferBegin += parser.feed(buffer + bufferBegin, bufferEnd - bufferBegin, &sink);
+        }
+        if (parser.isComplete()) {
+            // bytes beyond the response are not expected since requests are not pipelined
+            bufferBegin = bufferEnd;
+            return (isPendingTruncated || parser.isBodyTruncated()) ? RequestOutcome::Truncated : RequestOutcome::Complete;
+        }
+        if (parser.getState() == HttpResponseParser::State::Malformed) return RequestOutcome::Malformed;
+
+        const RequestOutcome outcome = receive();
+        if (outcome == RequestOutcome::ConnectionClosed) return outcomeOnClose();
+        if (outcome != RequestOutcome::InProgress) return outcome;
+        if (bufferBegin == bufferEnd) return RequestOutcome::InProgress;
+    }
+}
+
+const HttpResponseParser &HttpResponseReader::getParser() const {
+    return parser;
+}
+
+unsigned long HttpResponseReader::getBytesReceived() const {
+    return bytesReceived;
+}
+
+unsigned long HttpResponseReader::getFirstByteUs() const {
+    return firstByteUs;
+}
+
+int HttpResponseReader::available() {
+    return static_cast<int>(decodedEnd - decodedBegin);
+}
+
+int HttpResponseReader::read() {
+    if (!fillDecoded()) return -1;
+    return static_cast<uint8_t>(buffer[decodedBegin++]);
+}
+
+int HttpResponseReader::peek() {
+    if (!fillDecoded()) return -1;
+    return static_cast<uint8_t>(buffer[decodedBegin]);
+}
+
+RequestOutcome HttpResponseReader::receive() {
+    while (!client.available()) {
+        if (!client.connected()) return RequestOutcome::ConnectionClosed;
+        if (millis() - startMs >= timeoutMs) return RequestOutcome::Timeout;
+        if (!isBlocking) return RequestOutcome::InProgress;
+        yield();
+    }
+
+    const int received = client.read(reinterpret_cast<uint8_t *>(buffer), bufferSize);
+    bufferBegin = 0;
+    bufferEnd = (received > 0) ? static_cast<size_t>(received) : 0;
+    if (bytesReceived == 0 && bufferEnd > 0) firstByteUs = micros();
+    bytesReceived += bufferEnd;
+    return RequestOutcome::InProgress;
+}
+
+RequestOutcome HttpResponseReader::outcomeOnClose() {
+    parser.onConnectionClosed();
+    if (!parser.isComplete()) return RequestOutcome::ConnectionClosed;
+    return parser.isBodyTruncated() ? RequestOutcome::Truncated : RequestOutcome::Complete;
+}
+
+bool HttpResponseReader::fillDecoded() {
+    if (!parser.isHeaderComplete()) return false;
+
+    while (decodedBegin == decodedEnd) {
+        if (parser.isComplete()) return false;
+        if (parser.getState() == HttpResponseParser::State::Malformed) return false;
+
+        if (bufferBegin == bufferEnd) {
+            RequestOutcome outcome = receive();
+            if (outcome == RequestOutcome::ConnectionClosed) outcome = outcomeOnClose();
+            if (outcome != RequestOutcome::InProgress) return false;
+            if (bufferBegin == bufferEnd && !isBlocking) return false;
+            continue;
+        }
+
+        InPlaceBodySink sink(buffer);
+        bufferBegin += parser.feed(buffer + bufferBegin, bufferEnd - bufferBegin, &sink);
+        if (parser.isComplete()) bufferBegin = bufferEnd;
+        decodedBegin = 0;
+        decodedEnd = sink.used;
+    }
+    return true;
+}
+
+} // namespace internal
+} // namespace octoprint
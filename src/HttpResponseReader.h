@@ -0,0 +1,95 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <Client.h>
+#include "HttpResponseParser.h"
+
+namespace octoprint {
+namespace internal {
+
+/**
+ * Reads a response from the Client in blocks into a caller provided buffer and drives the HttpResponseParser.
+ * The timeout applies to the whole response, measured from construction or reset().
+ *
+ * Once the headers are read the body is available either through readBody() or, as decoded bytes, through the
+ * Stream interface so that it can be deserialized without buffering it first.
+ *
+ * In non-blocking mode readHeaders() and readBody() only process what already arrived and return InProgress when
+ * they have to wait. The Stream interface is meant for blocking mode only.
+ */
+struct HttpResponseReader : public Stream {
+
+    HttpResponseReader(Client &client, char *buffer, size_t bufferSize, unsigned long timeoutMs);
+
+    /**
+     * Discards all state and restarts the timeout for a new response.
+     */
+    void reset();
+
+    void setBlocking(bool isBlocking);
+
+    /**
+     * Blocks until the header section was parsed.
+     * @return InProgress if the body is still to be read (or, in non-blocking mode, the headers are not yet complete),
+     * Complete if the response has no body, otherwise the error
+     */
+    RequestOutcome readHeaders();
+
+    /**
+     * Blocks until the remaining body was passed to the sink.
+     * Bytes already handed out through the Stream interface are not passed again.
+     * @return Complete, Truncated if the sink dropped bytes, otherwise the error
+     */
+    RequestOutcome readBody(BodySink &sink);
+
+    const HttpResponseParser &getParser() const;
+
+    /** @return number of raw bytes received from the client so far */
+    unsigned long getBytesReceived() const;
+
+    /** @return micros() when the first bytes of the response arrived, only valid once bytes were received */
+    unsigned long getFirstByteUs() const;
+
+    /** @return number of decoded body bytes readily available without blocking */
+    int available() override;
+
+    /** Blocks until the next body byte arrived. @return -1 at the end of the body, on timeout or error */
+    int read() override;
+
+    int peek() override;
+
+    size_t write(uint8_t) override {
+        return 0;
+    }
+
+private:
+    Client &client;
+    char *buffer;
+    size_t bufferSize;
+    // raw bytes received but not yet fed to the parser
+    size_t bufferBegin{0};
+    size_t bufferEnd{0};
+    // decoded body bytes at the front of the buffer not yet handed out via read()
+    size_t decodedBegin{0};
+    size_t decodedEnd{0};
+
+    HttpResponseParser parser;
+    unsigned long startMs;
+    unsigned long timeoutMs;
+    unsigned long bytesReceived{0};
+    unsigned long firstByteUs{0};
+    bool isBlocking{true};
+
+    RequestOutcome receive();
+
+    RequestOutcome outcomeOnClose();
+
+    bool fillDecoded();
+};
+
+} // namespace internal
+} // namespace octoprint
@@ -0,0 +1,166 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <string.h>
+#include <type_traits>
+
+namespace octoprint {
+namespace internal {
+
+/**
+ * Assigns only if the value differs, so that unchanged Strings are not reallocated and changes can be counted.
+ */
+template<typename T>
+void update(T &field, T value, bool &isChanged) {
+    if (field == value) return;
+    field = value;
+    isChanged = true;
+}
+
+inline void update(float &field, float value, bool &isChanged) {
+    // NaN compares unequal to itself, a NaN staying NaN is no change
+    const bool isBothNan = field != field && value != value;
+    if (field == value || isBothNan) return;
+    field = value;
+    isChanged = true;
+}
+
+inline void update(String &field, const char *value, bool &isChanged) {
+    if (field == value) return;
+    field = value;
+    isChanged = true;
+}
+
+/**
+ * Maps a member of a Json object onto a field of Target, or the members of a nested object onto further bindings.
+ * Bindings are listed in constexpr tables, one entry per field:
+ *
+ *     constexpr JsonBinding<Job> fileBindings[] = {
+ *             {"name", &bindText<Job, &Job::jobFileName>},
+ *             {"size", &bindValue<Job, long, &Job::jobFileSize>},
+ *     };
+ *     constexpr JsonBinding<Job> jobBindings[] = {
+ *             {"file", fileBindings},
+ *     };
+ *
+ * The tables are applied to a deserialized JsonDocument, not to a stream of parse events: ArduinoJson 6 has no event
+ * parser. Instead selectBindings() turns the same tables into the deserialization filter, so that the document only
+ * holds the bound members, and applyBindings() compares each member's key with the bindings of its object, i.e.
+ * members x bindings strcmp() of short keys per object, with at most 32 bindings per object.
+ */
+template<typename Target>
+struct JsonBinding {
+    using Apply = void (*)(Target &target, JsonVariantConst value, bool &isChanged);
+
+    constexpr JsonBinding(const char *key, Apply apply) : key(key), apply(apply), members(nullptr), membersCount(0) {}
+
+    template<size_t count>
+    constexpr JsonBinding(const char *key, const JsonBinding (&members)[count]) :
+            key(key), apply(nullptr), members(members), membersCount(static_cast<uint8_t>(count)) {
+        static_assert(count <= 32, "at most 32 bindings per object");
+    }
+
+    const char *key;
+    // assigns the member's value, null if the member is missing; null for nested objects
+    Apply apply;
+    // bindings of the members of a nested object
+    const JsonBinding *members;
+    uint8_t membersCount;
+};
+
+/** Assigns a number or bool, null assigns 0. */
+template<typename Target, typename T, T Target::*field>
+void bindValue(Target &target, JsonVariantConst value, bool &isChanged) {
+    update(target.*field, value.as<T>(), isChanged);
+}
+
+/** Assigns a string, null assigns "". */
+template<typename Target, String Target::*field>
+void bindText(Target &target, JsonVariantConst value, bool &isChanged) {
+    update(target.*field, value | "", isChanged);
+}
+
+/** Sets the flag in a bit set if the value is true, clears it otherwise. */
+template<typename Target, typename Flags, Flags Target::*field, Flags flag>
+void bindFlag(Target &target, JsonVariantConst value, bool &isChanged) {
+    using Underlying = typename std::underlying_type<Flags>::type;
+    const Underlying bits = static_cast<Underlying>(target.*field);
+    const Underlying mask = static_cast<Underlying>(flag);
+    update(target.*field, static_cast<Flags>(value.as<bool>() ? (bits | mask) : (bits & ~mask)), isChanged);
+}
+
+/**
+ * Applies the members of an object in a single pass over them; members without binding are ignored.
+ * Missing members of nested objects are applied as null, as if OctoPrint had sent null for them.
+ * @param isMissingApplied also apply missing members of this object as null, otherwise their fields are left
+ * @return true if any field changed
+ */
+template<typename Target>
+bool applyBindings(JsonObjectConst object, const JsonBinding<Target> *bindings, uint8_t count, Target &target,
+                   bool isMissingApplied = true) {
+    bool isChanged = false;
+    uint32_t appliedMask = 0;
+    for (JsonPairConst member : object) {
+        const char *key = member.key().c_str();
+        for (uint8_t idx = 0; idx < count; idx++) {
+            if (strcmp(key, bindings[idx].key) != 0) continue;
+            appliedMask |= 1ul << idx;
+            const JsonBinding<Target> &binding = bindings[idx];
+            if (binding.members != nullptr) {
+                isChanged |= applyBindings(member.value().as<JsonObjectConst>(), binding.members,
+                                           binding.membersCount, target);
+            } else {
+                binding.apply(target, member.value(), isChanged);
+            }
+            break;
+        }
+    }
+    for (uint8_t idx = 0; isMissingApplied && idx < count; idx++) {
+        if ((appliedMask & (1ul << idx)) != 0) continue;
+        const JsonBinding<Target> &binding = bindings[idx];
+        if (binding.members != nullptr) {
+            // a null object has no members, all of them are applied as null
+            isChanged |= applyBindings(JsonObjectConst(), binding.members, binding.membersCount, target);
+        } else {
+            binding.apply(target, JsonVariantConst(), isChanged);
+        }
+    }
+    return isChanged;
+}
+
+template<typename Target, size_t count>
+bool applyBindings(JsonObjectConst object, const JsonBinding<Target> (&bindings)[count], Target &target,
+                   bool isMissingApplied = true) {
+    static_assert(count <= 32, "at most 32 bindings per object");
+    return applyBindings(object, bindings, static_cast<uint8_t>(count), target, isMissingApplied);
+}
+
+/**
+ * Adds the paths of the bindings to a deserialization filter, so that only bound members are materialized.
+ */
+template<typename Target>
+void selectBindings(JsonObject filter, const JsonBinding<Target> *bindings, uint8_t count) {
+    for (uint8_t idx = 0; idx < count; idx++) {
+        const JsonBinding<Target> &binding = bindings[idx];
+        if (binding.members == nullptr) {
+            filter[binding.key] = true;
+            continue;
+        }
+        JsonObject members = filter[binding.key].template as<JsonObject>();
+        if (members.isNull()) members = filter.createNestedObject(binding.key);
+        selectBindings(members, binding.members, binding.membersCount);
+    }
+}
+
+template<typename Target, size_t count>
+void selectBindings(JsonObject filter, const JsonBinding<Target> (&bindings)[count]) {
+    selectBindings(filter, bindings, static_cast<uint8_t>(count));
+}
+
+} // namespace internal
+} // namespace octoprint
@@ -0,0 +1,141 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "MotionChannel.h"
+
+namespace octoprint {
+
+namespace {
+
+// 1 km, far beyond any printer's travel; sums of clamped moves stay within int32_t
+constexpr int32_t maxMoveUm = 1000000000;
+
+int32_t toMicrometres(float mm) {
+    // NaN
+    if (mm != mm) return 0;
+    if (mm >= maxMoveUm / 1000) return maxMoveUm;
+    if (mm <= -maxMoveUm / 1000) return -maxMoveUm;
+    return static_cast<int32_t>(lround(mm * 1000));
+}
+
+void accumulate(int32_t &sumUm, int32_t deltaUm) {
+    sumUm += deltaUm;
+    if (sumUm > maxMoveUm) sumUm = maxMoveUm;
+    if (sumUm < -maxMoveUm) sumUm = -maxMoveUm;
+}
+
+} // namespace
+
+MotionChannel::MotionChannel(OctoprintClient &client, const MotionSettings &settings) :
+        client(client),
+        settings(settings),
+        lastSentMs{millis() - settings.intervalMs} {
+    MotionSettings &adjusted = this->settings;
+    if (adjusted.staleMs < 2 * adjusted.intervalMs) adjusted.staleMs = 2 * adjusted.intervalMs;
+}
+
+void MotionChannel::jog(float dx, float dy, float dz) {
+    const int32_t dxUm = toMicrometres(dx);
+    const int32_t dyUm = toMicrometres(dy);
+    const int32_t dzUm = toMicrometres(dz);
+    if (dxUm == 0 && dyUm == 0 && dzUm == 0) return;
+    if (!hasJog) jogSinceMs = millis();
+    accumulate(x, dxUm);
+    accumulate(y, dyUm);
+    accumulate(z, dzUm);
+    hasJog = true;
+}
+
+void MotionChannel::extrude(float delta) {
+    const int32_t deltaUm = toMicrometres(delta);
+    if (deltaUm == 0) return;
+    if (!hasExtrusion) extrusionSinceMs = millis();
+    accumulate(amount, deltaUm);
+    hasExtrusion = true;
+}
+
+bool MotionChannel::poll() {
+    // a request of other code is driven as well, the moves due wait for it
+    if (isInFlight || client.isBusy()) {
+        client.poll();
+        if (isInFlight) return true;
+    }
+    const unsigned long now = millis();
+    dropStale(now);
+    if (!hasJog && !hasExtrusion) return false;
+    if (now - lastSentMs < settings.intervalMs || client.isBusy()) return true;
+
+    // moves that cancelled out are not sent
+    if (hasJog && x == 0 && y == 0 && z == 0) hasJog = false;
+    if (hasExtrusion && amount == 0) hasExtrusion = false;
+    // the move waiting longer goes first, neither starves the other
+    const bool isExtrusionFirst = hasExtrusion && (!hasJog || static_cast<long>(extrusionSinceMs - jogSinceMs) < 0);
+    if (isExtrusionFirst) {
+        sendExtrusion();
+    } else if (hasJog) {
+        sendJog();
+    }
+    return hasJog || hasExtrusion || isInFlight;
+}
+
+void MotionChannel::cancel() {
+    x = y = z = amount = 0;
+    hasJog = hasExtrusion = false;
+}
+
+uint32_t MotionChannel::getDroppedCount() const {
+    return droppedCount;
+}
+
+uint32_t MotionChannel::getSentCount() const {
+    return sentCount;
+}
+
+void MotionChannel::dropStale(unsigned long now) {
+    if (hasJog && now - jogSinceMs >= settings.staleMs) {
+        x = y = z = 0;
+        hasJog = false;
+        droppedCount++;
+    }
+    if (hasExtrusion && now - extrusionSinceMs >= settings.staleMs) {
+        amount = 0;
+        hasExtrusion = false;
+        droppedCount++;
+    }
+}
+
+bool MotionChannel::sendJog() {
+    char speed[24] = "";
+    if (settings.speed != 0) snprintf(speed, sizeof(speed), ", \"speed\": %u", settings.speed);
+    // fits the longest clamped moves
+    char body[160];
+    snprintf(body, sizeof(body),
+             "{\"command\": \"jog\", \"x\": %.3f, \"y\": %.3f, \"z\": %.3f%s, \"absolute\": false}",
+             x / 1000.0, y / 1000.0, z / 1000.0, speed);
+    if (!send("/api/printer/printhead", body)) return false;
+    x = y = z = 0;
+    hasJog = false;
+    return true;
+}
+
+bool MotionChannel::sendExtrusion() {
+    char body[96];
+    snprintf(body, sizeof(body), "{\"command\": \"extrude\", \"amount\": %.3f}", amount / 1000.0);
+    if (!send("/api/printer/tool", body)) return false;
+    amount = 0;
+    hasExtrusion = false;
+    return true;
+}
+
+bool MotionChannel::send(const char *command, const char *body) {
+    isInFlight = client.requestPost(command, body, [this](const RequestStatus &) { isInFlight = false; });
+    if (!isInFlight) return false;
+    lastSentMs = millis();
+    sentCount++;
+    // connecting happens in the first poll, get it going right away
+    client.poll();
+    return true;
+}
+
+} // namespace octoprint
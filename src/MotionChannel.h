@@ -0,0 +1,87 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "OctoprintClient.h"
+
+namespace octoprint {
+
+struct MotionSettings {
+    // at most one request is started per interval
+    unsigned long intervalMs{100};
+    // input that waited this long because OctoPrint is slower than the input is dropped instead of replayed;
+    // at least twice intervalMs, smaller values are raised so that moves are not dropped before their turn
+    unsigned long staleMs{500};
+    // feed rate of jogs in mm/min, 0 uses OctoPrint's default
+    uint16_t speed{0};
+};
+
+/**
+ * Interactive print head and extruder control, e.g. from a rotary encoder or a joystick.
+ *
+ * Relative moves are accumulated and merged into one jog (POST /api/printer/printhead) and one extrude
+ * (POST /api/printer/tool) request per interval, so the request rate stays bounded however fast the input arrives.
+ * While OctoPrint answers slower than that, moves keep accumulating; once they waited longer than staleMs they are
+ * dropped, so that the head does not keep moving long after the input stopped.
+ * Moves are summed in whole micrometres, the resolution of the requests, so that moves cancelling each other out
+ * sum up to exactly 0 and send nothing.
+ * Call poll() from loop(), requests are issued with the client's non-blocking engine.
+ */
+struct MotionChannel {
+
+    /** @param client must outlive the channel, requests of other code are waited for */
+    explicit MotionChannel(OctoprintClient &client, const MotionSettings &settings = MotionSettings{});
+
+    /** Adds a relative move in mm, rounded to micrometres. */
+    void jog(float dx, float dy, float dz);
+
+    /** Adds a relative extrusion in mm, rounded to micrometres, negative retracts. */
+    void extrude(float delta);
+
+    /**
+     * Makes progress on the request in flight or sends the moves due.
+     * @return true while moves are pending or a request is in flight
+     */
+    bool poll();
+
+    /** Drops the moves not sent yet. */
+    void cancel();
+
+    /** @return number of merged moves dropped because they became stale */
+    uint32_t getDroppedCount() const;
+
+    /** @return number of merged moves sent */
+    uint32_t getSentCount() const;
+
+private:
+    OctoprintClient &client;
+    MotionSettings settings;
+
+    // accumulated moves in micrometres
+    int32_t x{0};
+    int32_t y{0};
+    int32_t z{0};
+    bool hasJog{false};
+    unsigned long jogSinceMs{0};
+
+    int32_t amount{0};
+    bool hasExtrusion{false};
+    unsigned long extrusionSinceMs{0};
+
+    bool isInFlight{false};
+    unsigned long lastSentMs{0};
+    uint32_t droppedCount{0};
+    uint32_t sentCount{0};
+
+    void dropStale(unsigned long now);
+
+    bool sendJog();
+
+    bool sendExtrusion();
+
+    bool send(const char *command, const char *body);
+};
+
+} // namespace octoprint
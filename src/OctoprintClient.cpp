@@ -5,9 +5,386 @@
 
 #include "Arduino.h"
 #include "OctoprintClient.h"
+#include "JsonBinding.h"
 
 namespace octoprint {
 
+namespace {
+
+/**
+ * How an Operation goes on the wire, indexed by Operation.
+ * Get, Post, FetchTemperatureHistory and FetchFiles are templates whose endpoint and body are given per request, the
+ * body of Upload is streamed.
+ */
+struct CommandDescriptor {
+    Operation operation;
+    const char *method;
+    const char *endpoint;
+    const char *body;
+    // status code signalling success, 0 accepts any 2xx
+    int expectedStatus;
+};
+
+constexpr CommandDescriptor commands[] = {
+        {Operation::Get, "GET", "", "", 0},
+        {Operation::Post, "POST", "", "", 204},
+        {Operation::FetchOctoprintVersion, "GET", "/api/version", "", 200},
+        {Operation::FetchPrinterStatistics, "GET", "/api/printer", "", 200},
+        {Operation::FetchPrintJob, "GET", "/api/job", "", 200},
+        {Operation::FetchPrinterBed, "GET", "/api/printer/bed?history=true&limit=2", "", 200},
+        {Operation::FetchPrinterSdStatus, "GET", "/api/printer/sd", "", 200},
+        {Operation::FetchTemperatureHistory, "GET", "", "", 200},
+        {Operation::FetchFiles, "GET", "", "", 200},
+        {Operation::Login, "POST", "/api/login", "{\"passive\": true}", 200},
+        {Operation::Upload, "POST", "/api/files/local", "", 201},
+        {Operation::ConnectionConnect, "POST", "/api/connection", "{\"command\": \"connect\"}", 204},
+        {Operation::ConnectionDisconnect, "POST", "/api/connection", "{\"command\": \"disconnect\"}", 204},
+        {Operation::ConnectionFakeAck, "POST", "/api/connection", "{\"command\": \"fake_ack\"}", 204},
+        {Operation::PrintHeadHome, "POST", "/api/printer/printhead",
+                "{\"command\": \"home\",\"axes\": [\"x\", \"y\"]}", 204},
+        {Operation::JobStart, "POST", "/api/job", "{\"command\": \"start\"}", 204},
+        {Operation::JobCancel, "POST", "/api/job", "{\"command\": \"cancel\"}", 204},
+        {Operation::JobRestart, "POST", "/api/job", "{\"command\": \"restart\"}", 204},
+        {Operation::JobPauseResume, "POST", "/api/job", "{\"command\": \"pause\"}", 204},
+        {Operation::JobPause, "POST", "/api/job", "{\"command\": \"pause\", \"action\": \"pause\"}", 204},
+        {Operation::JobResume, "POST", "/api/job", "{\"command\": \"pause\", \"action\": \"resume\"}", 204},
+        {Operation::SdInit, "POST", "/api/printer/sd", "{\"command\": \"init\"}", 204},
+        {Operation::SdRefresh, "POST", "/api/printer/sd", "{\"command\": \"refresh\"}", 204},
+        {Operation::SdRelease, "POST", "/api/printer/sd", "{\"command\": \"release\"}", 204},
+};
+
+static_assert(sizeof(commands) / sizeof(commands[0]) == operationsCount, "one command per Operation");
+
+constexpr bool isCommandTableOrdered(uint8_t idx) {
+    return idx == operationsCount ||
+           (static_cast<uint8_t>(commands[idx].operation) == idx && isCommandTableOrdered(idx + 1));
+}
+
+static_assert(isCommandTableOrdered(0), "commands must be listed in Operation order");
+
+const CommandDescriptor &describeOperation(Operation operation) {
+    return commands[static_cast<uint8_t>(operation)];
+}
+
+// delimits the parts of an upload, must not occur in the uploaded file
+constexpr const char *uploadBoundary = "----OctoprintClientUpload7d3f1c9a2b";
+
+/**
+ * Endpoints of FetchPrinterStatistics indexed by PrinterFields, without and with the newest temperature sample.
+ * With a temperature history attached every poll of the temperatures brings a server timestamped sample along.
+ */
+constexpr const char *printerStatisticsEndpoints[][2] = {
+        {"/api/printer?exclude=sd", "/api/printer?exclude=sd&history=true&limit=1"},
+        {"/api/printer?exclude=temperature,sd", "/api/printer?exclude=temperature,sd"},
+        {"/api/printer?exclude=state,sd", "/api/printer?exclude=state,sd&history=true&limit=1"},
+        {"/api/printer?exclude=sd", "/api/printer?exclude=sd&history=true&limit=1"},
+};
+
+static_assert(sizeof(printerStatisticsEndpoints) / sizeof(printerStatisticsEndpoints[0]) ==
+              static_cast<uint8_t>(PrinterFields::All) + 1, "one endpoint per PrinterFields");
+
+/**
+ * Collects the many small pieces of a request and hands them to the Client in few writes.
+ * Each write to a WiFiClient may leave as its own TCP segment.
+ */
+struct CoalescingPrint : public Print {
+
+    explicit CoalescingPrint(Client &client) : client(client) {}
+
+    size_t write(uint8_t c) override {
+        if (length == sizeof(buffer)) send();
+        buffer[length++] = c;
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t size) override {
+        for (size_t written = 0; written < size;) {
+            if (length == sizeof(buffer)) send();
+            size_t run = size - written;
+            if (run > sizeof(buffer) - length) run = sizeof(buffer) - length;
+            memcpy(buffer + length, data + written, run);
+            length += run;
+            written += run;
+        }
+        return size;
+    }
+
+    void send() {
+        if (length > 0) client.write(buffer, length);
+        length = 0;
+    }
+
+    using Print::write;
+
+private:
+    Client &client;
+    uint8_t buffer[256];
+    size_t length{0};
+};
+
+using internal::update;
+using internal::JsonBinding;
+using internal::bindValue;
+using internal::bindText;
+using internal::applyBindings;
+using internal::selectBindings;
+
+template<PrinterState::OperationalStateFlags flag>
+void bindStateFlag(PrinterState &target, JsonVariantConst value, bool &isChanged) {
+    internal::bindFlag<PrinterState, PrinterState::OperationalStateFlags, &PrinterState::stateFlags, flag>(
+            target, value, isChanged);
+}
+
+// /api/printer "state", each flag sets or clears its bit so that e.g. operational and printing are reported together
+constexpr JsonBinding<PrinterState> stateFlagBindings[] = {
+        {"closedOrError", &bindStateFlag<PrinterState::OperationalStateFlags::ClosedOrError>},
+        {"error", &bindStateFlag<PrinterState::OperationalStateFlags::Error>},
+        {"operational", &bindStateFlag<PrinterState::OperationalStateFlags::Operational>},
+        {"paused", &bindStateFlag<PrinterState::OperationalStateFlags::Paused>},
+        {"printing", &bindStateFlag<PrinterState::OperationalStateFlags::Printing>},
+        {"ready", &bindStateFlag<PrinterState::OperationalStateFlags::Ready>},
+        {"sdReady", &bindStateFlag<PrinterState::OperationalStateFlags::SdReady>},
+};
+constexpr JsonBinding<PrinterState> stateBindings[] = {
+        {"text", &bindText<PrinterState, &PrinterState::printerStateText>},
+        {"flags", stateFlagBindings},
+};
+constexpr JsonBinding<PrinterState> printerStateBindings[] = {
+        {"state", stateBindings},
+};
+
+using Thermal = PrinterState::Thermal;
+
+// /api/printer/bed, its history array is read separately
+constexpr JsonBinding<Thermal> bedStateBindings[] = {
+        {"actual", &bindValue<Thermal, float, &Thermal::bedCurrentCelsius>},
+        {"offset", &bindValue<Thermal, float, &Thermal::bedOffsetCelsius>},
+        {"target", &bindValue<Thermal, float, &Thermal::bedTargetCelsius>},
+};
+constexpr JsonBinding<Thermal> bedBindings[] = {
+        {"bed", bedStateBindings},
+};
+
+// /api/job "job" and "progress", also part of push messages
+using internal::JobRequest;
+constexpr JsonBinding<JobRequest> jobFileBindings[] = {
+        {"date", &bindValue<JobRequest, long, &JobRequest::jobFileDate>},
+        {"name", &bindText<JobRequest, &JobRequest::jobFileName>},
+        {"origin", &bindText<JobRequest, &JobRequest::jobFileOrigin>},
+        {"size", &bindValue<JobRequest, long, &JobRequest::jobFileSize>},
+};
+constexpr JsonBinding<JobRequest> tool0FilamentBindings[] = {
+        {"length", &bindValue<JobRequest, long, &JobRequest::jobFilamentTool0Length>},
+        {"volume", &bindValue<JobRequest, float, &JobRequest::jobFilamentTool0Volume>},
+};
+constexpr JsonBinding<JobRequest> tool1FilamentBindings[] = {
+        {"length", &bindValue<JobRequest, long, &JobRequest::jobFilamentTool1Length>},
+        {"volume", &bindValue<JobRequest, float, &JobRequest::jobFilamentTool1Volume>},
+};
+constexpr JsonBinding<JobRequest> filamentBindings[] = {
+        {"tool0", tool0FilamentBindings},
+        {"tool1", tool1FilamentBindings},
+};
+constexpr JsonBinding<JobRequest> jobDetailBindings[] = {
+        {"estimatedPrintTime", &bindValue<JobRequest, long, &JobRequest::estimatedPrintTime>},
+        {"file", jobFileBindings},
+        {"filament", filamentBindings},
+};
+constexpr JsonBinding<JobRequest> progressBindings[] = {
+        // completion is null while no job is loaded
+        {"completion", &bindValue<JobRequest, float, &JobRequest::progressCompletion>},
+        {"filepos", &bindValue<JobRequest, long, &JobRequest::progressFilepos>},
+        {"printTime", &bindValue<JobRequest, long, &JobRequest::progressPrintTime>},
+        {"printTimeLeft", &bindValue<JobRequest, long, &JobRequest::progressPrintTimeLeft>},
+};
+constexpr JsonBinding<JobRequest> jobBindings[] = {
+        {"job", jobDetailBindings},
+        {"progress", progressBindings},
+};
+// /api/job reports the state text as a plain string next to job and progress
+constexpr JsonBinding<JobRequest> jobResponseBindings[] = {
+        {"state", &bindText<JobRequest, &JobRequest::printerState>},
+        {"job", jobDetailBindings},
+        {"progress", progressBindings},
+};
+
+bool isFetchOperation(Operation operation) {
+    return operation == Operation::FetchOctoprintVersion || operation == Operation::FetchPrinterStatistics ||
+           operation == Operation::FetchPrintJob || operation == Operation::FetchPrinterBed ||
+           operation == Operation::FetchPrinterSdStatus || operation == Operation::Login;
+}
+
+/**
+ * @return true for fetches whose response is applied to the state only, so that the state can stand in for it
+ */
+bool isCacheableOperation(Operation operation) {
+    return isFetchOperation(operation) && operation != Operation::Login;
+}
+
+// fits the largest filter, /api/printer with the state flags, the heaters and the latest history entry
+constexpr size_t fetchFilterCapacity = 1024;
+
+/**
+ * Builds the deserialization filter of a fetch so that only fields ending up in OverallState are materialized.
+ * @param printerFields the sections of a FetchPrinterStatistics to materialize
+ */
+void selectFetchedFields(Operation operation, PrinterFields printerFields, JsonDocument &filter) {
+    const JsonObject fields = filter.to<JsonObject>();
+    switch (operation) {
+        case Operation::FetchOctoprintVersion:
+            filter["api"] = true;
+            filter["server"] = true;
+            break;
+        case Operation::FetchPrinterStatistics:
+            if (hasFields(printerFields, PrinterFields::State)) {
+                selectBindings(fields, printerStateBindings);
+            }
+            if (hasFields(printerFields, PrinterFields::Temperature)) {
+                // heaters are discovered from the keys, "history" is matched by its own entry before the wildcard
+                filter["temperature"]["*"]["actual"] = true;
+                filter["temperature"]["*"]["target"] = true;
+                for (const char *heater : {"bed", "tool0", "tool1"}) {
+                    filter["temperature"]["history"][0][heater] = true;
+                }
+                filter["temperature"]["history"][0]["time"] = true;
+            }
+            break;
+        case Operation::FetchPrintJob:
+            selectBindings(fields, jobResponseBindings);
+            break;
+        case Operation::FetchPrinterBed:
+            selectBindings(fields, bedBindings);
+            filter["history"][0]["time"] = true;
+            filter["history"][0]["bed"]["actual"] = true;
+            break;
+        case Operation::FetchPrinterSdStatus:
+            filter["ready"] = true;
+            break;
+        case Operation::Login:
+            // the user record around them can be larger than the Json buffer
+            filter["name"] = true;
+            filter["session"] = true;
+            break;
+        case Operation::FetchTemperatureHistory:
+            // applied to each entry of the history array
+            filter["time"] = true;
+            filter["bed"] = true;
+            filter["tool0"] = true;
+            filter["tool1"] = true;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Reads every heater of a temperature object in a single pass over its members. A heater seen for the first time takes
+ * the next free slot, heaters beyond the capacity are ignored. A known heater missing from the object reads as 0 like
+ * its missing members do, unless the object lists only some of the heaters.
+ * @param heaters e.g. {"bed": {"actual": .., "target": ..}, "chamber": {..}, "tool0": {..}}, other members are skipped
+ * @param isEveryHeaterListed false for the response of a single heater, e.g. /api/printer/bed
+ * @return true if any temperature changed
+ */
+bool applyHeaters(JsonObjectConst heaters, PrinterState::Thermal &temperature, bool isEveryHeaterListed) {
+    static_assert(PrinterState::maxHeaters <= 8, "seen heaters are tracked in 8 bits");
+    bool isChanged = false;
+    uint8_t seenMask = 0;
+    for (JsonPairConst member : heaters) {
+        const JsonObjectConst values = member.value().as<JsonObjectConst>();
+        const char *name = member.key().c_str();
+        if (values.isNull() || strlen(name) >= sizeof(PrinterState::Heater::name)) continue;
+
+        uint8_t idx = 0;
+        while (idx < temperature.heatersCount && strcmp(temperature.heaters[idx].name, name) != 0) idx++;
+        if (idx == PrinterState::maxHeaters) continue;
+        PrinterState::Heater &heater = temperature.heaters[idx];
+        if (idx == temperature.heatersCount) {
+            strcpy(heater.name, name);
+            heater.currentCelsius = heater.targetCelsius = 0;
+            temperature.heatersCount++;
+            isChanged = true;
+        }
+        seenMask |= 1u << idx;
+        update(heater.currentCelsius, values["actual"].as<float>(), isChanged);
+        update(heater.targetCelsius, values["target"].as<float>(), isChanged);
+    }
+    for (uint8_t idx = 0; idx < temperature.heatersCount; idx++) {
+        if (!isEveryHeaterListed || (seenMask & (1u << idx)) != 0) continue;
+        update(temperature.heaters[idx].currentCelsius, 0.0f, isChanged);
+        update(temperature.heaters[idx].targetCelsius, 0.0f, isChanged);
+    }
+
+    // the fixed fields of sketches written before heaters were discovered
+    const PrinterState::Heater *bed = temperature.findHeater("bed");
+    const PrinterState::Heater *tool0 = temperature.findHeater("tool0");
+    const PrinterState::Heater *tool1 = temperature.findHeater("tool1");
+    update(temperature.bedCurrentCelsius, bed != nullptr ? bed->currentCelsius : 0.0f, isChanged);
+    update(temperature.bedTargetCelsius, bed != nullptr ? bed->targetCelsius : 0.0f, isChanged);
+    update(temperature.tool0CurrentCelsius, tool0 != nullptr ? tool0->currentCelsius : 0.0f, isChanged);
+    update(temperature.tool0TargetCelsius, tool0 != nullptr ? tool0->targetCelsius : 0.0f, isChanged);
+    update(temperature.tool1CurrentCelsius, tool1 != nullptr ? tool1->currentCelsius : 0.0f, isChanged);
+    update(temperature.tool1TargetCelsius, tool1 != nullptr ? tool1->targetCelsius : 0.0f, isChanged);
+    return isChanged;
+}
+
+/**
+ * @return true for "tool" followed by a tool number
+ */
+bool isToolName(const char *heater) {
+    if (strncmp(heater, "tool", 4) != 0 || heater[4] == '\0') return false;
+    for (const char *digit = heater + 4; *digit != '\0'; digit++) {
+        if (*digit < '0' || *digit > '9') return false;
+    }
+    return true;
+}
+
+/**
+ * @param entry one element of OctoPrint's temperature history, {"time": .., "bed": {"actual": .., "target": ..}, ..}
+ * @return false if the entry has no timestamp
+ */
+bool readTemperatureSample(JsonVariantConst entry, TemperatureSample &sample) {
+    if (!entry.containsKey("time")) return false;
+    sample.timestamp = entry["time"].as<uint32_t>();
+    sample.values[TemperatureSample::BedActual] = entry["bed"]["actual"].as<float>();
+    sample.values[TemperatureSample::BedTarget] = entry["bed"]["target"].as<float>();
+    sample.values[TemperatureSample::Tool0Actual] = entry["tool0"]["actual"].as<float>();
+    sample.values[TemperatureSample::Tool0Target] = entry["tool0"]["target"].as<float>();
+    sample.values[TemperatureSample::Tool1Actual] = entry["tool1"]["actual"].as<float>();
+    sample.values[TemperatureSample::Tool1Target] = entry["tool1"]["target"].as<float>();
+    return true;
+}
+
+/**
+ * Appends a storage path to an url, percent-encoding all but unreserved characters and the separating slashes.
+ */
+void appendEncodedPath(String &url, const String &path) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+    for (size_t idx = 0; idx < path.length(); idx++) {
+        const char c = path[idx];
+        if (isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.' || c == '~' || c == '/') {
+            url += c;
+        } else {
+            url += '%';
+            url += hexDigits[static_cast<uint8_t>(c) >> 4];
+            url += hexDigits[static_cast<uint8_t>(c) & 0x0f];
+        }
+    }
+}
+
+/**
+ * Skips whitespace, then consumes the next character.
+ * @return the character or -1 at the end of the body
+ */
+int readToken(Stream &stream) {
+    int c;
+    do {
+        c = stream.read();
+    } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+    return c;
+}
+
+} // namespace
+
 OctoprintClient::OctoprintClient(const String &apiKey, Client &client, const IPAddress &hostIp, uint16_t hostPort) :
         client(client),
         apiKey{apiKey},
@@ -25,133 +402,650 @@ OverallState OctoprintClient::getCachedState() const {
     return OverallState{state};
 }
 
-String OctoprintClient::sendRequestToOctoprint(const String &type, const String &command, const String &data) const {
-    if (isDebugEnabled) Serial.println("OctoprintClient::sendRequestToOctoprint");
+const OverallState &OctoprintClient::getState() const {
+    return state;
+}
+
+void OctoprintClient::setConnectionReuse(bool isEnabled, unsigned long idleTimeoutMs,
+                                         uint16_t maxRequestsPerConnection) {
+    connectionSettings.isReuseEnabled = isEnabled;
+    connectionSettings.idleTimeoutMs = idleTimeoutMs;
+    connectionSettings.maxRequestsPerConnection = maxRequestsPerConnection;
+    if (!isEnabled) closeClient();
+}
 
-    if ((type != "GET") && (type != "POST")) {
-        if (isDebugEnabled)
-            Serial.println(
-                    "OctoprintApi::sendRequestToOctoprint: unrecognized request, " + type + " must GET or POST)");
-        return String();
+const ConnectionSettings &OctoprintClient::getConnectionSettings() const {
+    return connectionSettings;
+}
+
+void OctoprintClient::setMetrics(RequestMetrics *metrics) {
+    this->metrics = metrics;
+}
+
+void OctoprintClient::setStateSnapshots(StateSnapshots *snapshots) {
+    this->snapshots = snapshots;
+    isSnapshotPending = false;
+    publishState();
+}
+
+void OctoprintClient::publishState() {
+    if (snapshots == nullptr) return;
+    isSnapshotPending = !snapshots->publish(state);
+}
+
+void OctoprintClient::setHostResolver(HostResolver *resolver, const HostCacheSettings &settings) {
+    hostCache = internal::HostCache{};
+    hostCache.resolver = resolver;
+    hostCache.settings = settings;
+}
+
+void OctoprintClient::onStateFlagsChanged(StateFlagsCallback callback) {
+    notifier.setStateFlagsCallback(std::move(callback));
+}
+
+void OctoprintClient::onTemperatureChanged(float deadbandCelsius, TemperatureCallback callback) {
+    notifier.setTemperatureCallback(deadbandCelsius, std::move(callback));
+}
+
+void OctoprintClient::onJobStarted(JobCallback callback) {
+    notifier.setJobStartedCallback(std::move(callback));
+}
+
+void OctoprintClient::onJobFinished(JobCallback callback) {
+    notifier.setJobFinishedCallback(std::move(callback));
+}
+
+void OctoprintClient::onProgress(float stepPercent, JobCallback callback) {
+    notifier.setProgressCallback(stepPercent, std::move(callback));
+}
+
+void OctoprintClient::setTemperatureHistory(TemperatureSampleSink *history) {
+    temperatureHistory = history;
+}
+
+void OctoprintClient::setPrinterFields(PrinterFields fields) {
+    // no section at all would fetch nothing
+    if (!hasFields(fields, PrinterFields::State) && !hasFields(fields, PrinterFields::Temperature)) {
+        fields = PrinterFields::All;
     }
+    if (fields == printerFields) return;
+    printerFields = fields;
+    // the state holds sections the cached response did not cover
+    internal::ResponseCacheEntry &cached = responseCache[static_cast<uint8_t>(Operation::FetchPrinterStatistics)];
+    cached.isSuccess = false;
+}
+
+PrinterFields OctoprintClient::getPrinterFields() const {
+    return printerFields;
+}
+
+bool OctoprintClient::fetchTemperatureHistory(uint16_t limit) {
+    /**
+    * Retrieves the current state of the printer including the last limit temperature samples, oldest first.
+    * The history array is deserialized entry by entry, its length is not bounded by the Json buffer.
+    * http://docs.octoprint.org/en/master/api/printer.html#retrieve-the-current-printer-state
+    **/
+    if (temperatureHistory == nullptr) return false;
+    String command = "/api/printer?history=true&exclude=state,sd&limit=";
+    command += limit;
+    awaitCompletion();
+    if (!startCustomRequest(Operation::FetchTemperatureHistory, command, "", responseSink, nullptr, true)) return false;
+    awaitCompletion();
+    return requestStatus.isSuccess;
+}
 
-    String statusCode = "";
-    String headers = "";
-    String body = "";
-    bool finishedStatusCode = false;
-    bool finishedHeaders = false;
-    bool currentLineIsBlank = true;
-    uint16_t ch_count = 0;
-    int headerCount = 0;
-    int headerLineStart = 0;
-    int bodySize = -1;
-    unsigned long now;
+bool OctoprintClient::fetchFiles(FileIndex &index) {
+    /**
+    * Retrieves the files and folders of a folder of the local storage, recursively if the index is.
+    * Status Codes: 200 OK – No error, 304 Not Modified – the listing did not change since the index was filled
+    * http://docs.octoprint.org/en/master/api/files.html#retrieve-files-from-specific-location
+    * http://docs.octoprint.org/en/master/api/files.html#retrieve-a-specific-file-s-or-folder-s-information
+    **/
+    String command = "/api/files/local";
+    if (!index.getFolder().isEmpty()) {
+        command += '/';
+        appendEncodedPath(command, index.getFolder());
+    }
+    if (index.isRecursive()) command += "?recursive=true";
+    awaitCompletion();
+    if (!startCustomRequest(Operation::FetchFiles, command, "", responseSink, nullptr, true)) return false;
+    pending.fileIndex = &index;
+    pending.headers = index.getConditionalHeaders();
+    awaitCompletion();
+    pending.fileIndex = nullptr;
+    return requestStatus.isSuccess;
+}
 
-    bool isConnected{false};
+bool OctoprintClient::fetchPushSession(String &user, String &session) {
+    /**
+    * Passive login with the api key, the session authenticates the push api's socket.
+    * http://docs.octoprint.org/en/master/api/general.html#login
+    **/
+    if (!perform(Operation::Login)) return false;
+    user = requestBuffer["name"] | "";
+    session = requestBuffer["session"] | "";
+    return true;
+}
 
+bool OctoprintClient::connectToHost(Client &connection) const {
+    IPAddress pinnedIp;
     if (hostUrl.isEmpty()) {
-        isConnected = client.connect(hostIp, hostPort);
+        return connection.connect(hostIp, hostPort);
+    } else if (hostCache.getPinned(pinnedIp)) {
+        return connection.connect(pinnedIp, hostPort);
     } else {
-        isConnected = client.connect(hostUrl.c_str(), hostPort);
+        return connection.connect(hostUrl.c_str(), hostPort);
     }
+}
 
-    if (isConnected) {
-        if (isDebugEnabled) Serial.println(".... connected to server");
+String OctoprintClient::getHostName() const {
+    return hostUrl.isEmpty() ? hostIp.toString() : hostUrl;
+}
 
-        char useragent[64];
-        snprintf(useragent, 64, "User-Agent: %s", USER_AGENT);
+void OctoprintClient::applyPushedState(const JsonVariant &message) {
+    const StateGenerations previousGenerations = state.generations;
 
-        client.println(type + " " + command + " HTTP/1.1");
-        client.print("Host: ");
-        if (hostUrl.isEmpty()) {
-            client.println(hostIp);
-        } else {
-            client.println(hostUrl);
-        }
-        client.print("X-Api-Key: ");
-        client.println(apiKey);
-        client.println(useragent);
-        client.println("Connection: keep-alive");
-        if (!data.isEmpty()) {
-            client.println("Content-Type: application/json");
-            client.print("Content-Length: ");
-            client.println(data.length());                   // number of bytes in the payload
-            client.println();                               // important need an empty line here
-            client.println(data);                           // the payload
-        } else {
-            client.println();
+    bool isJobChanged = false;
+    if (message.containsKey("state")) {
+        if (fetchPrinterStateFromJson(message)) state.generations.printerState++;
+        // /api/job reports the state text as the job's state
+        update(state.printJob.printerState, message["state"]["text"] | "", isJobChanged);
+    }
+    if (fetchPrintJobFromJson(message)) isJobChanged = true;
+    if (isJobChanged) state.generations.job++;
+
+    // samples since the previous message, oldest first
+    const JsonArray temps = message["temps"].as<JsonArray>();
+    if (temps.size() > 0) {
+        if (fetchPrinterThermalDataFromJson(temps[temps.size() - 1])) state.generations.thermal++;
+        for (size_t idx = 0; temperatureHistory != nullptr && idx < temps.size(); idx++) {
+            TemperatureSample sample;
+            if (readTemperatureSample(temps[idx], sample)) temperatureHistory->add(sample);
         }
+    }
+    publishState();
+    notifier.notify(state, previousGenerations);
+}
 
-        now = millis();
-        while (millis() - now < OPAPI_TIMEOUT) {
-            while (client.available()) {
-                char c = client.read();
+bool OctoprintClient::request(Operation operation, RequestCallback callback) {
+    if (operation == Operation::Get || operation == Operation::Post ||
+        operation == Operation::FetchTemperatureHistory || operation == Operation::FetchFiles ||
+        operation == Operation::Login || operation == Operation::Upload) {
+        return false;
+    }
+    if (isJoinable(operation) && pending.joinedCount < internal::PendingRequest::maxJoinedCallbacks) {
+        // the response in flight answers this request too
+        pending.joinedCallbacks[pending.joinedCount++] = std::move(callback);
+        return true;
+    }
+    const CommandDescriptor &command = describeOperation(operation);
+    return startRequest(operation, endpointOf(operation), command.body, responseSink, std::move(callback), false);
+}
 
-                if (isDebugEnabled) Serial.print(c);
+bool OctoprintClient::requestPost(const String &command, const String &postData, RequestCallback callback) {
+    return startCustomRequest(Operation::Post, command, postData, responseSink, std::move(callback), false);
+}
 
-                if (!finishedStatusCode) {
-                    if (c == '\n') {
-                        finishedStatusCode = true;
-                    } else {
-                        statusCode = statusCode + c;
-                    }
-                }
+bool OctoprintClient::isBusy() const {
+    return pending.phase != internal::PendingRequest::Phase::Idle;
+}
 
-                if (!finishedHeaders) {
-                    if (c == '\n') {
-                        if (currentLineIsBlank) {
-                            finishedHeaders = true;
-                        } else {
-                            if (headers.substring(headerLineStart).startsWith("Content-Length: ")) {
-                                bodySize = (headers.substring(headerLineStart + 16)).toInt();
-                            }
-                            headers = headers + c;
-                            headerCount++;
-                            headerLineStart = headerCount;
-                        }
-                    } else {
-                        headers = headers + c;
-                        headerCount++;
-                    }
-                } else {
-                    if (ch_count < maxMessageLengthBytes) {
-                        body = body + c;
-                        ch_count++;
-                        if (ch_count == bodySize) {
-                            break;
-                        }
-                    }
-                }
-                if (c == '\n') {
-                    currentLineIsBlank = true;
-                } else if (c != '\r') {
-                    currentLineIsBlank = false;
-                }
-            }
-            if (ch_count == bodySize) {
-                break;
-            }
+const RequestStatus &OctoprintClient::getRequestStatus() const {
+    return requestStatus;
+}
+
+bool OctoprintClient::startRequest(Operation operation, const char *command, const char *data, BodySink &sink,
+                                   RequestCallback callback, bool isBlocking) {
+    if (isBusy()) return false;
+    if (isDebugEnabled) Serial.println("OctoprintClient::startRequest");
+
+    pending.phase = internal::PendingRequest::Phase::Connecting;
+    pending.operation = operation;
+    pending.command = command;
+    pending.data = data;
+    pending.sink = &sink;
+    pending.callback = std::move(callback);
+    pending.joinedCount = 0;
+    pending.isBlocking = isBlocking;
+    pending.isReused = false;
+    pending.isStreamed = false;
+    pending.attempt = 0;
+    pending.jsonError = DeserializationError::EmptyInput;
+    pending.startUs = micros();
+    pending.connectUs = 0;
+    pending.isConnectAttempted = false;
+    pending.hasConnected = false;
+    pending.upload.source = nullptr;
+    pending.fileIndex = nullptr;
+    pending.headers = "";
+    pending.printerFields = printerFields;
+    // a request failing to connect must not report the previous response
+    reader.reset();
+    responseSink.clear();
+    return true;
+}
+
+bool OctoprintClient::startCustomRequest(Operation operation, const String &command, const String &data,
+                                         BodySink &sink, RequestCallback callback, bool isBlocking) {
+    if (isBusy()) return false;
+    // kept in the pending request, startRequest() only takes pointers
+    pending.customCommand = command;
+    pending.customData = data;
+    return startRequest(operation, pending.customCommand.c_str(), pending.customData.c_str(), sink,
+                        std::move(callback), isBlocking);
+}
+
+bool OctoprintClient::perform(Operation operation) {
+    if (isFresh(operation)) return true;
+    const CommandDescriptor &command = describeOperation(operation);
+    // a fetch of the same endpoint in flight answers this one too
+    const bool isJoined = isJoinable(operation);
+    // a blocking call queues up behind a pending asynchronous request
+    awaitCompletion();
+    if (isJoined) return responseCache[static_cast<uint8_t>(operation)].isSuccess;
+    if (!startRequest(operation, endpointOf(operation), command.body, responseSink, nullptr, true)) return false;
+    awaitCompletion();
+    return requestStatus.isSuccess;
+}
+
+const char *OctoprintClient::endpointOf(Operation operation) const {
+    if (operation == Operation::FetchPrinterStatistics) {
+        return printerStatisticsEndpoints[static_cast<uint8_t>(printerFields)][(temperatureHistory != nullptr) ? 1 : 0];
+    }
+    return describeOperation(operation).endpoint;
+}
+
+bool OctoprintClient::isJoinable(Operation operation) const {
+    // the settings may have changed the endpoint since the request was started
+    return isBusy() && pending.operation == operation && isCacheableOperation(operation) &&
+           strcmp(pending.command, endpointOf(operation)) == 0;
+}
+
+bool OctoprintClient::performPost(const String &command, const String &postData) {
+    awaitCompletion();
+    if (!startCustomRequest(Operation::Post, command, postData, responseSink, nullptr, true)) return false;
+    awaitCompletion();
+    return requestStatus.isSuccess;
+}
+
+void OctoprintClient::awaitCompletion() {
+    while (poll()) {
+        yield();
+    }
+}
+
+bool OctoprintClient::poll() {
+    switch (pending.phase) {
+        case internal::PendingRequest::Phase::Idle:
+            // between requests, so that none waits for the lookup
+            if (hostCache.resolver != nullptr && !hostUrl.isEmpty()) hostCache.refresh(hostUrl.c_str());
+            if (isSnapshotPending) publishState();
+            break;
+        case internal::PendingRequest::Phase::Connecting:
+            connectPending();
+            break;
+        case internal::PendingRequest::Phase::Receiving:
+            receivePending();
+            break;
+    }
+    return isBusy();
+}
+
+void OctoprintClient::connectPending() {
+    const unsigned long connectStartUs = micros();
+    const bool isConnected = connectClient(pending.isReused);
+    if (!pending.isReused) {
+        pending.isConnectAttempted = true;
+        if (isConnected) {
+            // a retry after a stale reused connection accumulates
+            pending.connectUs += micros() - connectStartUs;
+            pending.hasConnected = true;
+        }
+    }
+    if (!isConnected) {
+        if (isDebugEnabled) Serial.println(" OctoprintClient::connectPending: connection failed");
+        completePending(RequestOutcome::ConnectionFailed);
+        return;
+    }
+    if (isDebugEnabled) Serial.println(pending.isReused ? ".... reusing connection" : ".... connected to server");
+
+    if (pending.upload.source != nullptr) {
+        const RequestOutcome outcome = writeUpload();
+        if (outcome != RequestOutcome::InProgress) {
+            // the request is incomplete, endRequest() drops the connection
+            completePending(outcome);
+            return;
         }
     } else {
-        Serial.println(" OctoprintClient::sendRequestToOctoprint: connection failed");
+        writeRequest(describeOperation(pending.operation).method, pending.command, pending.data);
     }
+    // the response timeout starts once the request is sent, an upload may take minutes
+    reader.reset();
+    reader.setBlocking(pending.isBlocking);
+    pending.phase = internal::PendingRequest::Phase::Receiving;
+}
 
-    closeClient();
+void OctoprintClient::receivePending() {
+    const internal::HttpResponseParser &response = reader.getParser();
+    RequestOutcome outcome = RequestOutcome::InProgress;
+
+    if (!response.isHeaderComplete()) {
+        outcome = reader.readHeaders();
+        if (outcome == RequestOutcome::ConnectionClosed && pending.isReused && reader.getBytesReceived() == 0 &&
+            pending.attempt == 0) {
+            // the server silently dropped the reused connection: retry once on a fresh one
+            if (isDebugEnabled) Serial.println(".... reused connection was closed by server, reconnecting");
+            closeClient();
+            pending.attempt++;
+            pending.phase = internal::PendingRequest::Phase::Connecting;
+            return;
+        }
+        if (outcome != RequestOutcome::InProgress || !response.isHeaderComplete()) {
+            if (outcome != RequestOutcome::InProgress) completePending(outcome);
+            return;
+        }
 
-    int httpCode = extractHttpCode(statusCode, body);
-    if (isDebugEnabled) {
-        Serial.print("\nhttpCode:");
-        Serial.println(httpCode);
+        const bool isSuccessCode = response.getStatusCode() >= 200 && response.getStatusCode() < 300;
+        if (pending.isBlocking && isSuccessCode && isFetchOperation(pending.operation)) {
+            // blocking fetches deserialize straight from the connection, without buffering the body
+            StaticJsonDocument<fetchFilterCapacity> filter;
+            selectFetchedFields(pending.operation, pending.printerFields, filter);
+            pending.jsonError = deserializeJson(requestBuffer, reader, DeserializationOption::Filter(filter));
+            pending.isStreamed = true;
+            // drain what the deserializer did not consume to keep the connection usable
+            NullBodySink remainder;
+            completePending(reader.readBody(remainder));
+            return;
+        }
+        if (pending.isBlocking && isSuccessCode && pending.operation == Operation::FetchTemperatureHistory) {
+            pending.jsonError = readTemperatureHistory();
+            pending.isStreamed = true;
+            NullBodySink remainder;
+            completePending(reader.readBody(remainder));
+            return;
+        }
+        if (pending.isBlocking && response.getStatusCode() == 200 && pending.operation == Operation::FetchFiles) {
+            pending.fileIndex->beginListing();
+            pending.jsonError = internal::readFileListing(reader, *pending.fileIndex);
+            pending.isStreamed = true;
+            NullBodySink remainder;
+            outcome = reader.readBody(remainder);
+            pending.fileIndex->endListing(outcome == RequestOutcome::Complete && !pending.jsonError,
+                                          response.getEtag(), response.getLastModified());
+            completePending(outcome);
+            return;
+        }
     }
-    state.httpStatusCode = httpCode;
 
-    return body;
+    outcome = reader.readBody(*pending.sink);
+    if (outcome != RequestOutcome::InProgress) completePending(outcome);
+}
+
+void OctoprintClient::completePending(RequestOutcome outcome) {
+    const StateGenerations previousGenerations = state.generations;
+    // the body went to a foreign sink and is not available for error reporting
+    endRequest(outcome, (pending.sink == &responseSink) ? responseBody : nullptr);
+
+    const bool isResponseComplete = outcome == RequestOutcome::Complete;
+    bool isSuccess = false;
+    switch (pending.operation) {
+        case Operation::Get:
+            isSuccess = isResponseComplete && state.httpStatusCode >= 200 && state.httpStatusCode < 300;
+            break;
+        case Operation::FetchOctoprintVersion:
+        case Operation::FetchPrinterStatistics:
+        case Operation::FetchPrintJob:
+        case Operation::FetchPrinterBed:
+        case Operation::FetchPrinterSdStatus:
+        case Operation::Login:
+            isSuccess = applyFetchedJson(pending.operation);
+            break;
+        case Operation::FetchTemperatureHistory:
+            isSuccess = isResponseComplete && state.httpStatusCode == 200 && !pending.jsonError;
+            break;
+        case Operation::FetchFiles:
+            // 304 Not Modified leaves the index as it is
+            isSuccess = isResponseComplete &&
+                        ((state.httpStatusCode == 200 && !pending.jsonError) || state.httpStatusCode == 304);
+            break;
+        default:
+            isSuccess = state.httpStatusCode == describeOperation(pending.operation).expectedStatus;
+            break;
+    }
+
+    // nothing came back from a new connection, the host may have moved to another address, e.g. a new DHCP lease
+    const bool isUnanswered = outcome != RequestOutcome::Complete && outcome != RequestOutcome::Truncated &&
+                              outcome != RequestOutcome::SourceFailed && reader.getBytesReceived() == 0;
+    if (isUnanswered && pending.isConnectAttempted) hostCache.invalidate();
+
+    requestStatus.operation = pending.operation;
+    requestStatus.outcome = outcome;
+    requestStatus.httpStatusCode = state.httpStatusCode;
+    requestStatus.isSuccess = isSuccess;
+    if (metrics != nullptr) recordMetrics(outcome);
+    updateResponseCache(pending.operation, isSuccess);
+
+    pending.phase = internal::PendingRequest::Phase::Idle;
+    pending.sink = nullptr;
+    // moved out first: the callbacks may already start the next request
+    RequestCallback callback = std::move(pending.callback);
+    pending.callback = nullptr;
+    RequestCallback joinedCallbacks[internal::PendingRequest::maxJoinedCallbacks];
+    const uint8_t joinedCount = pending.joinedCount;
+    for (uint8_t idx = 0; idx < joinedCount; idx++) joinedCallbacks[idx] = std::move(pending.joinedCallbacks[idx]);
+    pending.joinedCount = 0;
+    const RequestStatus status = requestStatus;
+    publishState();
+    notifier.notify(state, previousGenerations);
+    if (callback) callback(status);
+    for (uint8_t idx = 0; idx < joinedCount; idx++) {
+        if (joinedCallbacks[idx]) joinedCallbacks[idx](status);
+    }
+}
+
+bool OctoprintClient::setResponseTtl(Operation operation, unsigned long ttlMs) {
+    if (!isCacheableOperation(operation)) return false;
+    responseCache[static_cast<uint8_t>(operation)].ttlMs = ttlMs;
+    return true;
+}
+
+bool OctoprintClient::isFresh(Operation operation) const {
+    const internal::ResponseCacheEntry &cached = responseCache[static_cast<uint8_t>(operation)];
+    return cached.ttlMs > 0 && cached.isSuccess && millis() - cached.completedMs < cached.ttlMs;
+}
+
+void OctoprintClient::updateResponseCache(Operation operation, bool isSuccess) {
+    internal::ResponseCacheEntry &cached = responseCache[static_cast<uint8_t>(operation)];
+    cached.completedMs = millis();
+    cached.isSuccess = isSuccess;
+    // a command or custom request may change what the cached fetches returned
+    const bool isChanging = strcmp(describeOperation(operation).method, "POST") == 0 && operation != Operation::Login;
+    if (isChanging) {
+        for (internal::ResponseCacheEntry &entry : responseCache) entry.completedMs = cached.completedMs - entry.ttlMs;
+    }
+}
+
+void OctoprintClient::recordMetrics(RequestOutcome outcome) {
+    RequestSample sample;
+    sample.outcome = outcome;
+    sample.httpStatusCode = state.httpStatusCode;
+    sample.isConnected = pending.hasConnected;
+    sample.connectUs = pending.connectUs;
+    sample.hasFirstByte = reader.getBytesReceived() > 0;
+    sample.firstByteUs = sample.hasFirstByte ? reader.getFirstByteUs() - pending.startUs : 0;
+    sample.latencyUs = micros() - pending.startUs;
+    sample.bytesReceived = reader.getBytesReceived();
+    metrics->record(pending.operation, sample);
+}
+
+DeserializationError OctoprintClient::readTemperatureHistory() {
+    // {"temperature": {.., "history": [{"time": .., "bed": {..}, ..}, ..]}}
+    if (!reader.find("\"history\"")) return DeserializationError::IncompleteInput;
+    if (readToken(reader) != ':' || readToken(reader) != '[') return DeserializationError::InvalidInput;
+    if (reader.peek() == ']') return DeserializationError::Ok;
+
+    StaticJsonDocument<64> filter;
+    selectFetchedFields(Operation::FetchTemperatureHistory, PrinterFields::All, filter);
+    StaticJsonDocument<256> entry;
+    for (;;) {
+        const DeserializationError error = deserializeJson(entry, reader, DeserializationOption::Filter(filter));
+        if (error) return error;
+        TemperatureSample sample;
+        if (readTemperatureSample(entry.as<JsonVariantConst>(), sample)) temperatureHistory->add(sample);
+
+        const int c = readToken(reader);
+        if (c == ']') return DeserializationError::Ok;
+        if (c != ',') return (c < 0) ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+    }
+}
+
+bool OctoprintClient::applyFetchedJson(Operation operation) {
+    const bool isSuccessCode = state.httpStatusCode >= 200 && state.httpStatusCode < 300;
+    if (!pending.isStreamed && isSuccessCode) {
+        StaticJsonDocument<fetchFilterCapacity> filter;
+        selectFetchedFields(operation, pending.printerFields, filter);
+        pending.jsonError = deserializeJson(requestBuffer, static_cast<const char *>(responseBody),
+                                            responseSink.length(), DeserializationOption::Filter(filter));
+    }
+
+    switch (operation) {
+        case Operation::FetchOctoprintVersion:
+            return applyOctoprintVersion(pending.jsonError);
+        case Operation::FetchPrinterStatistics:
+            return applyPrinterStatistics(pending.jsonError);
+        case Operation::FetchPrintJob:
+            return applyPrintJob(pending.jsonError);
+        case Operation::FetchPrinterBed:
+            return applyPrinterBed(pending.jsonError);
+        case Operation::FetchPrinterSdStatus:
+            return applyPrinterSdStatus(pending.jsonError);
+        case Operation::Login:
+            return !pending.jsonError && requestBuffer.containsKey("session");
+        default:
+            return false;
+    }
+}
+
+void OctoprintClient::writeRequestHead(Print &out, const char *method, const char *command) {
+    out.print(method);
+    out.print(' ');
+    out.print(command);
+    out.print(" HTTP/1.1\r\nHost: ");
+    if (hostUrl.isEmpty()) {
+        out.print(hostIp);
+    } else {
+        out.print(hostUrl);
+    }
+    out.print("\r\nX-Api-Key: ");
+    out.print(apiKey);
+    out.print("\r\nUser-Agent: " USER_AGENT "\r\n");
+    out.print(connectionSettings.isReuseEnabled ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    out.print(pending.headers);
+}
+
+void OctoprintClient::writeRequest(const char *method, const char *command, const char *data) {
+    CoalescingPrint out(client);
+    writeRequestHead(out, method, command);
+    const size_t dataLength = strlen(data);
+    if (dataLength > 0) {
+        out.print("Content-Type: application/json\r\nContent-Length: ");
+        out.print(static_cast<unsigned long>(dataLength));
+        out.print("\r\n\r\n");
+        // exactly Content-Length bytes, anything after it would be read as the next request on a reused connection
+        out.write(reinterpret_cast<const uint8_t *>(data), dataLength);
+    } else {
+        out.print("\r\n");
+    }
+    out.send();
+}
+
+RequestOutcome OctoprintClient::writeUpload() {
+    const internal::UploadRequest &upload = pending.upload;
+    String head = "--";
+    head += uploadBoundary;
+    head += "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"";
+    head += upload.fileName;
+    head += "\"\r\nContent-Type: application/octet-stream\r\n\r\n";
+
+    String tail = "\r\n";
+    const struct {
+        const char *name;
+        bool isSet;
+    } fields[] = {{"select", upload.isSelected || upload.isPrinted}, {"print", upload.isPrinted}};
+    for (const auto &field : fields) {
+        if (!field.isSet) continue;
+        tail += "--";
+        tail += uploadBoundary;
+        tail += "\r\nContent-Disposition: form-data; name=\"";
+        tail += field.name;
+        tail += "\"\r\n\r\ntrue\r\n";
+    }
+    tail += "--";
+    tail += uploadBoundary;
+    tail += "--\r\n";
+
+    CoalescingPrint out(client);
+    writeRequestHead(out, describeOperation(pending.operation).method, pending.command);
+    out.print("Content-Type: multipart/form-data; boundary=");
+    out.print(uploadBoundary);
+    out.print("\r\nContent-Length: ");
+    out.print(static_cast<unsigned long>(head.length() + upload.size + tail.length()));
+    out.print("\r\n\r\n");
+    out.print(head);
+    out.send();
+
+    UploadProgress progress;
+    progress.totalBytes = upload.size;
+    const unsigned long startMs = millis();
+    // the response buffer stays unused until the response arrives
+    uint8_t *block = reinterpret_cast<uint8_t *>(responseBody);
+    while (progress.bytesSent < upload.size) {
+        size_t length = upload.size - progress.bytesSent;
+        if (length > maxMessageLengthBytes) length = maxMessageLengthBytes;
+        if (upload.source->readBytes(block, length) != length) return RequestOutcome::SourceFailed;
+        if (client.write(block, length) != length) return RequestOutcome::ConnectionClosed;
+        progress.bytesSent += length;
+
+        if (upload.progress) {
+            progress.elapsedMs = millis() - startMs;
+            progress.bytesPerSecond = (progress.elapsedMs > 0)
+                                      ? static_cast<uint32_t>(static_cast<uint64_t>(progress.bytesSent) * 1000 /
+                                                              progress.elapsedMs)
+                                      : 0;
+            upload.progress(progress);
+        }
+        yield();
+    }
+    // the response is read into the same buffer
+    responseSink.clear();
+
+    out.print(tail);
+    out.send();
+    return RequestOutcome::InProgress;
 }
 
+void OctoprintClient::endRequest(RequestOutcome outcome, const char *body) {
+    const internal::HttpResponseParser &response = reader.getParser();
+
+    connectionRequestCount++;
+    connectionLastActivityMs = millis();
+    // a truncated body was still consumed completely, the connection stays in sync
+    const bool isConsumed = outcome == RequestOutcome::Complete || outcome == RequestOutcome::Truncated;
+    if (!connectionSettings.isReuseEnabled || !isConsumed || response.isConnectionClosing() ||
+        connectionRequestCount >= connectionSettings.maxRequestsPerConnection) {
+        closeClient();
+    }
 
-String OctoprintClient::sendGetToOctoprint(String command) const {
-    if (isDebugEnabled) Serial.println("OctoprintClient::sendGetToOctoprint");
-    return sendRequestToOctoprint("GET", command, "");
+    if (body == nullptr) body = "";
+    const int httpCode = response.isHeaderComplete() ? response.getStatusCode() : -1;
+    reportHttpStatus(httpCode, outcome, body);
+    state.httpStatusCode = httpCode;
+    state.requestOutcome = outcome;
+    if (httpCode >= 300) {
+        state.httpErrorBody = body;
+    } else if (!state.httpErrorBody.isEmpty()) {
+        state.httpErrorBody = "";
+    }
 }
 
 
@@ -161,14 +1055,16 @@ bool OctoprintClient::fetchOctoprintVersion() {
     * Status Codes: 200 OK – No error
     * http://docs.octoprint.org/en/master/api/version.html#version-information
     **/
-    const String command = "/api/version";
-    const String response = sendGetToOctoprint(command);
+    return perform(Operation::FetchOctoprintVersion);
+}
 
-    DeserializationError e = deserializeJson(requestBuffer, response);
+bool OctoprintClient::applyOctoprintVersion(DeserializationError e) {
     if (!e) {
         if (requestBuffer.containsKey("api")) {
-            state.octoprintVersion.api = requestBuffer["api"].as<String>();
-            state.octoprintVersion.server = requestBuffer["server"].as<String>();
+            bool isChanged = false;
+            update(state.octoprintVersion.api, requestBuffer["api"] | "", isChanged);
+            update(state.octoprintVersion.server, requestBuffer["server"] | "", isChanged);
+            if (isChanged) state.generations.version++;
             return true;
         }
     }
@@ -181,21 +1077,31 @@ bool OctoprintClient::fetchPrinterStatistics() {
     * Returns: 200 OK with a Full State Response in the body upon success.
     * http://docs.octoprint.org/en/master/api/printer.html#retrieve-the-current-printer-state
     **/
-    String command = "/api/printer";
-    String response = sendGetToOctoprint(command);       //recieve reply from OctoPrint
+    return perform(Operation::FetchPrinterStatistics);
+}
 
-    DeserializationError e = deserializeJson(requestBuffer, response);
+bool OctoprintClient::applyPrinterStatistics(DeserializationError e) {
     if (!e) {
-        if (requestBuffer.containsKey("state")) {
-            fetchPrinterStateFromJson(requestBuffer.as<JsonVariant>());
+        if (requestBuffer.containsKey("state") && fetchPrinterStateFromJson(requestBuffer.as<JsonVariant>())) {
+            state.generations.printerState++;
         }
-        if (requestBuffer.containsKey("temperature")) {
-            fetchPrinterThermalDataFromJson(requestBuffer.as<JsonVariant>());
+        if (requestBuffer.containsKey("temperature") && fetchPrinterThermalDataFromJson(requestBuffer["temperature"])) {
+            state.generations.thermal++;
+        }
+        TemperatureSample sample;
+        if (temperatureHistory != nullptr &&
+            readTemperatureSample(requestBuffer["temperature"]["history"][0], sample)) {
+            temperatureHistory->add(sample);
         }
         return true;
     } else {
-        state.printerState.printerStateText = response;
-        if (response == "Printer is not operational") {
+        bool isChanged = false;
+        // a body deserialized from the connection was consumed, the last good text is kept then
+        if (!pending.isStreamed && hasFields(pending.printerFields, PrinterFields::State)) {
+            update(state.printerState.printerStateText, static_cast<const char *>(responseBody), isChanged);
+        }
+        if (isChanged) state.generations.printerState++;
+        if (strcmp(responseBody, "Printer is not operational") == 0) {
             return true;
         }
     }
@@ -215,61 +1121,62 @@ bool OctoprintClient::jobStart() {
     *
     * http://docs.octoprint.org/en/devel/api/job.html#issue-a-job-command
     **/
-
-    const String command = "/api/job";
-    const String postData("{\"command\": \"start\"}");
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::JobStart);
 }
 
 bool OctoprintClient::jobCancel() {
-    String command = "/api/job";
-    String postData = "{\"command\": \"cancel\"}";
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::JobCancel);
 }
 
 bool OctoprintClient::jobRestart() {
-    String command = "/api/job";
-    String postData = "{\"command\": \"restart\"}";
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::JobRestart);
 }
 
 bool OctoprintClient::jobPauseResume() {
-    String command = "/api/job";
-    String postData = "{\"command\": \"pause\"}";
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::JobPauseResume);
 }
 
 bool OctoprintClient::jobPause() {
-    const String command = "/api/job";
-    const String postData = "{\"command\": \"pause\", \"action\": \"pause\"}";
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::JobPause);
 }
 
 bool OctoprintClient::jobResume() {
-    const String command = "/api/job";
-    const String postData = "{\"command\": \"pause\", \"action\": \"resume\"}";
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::JobResume);
 }
 
 
+bool OctoprintClient::uploadFile(const String &fileName, Stream &source, size_t size, const UploadOptions &options) {
+    /**
+    * Upload file to local storage, Content-Type multipart/form-data with the parts file, select and print.
+    * Status Codes: 201 Created – No error
+    * http://docs.octoprint.org/en/master/api/files.html#upload-file-or-create-folder
+    **/
+    // the name goes into a quoted header parameter
+    if (fileName.isEmpty() || fileName.indexOf('"') >= 0 || fileName.indexOf('\r') >= 0 ||
+        fileName.indexOf('\n') >= 0) {
+        return false;
+    }
+    const CommandDescriptor &command = describeOperation(Operation::Upload);
+    awaitCompletion();
+    if (!startRequest(Operation::Upload, command.endpoint, command.body, responseSink, nullptr, true)) return false;
+    internal::UploadRequest &upload = pending.upload;
+    upload.source = &source;
+    upload.size = size;
+    upload.fileName = fileName;
+    upload.isSelected = options.isSelected;
+    upload.isPrinted = options.isPrinted;
+    upload.progress = options.progress;
+    awaitCompletion();
+    // the upload is done, do not keep the caller's callback and Stream alive
+    upload.source = nullptr;
+    upload.progress = nullptr;
+    return requestStatus.isSuccess;
+}
+
 bool OctoprintClient::fileSelect(String &path) {
     const String command = "/api/files/local" + path;
     const String postData = "{\"command\": \"select\", \"print\": false }";
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return performPost(command, postData);
 }
 
 //bool OctoprintApi::octoPrintJobPause(String actionCommand){}
@@ -280,64 +1187,39 @@ bool OctoprintClient::fileSelect(String &path) {
  * Returns a 200 OK with a Job information response in the body.
  * */
 bool OctoprintClient::fetchPrintJob() {
-    const String command = "/api/job";
-    const String response = sendGetToOctoprint(command);
+    return perform(Operation::FetchPrintJob);
+}
 
-    DeserializationError e = deserializeJson(requestBuffer, response);
+bool OctoprintClient::applyPrintJob(DeserializationError e) {
     if (!e) {
-        String printerState = requestBuffer["state"];
-        state.printJob.printerState = printerState;
-
-        if (requestBuffer.containsKey("job")) {
-            long estimatedPrintTime = requestBuffer["job"]["estimatedPrintTime"];
-            state.printJob.estimatedPrintTime = estimatedPrintTime;
-
-            long jobFileDate = requestBuffer["job"]["file"]["date"];
-            String jobFileName = requestBuffer["job"]["file"]["name"] | "";
-            String jobFileOrigin = requestBuffer["job"]["file"]["origin"] | "";
-            long jobFileSize = requestBuffer["job"]["file"]["size"];
-            state.printJob.jobFileDate = jobFileDate;
-            state.printJob.jobFileName = jobFileName;
-            state.printJob.jobFileOrigin = jobFileOrigin;
-            state.printJob.jobFileSize = jobFileSize;
-
-            long jobFilamentTool0Length = requestBuffer["job"]["filament"]["tool0"]["length"] | 0;
-            float jobFilamentTool0Volume = requestBuffer["job"]["filament"]["tool0"]["volume"] | 0.0;
-            state.printJob.jobFilamentTool0Length = jobFilamentTool0Length;
-            state.printJob.jobFilamentTool0Volume = jobFilamentTool0Volume;
-            long jobFilamentTool1Length = requestBuffer["job"]["filament"]["tool1"]["length"] | 0;
-            float jobFilamentTool1Volume = requestBuffer["job"]["filament"]["tool1"]["volume"] | 0.0;
-            state.printJob.jobFilamentTool1Length = jobFilamentTool1Length;
-            state.printJob.jobFilamentTool1Volume = jobFilamentTool1Volume;
-        }
-        if (requestBuffer.containsKey("progress")) {
-            float progressCompletion = requestBuffer["progress"]["completion"] |
-                                       0.0;//isnan(root["progress"]["completion"]) ? 0.0 : root["progress"]["completion"];
-            long progressFilepos = requestBuffer["progress"]["filepos"];
-            long progressPrintTime = requestBuffer["progress"]["printTime"];
-            long progressPrintTimeLeft = requestBuffer["progress"]["printTimeLeft"];
-
-            state.printJob.progressCompletion = progressCompletion;
-            state.printJob.progressFilepos = progressFilepos;
-            state.printJob.progressPrintTime = progressPrintTime;
-            state.printJob.progressPrintTimeLeft = progressPrintTimeLeft;
+        if (applyBindings(requestBuffer.as<JsonObject>(), jobResponseBindings, state.printJob, false)) {
+            state.generations.job++;
         }
         return true;
     }
     return false;
 }
 
-String OctoprintClient::sendCustomCommand(String command) const {
-    if (isDebugEnabled) Serial.println("OctoprintApi::getOctoprintEndpointResults() CALLED");
-    return sendGetToOctoprint("/api/" + command);
+bool OctoprintClient::fetchPrintJobFromJson(const JsonVariant &root) {
+    // a section missing from the message keeps its fields, missing members of a present section are reset
+    return applyBindings(root.as<JsonObject>(), jobBindings, state.printJob, false);
 }
 
+String OctoprintClient::sendCustomCommand(String command) {
+    if (isDebugEnabled) Serial.println("OctoprintApi::getOctoprintEndpointResults() CALLED");
+    sendCustomCommand(command, responseSink);
+    return String(responseBody);
+}
 
-String OctoprintClient::sendPostToOctoPrint(const String &command, const String &postData) const {
-    if (isDebugEnabled) Serial.println("OctoprintApi::sendPostToOctoPrint() CALLED");
-    return sendRequestToOctoprint("POST", command, postData.c_str());
+bool OctoprintClient::sendCustomCommand(const String &command, BodySink &sink) {
+    if (isDebugEnabled) Serial.println("OctoprintApi::sendCustomCommand(sink) CALLED");
+    awaitCompletion();
+    if (!startCustomRequest(Operation::Get, "/api/" + command, "", sink, nullptr, true)) return false;
+    awaitCompletion();
+    return requestStatus.isSuccess;
 }
 
+
 /***** CONNECTION HANDLING *****/
 /**
  * http://docs.octoprint.org/en/master/api/connection.html#issue-a-connection-command
@@ -347,27 +1229,15 @@ String OctoprintClient::sendPostToOctoPrint(const String &command, const String
  * 400 Bad Request – If the selected port or baudrate for a connect command are not part of the available options.
  * */
 bool OctoprintClient::sendAutoConnect() {
-    const String command = "/api/connection";
-    const String postData = "{\"command\": \"connect\"}";
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::ConnectionConnect);
 }
 
 bool OctoprintClient::sendDisconnect() {
-    const String command = "/api/connection";
-    const String postData = "{\"command\": \"disconnect\"}";
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::ConnectionDisconnect);
 }
 
 bool OctoprintClient::sendFakeAck() {
-    const String command = "/api/connection";
-    const String postData = "{\"command\": \"fake_ack\"}";
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::ConnectionFakeAck);
 }
 
 
@@ -380,15 +1250,7 @@ bool OctoprintClient::sendFakeAck() {
  * Upon success, a status code of 204 No Content and an empty body is returned.
  * */
 bool OctoprintClient::printHeadHome() {
-    const String command = "/api/printer/printhead";
-    //   {
-    //   "command": "home",
-    //   "axes": ["x", "y", "z"]
-    // }
-    String postData = "{\"command\": \"home\",\"axes\": [\"x\", \"y\"]}";
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::PrintHeadHome);
 }
 
 
@@ -425,11 +1287,9 @@ bool OctoprintClient::printHeadRelativeJog(double x, double y, double z, double
     }
     strcat(postData, ", \"absolute\": false");
     strcat(postData, " }");
-    Serial.println(postData);
+    if (isDebugEnabled) Serial.println(postData);
 
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return performPost(command, postData);
 }
 
 bool OctoprintClient::printExtrude(double amount) {
@@ -437,9 +1297,7 @@ bool OctoprintClient::printExtrude(double amount) {
     char postData[256];
     snprintf(postData, 256, "{ \"command\": \"extrude\", \"amount\": %f }", amount);
 
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return performPost(command, postData);
 }
 
 bool OctoprintClient::setTargetBedTemperature(uint16_t celsius) {
@@ -447,34 +1305,61 @@ bool OctoprintClient::setTargetBedTemperature(uint16_t celsius) {
     char postData[256];
     snprintf(postData, 256, "{ \"command\": \"target\", \"target\": %d }", celsius);
 
-    const String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return performPost(command, postData);
 }
 
 
-bool OctoprintClient::setTargetTool0Temperature(uint16_t celsius) {
-    const String command = "/api/printer/tool";
+bool OctoprintClient::setTargetChamberTemperature(uint16_t celsius) {
+    const String command = "/api/printer/chamber";
     char postData[256];
-    snprintf(postData, 256, "{ \"command\": \"target\", \"targets\": { \"tool0\": %d } }", celsius);
+    snprintf(postData, 256, "{ \"command\": \"target\", \"target\": %d }", celsius);
 
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return performPost(command, postData);
 }
 
-bool OctoprintClient::setTargetTool1Temperature(uint16_t celsius) {
-    const String command = "/api/printer/tool";
-    char postData[256];
-    snprintf(postData, 256, "{ \"command\": \"target\", \"targets\": { \"tool1\": %d } }", celsius);
+bool OctoprintClient::setTargetTool0Temperature(uint16_t celsius) {
+    const HeaterTarget target{"tool0", celsius};
+    return setTargets(&target, 1);
+}
 
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+bool OctoprintClient::setTargetTool1Temperature(uint16_t celsius) {
+    const HeaterTarget target{"tool1", celsius};
+    return setTargets(&target, 1);
 }
 
+bool OctoprintClient::setTargets(const HeaterTarget *targets, uint8_t count) {
+    for (uint8_t idx = 0; idx < count; idx++) {
+        const char *heater = targets[idx].heater;
+        if (strcmp(heater, "bed") != 0 && strcmp(heater, "chamber") != 0 && !isToolName(heater)) return false;
+    }
 
+    // the tool body is complete before anything is sent, a request that does not fit sends none
+    char postData[256];
+    size_t length = snprintf(postData, sizeof(postData), "{ \"command\": \"target\", \"targets\": {");
+    uint8_t toolsCount = 0;
+    for (uint8_t idx = 0; idx < count && length < sizeof(postData); idx++) {
+        const HeaterTarget &target = targets[idx];
+        if (!isToolName(target.heater)) continue;
+        length += snprintf(postData + length, sizeof(postData) - length, "%s \"%s\": %u",
+                           toolsCount > 0 ? "," : "", target.heater, static_cast<unsigned>(target.celsius));
+        toolsCount++;
+    }
+    if (length < sizeof(postData)) length += snprintf(postData + length, sizeof(postData) - length, " } }");
+    if (length >= sizeof(postData)) return false;
 
+    const String command = "/api/printer/tool";
+    bool isSet = toolsCount == 0 || performPost(command, postData);
+    // OctoPrint takes the bed and the chamber on endpoints of their own
+    for (uint8_t idx = 0; idx < count; idx++) {
+        const HeaterTarget &target = targets[idx];
+        if (strcmp(target.heater, "bed") == 0) {
+            isSet = setTargetBedTemperature(target.celsius) && isSet;
+        } else if (strcmp(target.heater, "chamber") == 0) {
+            isSet = setTargetChamberTemperature(target.celsius) && isSet;
+        }
+    }
+    return isSet;
+}
 
 /***** PRINT BED *****/
 /** octoPrintGetPrinterBed()
@@ -486,21 +1371,21 @@ bool OctoprintClient::setTargetTool1Temperature(uint16_t celsius) {
  * If no heated bed is configured for the currently selected printer profile, the resource will return an 409 Conflict.
  * */
 bool OctoprintClient::fetchPrinterBed() {
-    String command = "/api/printer/bed?history=true&limit=2";
-    String response = sendGetToOctoprint(command);
+    return perform(Operation::FetchPrinterBed);
+}
 
-    DeserializationError e = deserializeJson(requestBuffer, response);
+bool OctoprintClient::applyPrinterBed(DeserializationError e) {
     if (!e) {
-        if (requestBuffer.containsKey("bed")) {
-            state.printerState.temperature.bedCurrentCelsius = requestBuffer["bed"]["actual"].as<float>();
-            state.printerState.temperature.bedOffsetCelsius = requestBuffer["bed"]["offset"].as<float>();
-            state.printerState.temperature.bedTargetCelsius = requestBuffer["bed"]["target"].as<float>();
-        }
+        PrinterState::Thermal &temperature = state.printerState.temperature;
+        bool isChanged = applyBindings(requestBuffer.as<JsonObject>(), bedBindings, temperature, false);
+        // the "bed" entry of the heaters, as filled from /api/printer
+        if (applyHeaters(requestBuffer.as<JsonObject>(), temperature, false)) isChanged = true;
         if (requestBuffer.containsKey("history")) {
             const JsonArray &history = requestBuffer["history"];
-            state.printerState.temperature.bedHistoryTempTimestamp = history[0]["time"].as<long>();
-            state.printerState.temperature.bedHistoryTempCurrentCelsius = history[0]["bed"]["actual"].as<float>();
+            update(temperature.bedHistoryTempTimestamp, history[0]["time"].as<long>(), isChanged);
+            update(temperature.bedHistoryTempCurrentCelsius, history[0]["bed"]["actual"].as<float>(), isChanged);
         }
+        if (isChanged) state.generations.thermal++;
         return true;
     }
     return false;
@@ -514,27 +1399,15 @@ bool OctoprintClient::fetchPrinterBed() {
  * Available commands are: init, refresh, release
 */
 bool OctoprintClient::printerSdInit() {
-    const String command = "/api/printer/sd";
-    const String postData = "{\"command\": \"init\"}";
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::SdInit);
 }
 
 bool OctoprintClient::printerSdRefresh() {
-    const String command = "/api/printer/sd";
-    const String postData = "{\"command\": \"refresh\"}";
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::SdRefresh);
 }
 
 bool OctoprintClient::printerSdRelease() {
-    const String command = "/api/printer/sd";
-    const String postData = "{\"command\": \"release\"}";
-    String response = sendPostToOctoPrint(command, postData);
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    return perform(Operation::SdRelease);
 }
 
 /*
@@ -544,13 +1417,16 @@ If SD support has been disabled in OctoPrint’s settings, a 404 Not Found is re
 Returns a 200 OK with an SD State Response in the body upon success.
 */
 bool OctoprintClient::fetchPrinterSdStatus() {
-    const String command = "/api/printer/sd";
-    String response = sendGetToOctoprint(command);
+    return perform(Operation::FetchPrinterSdStatus);
+}
 
-    DeserializationError e = deserializeJson(requestBuffer, response);
+bool OctoprintClient::applyPrinterSdStatus(DeserializationError e) {
     if (!e) {
-        if (requestBuffer["ready"].as<bool>())
+        if (requestBuffer["ready"].as<bool>()) {
+            const PrinterState::OperationalStateFlags previous = state.printerState.stateFlags;
             state.printerState.addState(PrinterState::OperationalStateFlags::Ready);
+            if (state.printerState.stateFlags != previous) state.generations.printerState++;
+        }
         return true;
     }
     return false;
@@ -563,17 +1439,14 @@ http://docs.octoprint.org/en/master/api/printer.html#send-an-arbitrary-command-t
 Sends any command to the printer via the serial interface. Should be used with some care as some commands can interfere with or even stop a running print job.
 If successful returns a 204 No Content and an empty body.
 */
-bool OctoprintClient::printerCommand(char *gcodeCommand) {
+bool OctoprintClient::printerCommand(const char *gcodeCommand) {
     const String command = "/api/printer/command";
-    char postData[50];
-
-    postData[0] = '\0';
-    sprintf(postData, "{\"command\": \"%s\"}", gcodeCommand);
-
-    String response = sendPostToOctoPrint(command, postData);
-
-    if (state.httpStatusCode == 204) return true;
-    return false;
+    StaticJsonDocument<JSON_OBJECT_SIZE(1)> body;
+    // a const char * is kept by reference, serializing escapes it
+    body["command"] = gcodeCommand;
+    String postData;
+    serializeJson(body, postData);
+    return performPost(command, postData);
 }
 
 
@@ -582,76 +1455,78 @@ bool OctoprintClient::printerCommand(char *gcodeCommand) {
 /**
  * Close the client
  * */
-void OctoprintClient::closeClient() const {
+void OctoprintClient::closeClient() {
     // if(client.connected()){    //1.1.4 - Seems to crash/halt ESP32 if 502 Bad Gateway server error
     client.stop();
     // }
+    connectionRequestCount = 0;
 }
 
 /**
- * Extract the HTTP header response code. Used for error reporting - will print in serial monitor any non 200 response codes (i.e. if something has gone wrong!).
- * Thanks Brian for the start of this function, and the chuckle of watching you realise on a live stream that I didn't use the response code at that time! :)
+ * An open connection is only reused if the previous response was consumed completely, the server did not close it
+ * and neither the idle timeout nor the request limit is exceeded.
  * */
-int OctoprintClient::extractHttpCode(String statusCode, String body) const {
-    if (isDebugEnabled) {
-        Serial.print("\nStatus code to extract: ");
-        Serial.println(statusCode);
-    }
-    int firstSpace = statusCode.indexOf(" ");
-    int lastSpace = statusCode.lastIndexOf(" ");
-    if (firstSpace > -1 && lastSpace > -1 && firstSpace != lastSpace) {
-        String statusCodeALL = statusCode.substring(firstSpace + 1);                //"400 BAD REQUEST"
-        String statusCodeExtract = statusCode.substring(firstSpace + 1,
-                                                        lastSpace); //May end up being e.g. "400 BAD"
-        int statusCodeInt = statusCodeExtract.toInt();                              //Converts to "400" integer - i.e. strips out rest of text characters "fix"
-        if (statusCodeInt != 200
-            and statusCodeInt != 201
-            and statusCodeInt != 202
-            and statusCodeInt != 204) {
-            Serial.print("\nSERVER RESPONSE CODE: " + String(statusCodeALL));
-            if (body != "") Serial.println(" - " + body);
-            else Serial.println();
-        }
-        return statusCodeInt;
-    } else {
-        return -1;
-    }
+bool OctoprintClient::isConnectionReusable() {
+    if (!connectionSettings.isReuseEnabled || connectionRequestCount == 0) return false;
+    if (!client.connected()) return false;
+    if (millis() - connectionLastActivityMs > connectionSettings.idleTimeoutMs) return false;
+    // unsolicited bytes mean request and response are out of sync
+    if (client.available()) return false;
+    return true;
 }
 
-void OctoprintClient::fetchPrinterStateFromJson(const JsonVariant root) {
-    state.printerState.printerStateText = root["state"]["text"].as<String>();
+bool OctoprintClient::connectClient(bool &isReused) {
+    isReused = isConnectionReusable();
+    if (isReused) return true;
 
-    if (root["state"]["flags"]["closedOrError"].as<bool>())
-        state.printerState.setState(PrinterState::OperationalStateFlags::ClosedOrError);
-
-    else if (root["state"]["flags"]["error"].as<bool>())
-        state.printerState.setState(PrinterState::OperationalStateFlags::Error);
-
-    else if (root["state"]["flags"]["operational"].as<bool>())
-        state.printerState.setState(PrinterState::OperationalStateFlags::Operational);
-
-    else if (root["state"]["flags"]["paused"].as<bool>())
-        state.printerState.setState(PrinterState::OperationalStateFlags::Paused);
-
-    else if (root["state"]["flags"]["printing"].as<bool>())
-        state.printerState.setState(PrinterState::OperationalStateFlags::Printing);
-
-    else if (root["state"]["flags"]["ready"].as<bool>())
-        state.printerState.setState(PrinterState::OperationalStateFlags::Ready);
+    closeClient();
+    if (hostUrl.isEmpty()) {
+        return client.connect(hostIp, hostPort);
+    } else if (hostCache.resolver == nullptr) {
+        return client.connect(hostUrl.c_str(), hostPort);
+    }
 
-    else if (root["state"]["flags"]["sdReady"].as<bool>())
-        state.printerState.setState(PrinterState::OperationalStateFlags::SdReady);
+    IPAddress ip;
+    if (!hostCache.lookup(hostUrl.c_str(), ip)) {
+        if (isDebugEnabled) Serial.println(".... host name not resolved");
+        return false;
+    }
+    return client.connect(ip, hostPort);
 }
 
-void OctoprintClient::fetchPrinterThermalDataFromJson(const JsonVariant &root) {
-    state.printerState.temperature.bedCurrentCelsius = root["temperature"]["bed"]["actual"].as<float>();
-    state.printerState.temperature.bedCurrentCelsius = root["temperature"]["bed"]["target"].as<float>();
+/**
+ * Report the HTTP response code. Used for error reporting - will print in serial monitor any non 200 response codes (i.e. if something has gone wrong!).
+ * Thanks Brian for the start of this function, and the chuckle of watching you realise on a live stream that I didn't use the response code at that time! :)
+ * */
+void OctoprintClient::reportHttpStatus(int httpCode, RequestOutcome outcome, const char *body) const {
+    if (isDebugEnabled) {
+        Serial.print("\nhttpCode:");
+        Serial.print(httpCode);
+        Serial.print(" outcome:");
+        Serial.println(static_cast<int>(outcome));
+    }
+    if (httpCode > -1
+        and httpCode != 200
+        and httpCode != 201
+        and httpCode != 202
+        and httpCode != 204
+        // answer to a conditional request, e.g. of fetchFiles()
+        and httpCode != 304) {
+        Serial.print("\nSERVER RESPONSE CODE: ");
+        Serial.print(httpCode);
+        if (body[0] != '\0') {
+            Serial.print(" - ");
+            Serial.println(body);
+        } else Serial.println();
+    }
+}
 
-    state.printerState.temperature.tool0TargetCelsius = root["temperature"]["tool0"]["target"].as<float>();
-    state.printerState.temperature.tool0CurrentCelsius = root["temperature"]["tool0"]["actual"].as<float>();
+bool OctoprintClient::fetchPrinterStateFromJson(const JsonVariant root) {
+    return applyBindings(root.as<JsonObject>(), printerStateBindings, state.printerState, false);
+}
 
-    state.printerState.temperature.tool1TargetCelsius = root["temperature"]["tool1"]["target"].as<float>();
-    state.printerState.temperature.tool1CurrentCelsius = root["temperature"]["tool1"]["actual"].as<float>();
+bool OctoprintClient::fetchPrinterThermalDataFromJson(const JsonVariant &heaters) {
+    return applyHeaters(heaters.as<JsonObject>(), state.printerState.temperature, true);
 }
 
 } // namespace octoprint
@@ -8,110 +8,159 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <Client.h>
+#include <functional>
 #include <string>
+#include "BodySink.h"
+#include "FileIndex.h"
+#include "HostResolver.h"
+#include "HttpResponseParser.h"
+#include "HttpResponseReader.h"
+#include "OctoprintState.h"
+#include "Operation.h"
+#include "RequestMetrics.h"
+#include "StateChangeNotifier.h"
+#include "StateSnapshots.h"
+#include "TemperatureHistory.h"
 
 #define OPAPI_TIMEOUT 3000
 #define USER_AGENT "OctoPrintAPI/1.1.4 (Arduino)"
 
 namespace octoprint {
-struct PrinterState {
-
-    enum class OperationalStateFlags : uint8_t {
-        Undefined = 0,
-        ClosedOrError = 2,
-        Error = 4,
-        Operational = 8,
-        Paused = 16,
-        Printing = 32,
-        Ready = 64,
-        SdReady = 128
-    };
-
-    using UnderlyingOperationalStateType = std::underlying_type<OperationalStateFlags>::type;
-
-    bool hasState(OperationalStateFlags stateFlag) {
-        return (static_cast<UnderlyingOperationalStateType>(stateFlags) |
-                static_cast<UnderlyingOperationalStateType> (stateFlag)) != 0;
-    }
-
-    bool hasStates(UnderlyingOperationalStateType stateFlags) {
-        return (static_cast<UnderlyingOperationalStateType>(this->stateFlags) | stateFlags) != 0;
-    }
-
-    void addState(OperationalStateFlags stateFlag) {
-        stateFlags = static_cast<OperationalStateFlags>(
-                static_cast<UnderlyingOperationalStateType>(stateFlags) |
-                static_cast<UnderlyingOperationalStateType>(stateFlag));
-    }
-
-    void setState(OperationalStateFlags stateFlag) {
-        stateFlags = stateFlag;
-    }
-
-    OperationalStateFlags stateFlags = OperationalStateFlags::Undefined;
-    String printerStateText;
+struct HeaterTarget {
+    // "bed", "chamber" or "tool<n>"
+    const char *heater;
+    uint16_t celsius;
+};
 
-    struct Thermal {
-        float bedCurrentCelsius;
-        float bedTargetCelsius;
-        float bedOffsetCelsius;
+struct RequestStatus {
+    Operation operation{Operation::Get};
+    RequestOutcome outcome{RequestOutcome::Complete};
+    int httpStatusCode{0};
+    bool isSuccess{false};
+};
 
-        long bedHistoryTempTimestamp;
-        float bedHistoryTempCurrentCelsius;
+using RequestCallback = std::function<void(const RequestStatus &status)>;
 
-        float tool0CurrentCelsius;
-        float tool0TargetCelsius;
+struct UploadProgress {
+    size_t bytesSent{0};
+    size_t totalBytes{0};
+    unsigned long elapsedMs{0};
+    // average since the upload started
+    uint32_t bytesPerSecond{0};
+};
 
-        float tool1CurrentCelsius;
-        float tool1TargetCelsius;
+using UploadProgressCallback = std::function<void(const UploadProgress &progress)>;
 
-    } temperature;
+struct UploadOptions {
+    // select the file once uploaded
+    bool isSelected{false};
+    // start printing the file once uploaded, implies selecting it
+    bool isPrinted{false};
+    // invoked after each block sent
+    UploadProgressCallback progress;
 };
 
-struct OctoprintVersion {
-    String api;
-    String server;
+/**
+ * Sections of /api/printer a fetch of the printer statistics asks for, see OctoprintClient::setPrinterFields().
+ * The sd section is never asked for, the state flags carry sdReady.
+ */
+enum class PrinterFields : uint8_t {
+    // printerState.stateFlags and printerState.printerStateText
+    State = 1,
+    // printerState.temperature, and the newest sample for the temperature history
+    Temperature = 2,
+    All = State | Temperature
 };
 
-namespace internal {
-struct JobRequest {
-
-    String printerState;
-    long estimatedPrintTime;
+constexpr PrinterFields operator|(PrinterFields lhs, PrinterFields rhs) {
+    return static_cast<PrinterFields>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+}
 
-    long jobFileDate;
-    String jobFileName;
-    String jobFileOrigin;
-    long jobFileSize;
+/** @return true if fields include all of the wanted ones */
+constexpr bool hasFields(PrinterFields fields, PrinterFields wanted) {
+    return (static_cast<uint8_t>(fields) & static_cast<uint8_t>(wanted)) == static_cast<uint8_t>(wanted);
+}
 
-    float progressCompletion;
-    long progressFilepos;
-    long progressPrintTime;
-    long progressPrintTimeLeft;
+/**
+ * Controls whether the underlying Client is kept open between requests.
+ * When reuse is enabled a connection is dropped and re-established once it was idle for longer than idleTimeoutMs,
+ * served maxRequestsPerConnection requests, or the server answered with "Connection: close".
+ */
+struct ConnectionSettings {
+    bool isReuseEnabled{false};
+    unsigned long idleTimeoutMs{5000};
+    uint16_t maxRequestsPerConnection{100};
+};
 
-    long jobFilamentTool0Length;
-    float jobFilamentTool0Volume;
-    long jobFilamentTool1Length;
-    float jobFilamentTool1Volume;
+namespace internal {
+/**
+ * A file streamed as the body of a multipart upload.
+ */
+struct UploadRequest {
+    // null unless the pending request is an upload
+    Stream *source{nullptr};
+    size_t size{0};
+    String fileName;
+    bool isSelected{false};
+    bool isPrinted{false};
+    UploadProgressCallback progress;
 };
 
-struct BedCallRequest {
-    float tempActualCelsius;
-    float tempOffsetCelsius;
-    float tempTargetCelsius;
-    long tempHistoryTimestamp;
-    float tempHistoryActual;
+/**
+ * When the last response of an operation arrived, see OctoprintClient::setResponseTtl().
+ */
+struct ResponseCacheEntry {
+    // 0 disables caching
+    unsigned long ttlMs{0};
+    unsigned long completedMs{0};
+    bool isSuccess{false};
 };
-} // namespace internal
 
-struct OverallState {
-    PrinterState printerState;
-    OctoprintVersion octoprintVersion;
-    octoprint::internal::BedCallRequest bedRequest;
-    octoprint::internal::JobRequest printJob;
-    mutable int httpStatusCode{0};
-    String httpErrorBody{""};
+/**
+ * The request currently processed by OctoprintClient::poll().
+ */
+struct PendingRequest {
+    // requests for the operation in flight that are answered by its response
+    static constexpr uint8_t maxJoinedCallbacks = 3;
+
+    enum class Phase : uint8_t {
+        Idle,
+        Connecting,
+        Receiving
+    };
+
+    Phase phase{Phase::Idle};
+    Operation operation{Operation::Get};
+    // point into the command table or to customCommand/customData
+    const char *command{""};
+    const char *data{""};
+    String customCommand;
+    String customData;
+    BodySink *sink{nullptr};
+    RequestCallback callback;
+    RequestCallback joinedCallbacks[maxJoinedCallbacks];
+    uint8_t joinedCount{0};
+    bool isBlocking{false};
+    bool isReused{false};
+    bool isStreamed{false};
+    uint8_t attempt{0};
+    DeserializationError jsonError;
+    unsigned long startUs{0};
+    // time spent establishing new connections, 0 while the request used a reused connection only
+    unsigned long connectUs{0};
+    // a new connection was tried, successfully or not; decides whether a silent host's address is looked up again
+    bool isConnectAttempted{false};
+    // a new connection was established, only then connectUs is recorded
+    bool hasConnected{false};
+    UploadRequest upload;
+    // the index a FetchFiles request fills
+    FileIndex *fileIndex{nullptr};
+    // sent in addition to the common headers, each line terminated by \r\n
+    String headers;
+    // the sections a FetchPrinterStatistics request asked for
+    PrinterFields printerFields{PrinterFields::All};
 };
+} // namespace internal
 
 struct OctoprintClient {
 
@@ -119,15 +168,192 @@ struct OctoprintClient {
 
     OctoprintClient(const String &apiKey, Client &connecion, const String &hostUrl, uint16_t hostPort = 5000);
 
+    /** @return a copy of the state, prefer getState() to avoid copying the Strings */
     OverallState getCachedState() const;
 
+    /**
+     * Read-only view on the state, valid as long as the client. It changes only while a request completes, i.e.
+     * within fetch methods and poll(). Compare OverallState::generations to detect changes. Only for the task that
+     * drives the client, other cores or threads read StateSnapshots.
+     */
+    const OverallState &getState() const;
+
+    /**
+     * Publishes the state after each completed request or pushed message, readers on other cores or threads take
+     * consistent copies from there without locking the client. A publication skipped because a reader was still
+     * copying is repeated by the next poll().
+     * @param snapshots owned by the caller, must outlive the client; nullptr (default) disables publishing
+     */
+    void setStateSnapshots(StateSnapshots *snapshots);
+
+    /**
+     * Keep the connection open between requests instead of reconnecting for each one.
+     * Stale connections (closed by the server, idle or exhausted) are re-established transparently.
+     * @param isEnabled enables or disables connection reuse; disabling closes an open connection
+     * @param idleTimeoutMs an open connection idle for longer than this is closed before the next request
+     * @param maxRequestsPerConnection number of requests after which the connection is re-established
+     */
+    void setConnectionReuse(bool isEnabled, unsigned long idleTimeoutMs = 5000, uint16_t maxRequestsPerConnection = 100);
+
+    const ConnectionSettings &getConnectionSettings() const;
+
+    /**
+     * Records count, latencies, bytes and failures of every finished request.
+     * @param metrics owned by the caller, must outlive the client; nullptr (default) disables recording
+     */
+    void setMetrics(RequestMetrics *metrics);
+
+    /**
+     * Resolves the host name once per TTL instead of on every connect, which costs a DNS or mDNS lookup each.
+     * The resolved address is pinned for the connects within the TTL and re-resolved after a connect to it failed;
+     * a failed resolution fails connects right away for negativeTtlMs. Only applies to clients constructed with a
+     * host name. Lookups block: the one of a connect delays that request, an opted-in refresh ahead of expiry
+     * (HostCacheSettings::refreshAheadMs) delays the poll() of the idle client, and with it e.g. a fleet's poll().
+     * @param resolver owned by the caller, must outlive the client, e.g. a WiFiHostResolver; nullptr (default)
+     * connects by name
+     */
+    void setHostResolver(HostResolver *resolver, const HostCacheSettings &settings = HostCacheSettings{});
+
+    /**
+     * Lets the blocking fetch method of an operation return right away, without request, for ttlMs after its last
+     * successful response: the state still holds what it fetched. Commands and POSTs end all TTLs early, since they
+     * may change what was fetched. Requests of the operation while one is in flight, blocking or via request(), are
+     * answered by the response in flight regardless of the TTL.
+     * @param operation one of the fetches of the state: FetchOctoprintVersion, FetchPrinterStatistics, FetchPrintJob,
+     * FetchPrinterBed or FetchPrinterSdStatus
+     * @param ttlMs 0 (default) fetches every time
+     * @return false if the operation's responses cannot be cached
+     */
+    bool setResponseTtl(Operation operation, unsigned long ttlMs);
+
+    /**
+     * Narrows fetches of the printer statistics (fetchPrinterStatistics(), request() and the PollScheduler) down to
+     * some sections of /api/printer. The others are excluded by OctoPrint (?exclude=..), not transferred nor parsed,
+     * and their part of the state is left as it is.
+     * @param fields PrinterFields::All (default), or e.g. PrinterFields::Temperature while only a display of
+     * temperatures is updated
+     */
+    void setPrinterFields(PrinterFields fields);
+
+    PrinterFields getPrinterFields() const;
+
+    /**
+     * Change callbacks, invoked from fetch methods and poll() after a response changed the parsed values.
+     * A callback may start the next request. Pass nullptr to unsubscribe.
+     */
+    void onStateFlagsChanged(StateFlagsCallback callback);
+
+    /**
+     * @param deadbandCelsius a measured temperature must move further than this from the last reported value,
+     * target changes are always reported
+     */
+    void onTemperatureChanged(float deadbandCelsius, TemperatureCallback callback);
+
+    /**
+     * Job start and finish are derived from the Printing and Paused flags of /api/printer or the push api, finish
+     * covers completion and cancellation. The callbacks get the job as last fetched from /api/job.
+     */
+    void onJobStarted(JobCallback callback);
+
+    void onJobFinished(JobCallback callback);
+
+    /** @param stepPercent fires while a job is active whenever completion enters the next multiple of it */
+    void onProgress(float stepPercent, JobCallback callback);
+
+    /**
+     * Collects a temperature time series. While set, fetches of the printer state request the newest history entry
+     * along (/api/printer?history=true&limit=1) and add it, so samples carry OctoPrint's timestamps.
+     * @param history owned by the caller, must outlive the client, e.g. a TemperatureHistory; nullptr (default)
+     * disables collection
+     */
+    void setTemperatureHistory(TemperatureSampleSink *history);
+
+    /**
+     * Backfills the temperature history with up to limit of OctoPrint's recent samples, e.g. after a restart.
+     * Samples already collected are skipped by the history, backfill before polling since older samples are too.
+     * @return false if no history is set or the request failed
+     */
+    bool fetchTemperatureHistory(uint16_t limit);
+
+    /**
+     * Lists the index's folder into the index, entry by entry straight from the connection, so the size of the
+     * listing is not bounded by maxMessageLengthBytes. A refresh sends the validators of the previous listing, an
+     * unchanged folder is answered with 304 Not Modified and not transferred again.
+     * @return false if the request failed or the listing broke off
+     */
+    bool fetchFiles(FileIndex &index);
+
+    /**
+     * Passive login with the api key, e.g. to authenticate OctoprintPushClient's socket.
+     * @param user, session receive the user the api key belongs to and the session
+     */
+    bool fetchPushSession(String &user, String &session);
+
+    /** Connects another Client to the OctoPrint host of this client, e.g. the socket of OctoprintPushClient. */
+    bool connectToHost(Client &connection) const;
+
+    /** @return the host as sent in the Host header */
+    String getHostName() const;
+
+    /**
+     * Applies the payload of a "current" or "history" message of OctoPrint's push api to the state, just like the
+     * fetch methods do, including change callbacks and the temperature history.
+     * @param message e.g. {"state": {..}, "job": {..}, "progress": {..}, "temps": [..]}
+     */
+    void applyPushedState(const JsonVariant &message);
+
+    /**
+     * Starts a request without waiting for the response, call poll() until it completes.
+     * Unlike the blocking fetch methods, which deserialize straight from the connection, asynchronously fetched
+     * responses are buffered (up to maxMessageLengthBytes) and applied to the state on completion.
+     * @param operation any operation except Login and those needing parameters: Get, Post, FetchTemperatureHistory,
+     * FetchFiles and Upload
+     * @param callback invoked from poll() on completion, may start the next request
+     * @return false if another request is in progress, unless it is a fetch of the same operation, which then
+     * answers this request too
+     */
+    bool request(Operation operation, RequestCallback callback = nullptr);
+
+    /**
+     * Starts a POST of a Json body to an api endpoint without waiting for the response, call poll() until it
+     * completes. The request succeeds on 204 No Content.
+     * @param command the endpoint, e.g. "/api/printer/tool"
+     * @return false if another request is in progress
+     */
+    bool requestPost(const String &command, const String &postData, RequestCallback callback = nullptr);
+
+    /**
+     * Makes progress on the pending request: connects and sends it, then processes whatever part of the response
+     * already arrived. Receiving never waits, but the call that sends the request blocks: Client::connect() returns
+     * only once the connection is established or failed, which for an unreachable host takes the Client's own
+     * connect timeout (seconds on ESP32/ESP8266) and is not bounded by the request timeout. A reused connection skips
+     * the connect. An upload's body is written completely within the same call.
+     * @return true while the request is in progress
+     */
+    bool poll();
+
+    bool isBusy() const;
+
+    /** @return the status of the last completed request */
+    const RequestStatus &getRequestStatus() const;
+
     /**
      * Send custom command to OctoPrint.
      * Sends a custom command via GET to the endpoint's API.
      * @param command custom api command
      * @return the Json response body
      */
-    String sendCustomCommand(String command) const;
+    String sendCustomCommand(String command);
+
+    /**
+     * Send custom command to OctoPrint.
+     * Sends a custom command via GET to the endpoint's API and streams the response body into the sink as it
+     * arrives, so the body size is not limited.
+     * @param command custom api command
+     * @param sink receives the decoded response body
+     * @return true if the response was received completely and with a 2xx status code
+     */
+    bool sendCustomCommand(const String &command, BodySink &sink);
 
     bool fetchOctoprintVersion();
 
@@ -143,8 +369,10 @@ struct OctoprintClient {
 
     bool printHeadHome();
 
+    /** Blocking single jog, use a MotionChannel for interactive control. */
     bool printHeadRelativeJog(double x, double y, double z, double f);
 
+    /** Blocking single extrusion, use a MotionChannel for interactive control. */
     bool printExtrude(double amount);
 
     bool setTargetBedTemperature(uint16_t celsius);
@@ -153,6 +381,23 @@ struct OctoprintClient {
 
     bool setTargetTool1Temperature(uint16_t celsius);
 
+    bool setTargetChamberTemperature(uint16_t celsius);
+
+    /**
+     * Sets the targets of several heaters, e.g. {{"tool0", 215}, {"tool1", 170}, {"bed", 60}}.
+     * All tools go in a single POST to /api/printer/tool. OctoPrint has no such request for the bed and the chamber,
+     * each of them is posted to its own endpoint (/api/printer/bed, /api/printer/chamber) after the tools, so the
+     * call is not atomic: a failing POST does not undo the ones before.
+     * @return false if a heater is not "bed", "chamber" or "tool<n>" or the tools do not fit into one request,
+     * nothing is sent then; otherwise false if any of the POSTs failed
+     */
+    bool setTargets(const HeaterTarget *targets, uint8_t count);
+
+    template<size_t count>
+    bool setTargets(const HeaterTarget (&targets)[count]) {
+        return setTargets(targets, static_cast<uint8_t>(count));
+    }
+
     bool fetchPrinterSdStatus();
 
     bool printerSdInit();
@@ -177,34 +422,145 @@ struct OctoprintClient {
 
     bool fileSelect(String &path);
 
-    bool printerCommand(char *gcodeCommand);
+    /**
+     * Uploads a file to OctoPrint's local storage (POST /api/files/local). The file is streamed from the source in
+     * blocks of maxMessageLengthBytes, so it never has to fit into RAM. Blocks until OctoPrint answered.
+     * @param fileName name on the server, e.g. "benchy.gcode"
+     * @param source delivers the file, read with its Stream timeout
+     * @param size exact number of bytes the source delivers, it determines the Content-Length
+     * @return true if OctoPrint answered 201 Created
+     */
+    bool uploadFile(const String &fileName, Stream &source, size_t size,
+                    const UploadOptions &options = UploadOptions{});
+
+    /**
+     * Sends a single G-code line, e.g. "M117 Hello". Send sequences of lines through a GcodeQueue, which batches them
+     * into one request.
+     */
+    bool printerCommand(const char *gcodeCommand);
 
 private:
     OverallState state;
 
     Client &client;
     const String &apiKey;
-    const IPAddress &hostIp{};
-    const String &hostUrl{};
+    const IPAddress hostIp{};
+    const String hostUrl{};
     const uint16_t hostPort;
 
-    const uint16_t maxMessageLengthBytes = 1000;
+    static constexpr uint16_t maxMessageLengthBytes = 1000;
+    static constexpr uint16_t receiveBufferLengthBytes = 128;
     bool isDebugEnabled{false};
     DynamicJsonDocument requestBuffer{1024};
+    char receiveBuffer[receiveBufferLengthBytes];
+    char responseBody[maxMessageLengthBytes + 1];
+
+    ConnectionSettings connectionSettings;
+    RequestMetrics *metrics{nullptr};
+    internal::HostCache hostCache;
+    internal::ResponseCacheEntry responseCache[operationsCount];
+    TemperatureSampleSink *temperatureHistory{nullptr};
+    PrinterFields printerFields{PrinterFields::All};
+    internal::StateChangeNotifier notifier;
+    StateSnapshots *snapshots{nullptr};
+    bool isSnapshotPending{false};
+    uint16_t connectionRequestCount{0};
+    unsigned long connectionLastActivityMs{0};
+
+    internal::PendingRequest pending;
+    RequestStatus requestStatus;
+    internal::HttpResponseReader reader{client, receiveBuffer, sizeof(receiveBuffer), OPAPI_TIMEOUT};
+    BufferBodySink responseSink{responseBody, sizeof(responseBody)};
+
+    void closeClient();
+
+    bool isConnectionReusable();
+
+    bool connectClient(bool &isReused);
+
+    /**
+     * @param command, data must stay valid until the request completed, e.g. entries of the command table
+     */
+    bool startRequest(Operation operation, const char *command, const char *data, BodySink &sink,
+                      RequestCallback callback, bool isBlocking);
+
+    /** Starts a request with an endpoint and body built at runtime, both are copied. */
+    bool startCustomRequest(Operation operation, const String &command, const String &data, BodySink &sink,
+                            RequestCallback callback, bool isBlocking);
+
+    /** @return the endpoint of an operation without parameters, as narrowed by the client's settings */
+    const char *endpointOf(Operation operation) const;
+
+    /** Runs an operation without parameters to completion. */
+    bool perform(Operation operation);
+
+    /** Runs a POST expecting 204 No Content to completion. */
+    bool performPost(const String &command, const String &postData);
+
+    void awaitCompletion();
+
+    /** Connects and sends the pending request, blocks in Client::connect() and while an upload is written. */
+    void connectPending();
+
+    void receivePending();
+
+    void completePending(RequestOutcome outcome);
 
-    void closeClient() const;
+    void recordMetrics(RequestOutcome outcome);
 
-    String sendGetToOctoprint(String command) const;
+    /** @return true if the request in flight answers a request of the operation */
+    bool isJoinable(Operation operation) const;
 
-    String sendPostToOctoPrint(const String &command, const String &postData) const;
+    /** @return true if the state holds a response of the operation within its TTL */
+    bool isFresh(Operation operation) const;
 
-    String sendRequestToOctoprint(const String &type, const String &command, const String &data) const;
+    void updateResponseCache(Operation operation, bool isSuccess);
 
-    int extractHttpCode(String statusCode, String body) const;
+    /** Passes the entries of the history array in the response body to temperatureHistory one at a time. */
+    DeserializationError readTemperatureHistory();
 
-    void fetchPrinterStateFromJson(const JsonVariant root);
+    /** Deserializes a 2xx fetch response and applies it to the state. */
+    bool applyFetchedJson(Operation operation);
+
+    /** Writes the request line and the headers every request carries. */
+    void writeRequestHead(Print &out, const char *method, const char *command);
+
+    void writeRequest(const char *method, const char *command, const char *data);
+
+    /** @return InProgress once the upload was sent completely, otherwise the error */
+    RequestOutcome writeUpload();
+
+    /**
+     * Updates connection bookkeeping and the request related parts of the state after the response was consumed.
+     * @param body the collected response body or null if it was passed to a foreign sink
+     */
+    void endRequest(RequestOutcome outcome, const char *body);
+
+    void publishState();
+
+    bool applyOctoprintVersion(DeserializationError e);
+
+    bool applyPrinterStatistics(DeserializationError e);
+
+    bool applyPrintJob(DeserializationError e);
+
+    bool applyPrinterBed(DeserializationError e);
+
+    bool applyPrinterSdStatus(DeserializationError e);
+
+    void reportHttpStatus(int httpCode, RequestOutcome outcome, const char *body) const;
+
+    /** @return true if text or flags changed */
+    bool fetchPrinterStateFromJson(const JsonVariant root);
+
+    /**
+     * @param heaters e.g. {"bed": {"actual": .., "target": ..}, "tool0": {..}}
+     * @return true if any temperature changed
+     */
+    bool fetchPrinterThermalDataFromJson(const JsonVariant &heaters);
 
-    void fetchPrinterThermalDataFromJson(const JsonVariant &root);
+    /** @return true if job or progress changed */
+    bool fetchPrintJobFromJson(const JsonVariant &root);
 };
 
 } // namespace octoprint
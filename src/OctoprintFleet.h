@@ -0,0 +1,204 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "OctoprintClient.h"
+
+namespace octoprint {
+
+struct FleetSettings {
+    // each printer is fetched once per interval
+    unsigned long pollIntervalMs{1000};
+    // upper bound of requests in flight at the same time, across all printers
+    uint8_t maxConcurrentRequests{4};
+    // an unreachable printer is polled at most every pollIntervalMs << maxBackoffShift
+    uint8_t maxBackoffShift{4};
+};
+
+struct FleetPrinterStatus {
+    bool isReachable{false};
+    uint16_t consecutiveFailures{0};
+    unsigned long lastUpdateMs{0};
+    PrinterState::OperationalStateFlags stateFlags{PrinterState::OperationalStateFlags::Undefined};
+};
+
+struct FleetSummary {
+    uint16_t printers{0};
+    uint16_t reachable{0};
+    uint16_t operational{0};
+    uint16_t printing{0};
+    uint16_t paused{0};
+    uint16_t error{0};
+};
+
+/**
+ * Polls a fleet of printers, one OctoprintClient per printer, from a single event loop.
+ *
+ * Each printer's state (/api/printer) and job (/api/job) are fetched once per poll interval using the clients'
+ * non-blocking request engine, so the time to refresh the fleet is bounded by the number of concurrent requests
+ * instead of the sum of all request latencies. First polls are spread evenly over the interval to avoid bursts.
+ * Call poll() from loop() or the host's main loop.
+ *
+ * Connecting is not asynchronous: OctoprintClient::poll() blocks in Client::connect(). With the blocking clients of
+ * ESP32/ESP8266 one unreachable printer stalls the whole fleet for the connect timeout at each of its polls, and
+ * maxConcurrentRequests does not bound that since the requests are dispatched one after the other. The backoff only
+ * makes those stalls rarer. Non-blocking clients such as host::PosixClient do not stall.
+ *
+ * @tparam capacity maximum number of printers
+ */
+template<size_t capacity>
+struct OctoprintFleet {
+
+    explicit OctoprintFleet(const FleetSettings &settings = FleetSettings{}) : settings(settings) {}
+
+    /**
+     * @param client must outlive the fleet and must not be used by other code while the fleet is polling
+     * @return the printer's index or -1 if the fleet is full
+     */
+    int add(OctoprintClient &client) {
+        if (count >= capacity) return -1;
+        members[count] = Member{};
+        members[count].client = &client;
+        count++;
+        spreadPolls();
+        return static_cast<int>(count - 1);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    /**
+     * Dispatches due fetches and makes progress on all requests in flight.
+     * @return number of requests in flight
+     */
+    uint8_t poll() {
+        const unsigned long now = millis();
+
+        for (size_t idx = 0; idx < count; idx++) {
+            if (members[idx].isInFlight) members[idx].client->poll();
+        }
+
+        for (size_t scanned = 0; scanned < count && inFlight < settings.maxConcurrentRequests; scanned++) {
+            // round robin, so that printers due at the same time share the request slots fairly
+            const size_t idx = cursor;
+            cursor = (cursor + 1) % count;
+            Member &member = members[idx];
+            if (member.isInFlight || static_cast<long>(now - member.nextPollMs) < 0) continue;
+            dispatch(idx);
+        }
+        return inFlight;
+    }
+
+    OctoprintClient &getClient(size_t index) {
+        return *members[index].client;
+    }
+
+    const FleetPrinterStatus &getStatus(size_t index) const {
+        return members[index].status;
+    }
+
+    FleetSummary summarize() const {
+        using Flags = PrinterState::OperationalStateFlags;
+        FleetSummary summary;
+        summary.printers = count;
+        for (size_t idx = 0; idx < count; idx++) {
+            const FleetPrinterStatus &status = members[idx].status;
+            if (!status.isReachable) continue;
+            summary.reachable++;
+            if (hasFlag(status.stateFlags, Flags::Operational)) summary.operational++;
+            if (hasFlag(status.stateFlags, Flags::Printing)) summary.printing++;
+            if (hasFlag(status.stateFlags, Flags::Paused)) summary.paused++;
+            if (hasFlag(status.stateFlags, Flags::Error) || hasFlag(status.stateFlags, Flags::ClosedOrError))
+                summary.error++;
+        }
+        return summary;
+    }
+
+private:
+    struct Member {
+        OctoprintClient *client{nullptr};
+        unsigned long nextPollMs{0};
+        // index into polledOperations of the next fetch within the current cycle
+        uint8_t nextOperation{0};
+        bool isInFlight{false};
+        bool hasCycleFailed{false};
+        FleetPrinterStatus status;
+    };
+
+    static constexpr Operation polledOperations[] = {Operation::FetchPrinterStatistics, Operation::FetchPrintJob};
+    static constexpr uint8_t polledOperationsCount = sizeof(polledOperations) / sizeof(polledOperations[0]);
+
+    FleetSettings settings;
+    Member members[capacity];
+    size_t count{0};
+    size_t cursor{0};
+    uint8_t inFlight{0};
+
+    static bool hasFlag(PrinterState::OperationalStateFlags flags, PrinterState::OperationalStateFlags flag) {
+        return (static_cast<PrinterState::UnderlyingOperationalStateType>(flags) &
+                static_cast<PrinterState::UnderlyingOperationalStateType>(flag)) != 0;
+    }
+
+    void spreadPolls() {
+        const unsigned long now = millis();
+        for (size_t idx = 0; idx < count; idx++) {
+            members[idx].nextPollMs = now + settings.pollIntervalMs * idx / count;
+        }
+    }
+
+    void dispatch(size_t idx) {
+        Member &member = members[idx];
+        const Operation operation = polledOperations[member.nextOperation];
+        const bool isStarted = member.client->request(operation, [this, idx](const RequestStatus &status) {
+            onCompleted(idx, status);
+        });
+        if (!isStarted) return;
+
+        member.isInFlight = true;
+        inFlight++;
+        // connecting happens in the first poll, get it going right away
+        member.client->poll();
+    }
+
+    void onCompleted(size_t idx, const RequestStatus &status) {
+        Member &member = members[idx];
+        member.isInFlight = false;
+        inFlight--;
+
+        if (!status.isSuccess) member.hasCycleFailed = true;
+        if (status.operation == Operation::FetchPrinterStatistics && status.isSuccess) {
+            member.status.stateFlags = member.client->getState().printerState.stateFlags;
+        }
+
+        // a non-blocking client reports a refused connect as closed before any response arrived
+        const bool isUnreachable = status.outcome == RequestOutcome::ConnectionFailed ||
+                                   status.outcome == RequestOutcome::Timeout ||
+                                   (status.outcome == RequestOutcome::ConnectionClosed && status.httpStatusCode < 0);
+        member.nextOperation++;
+        if (member.nextOperation < polledOperationsCount && !isUnreachable) return;
+
+        // cycle finished
+        const unsigned long now = millis();
+        member.nextOperation = 0;
+        if (member.hasCycleFailed) {
+            if (member.status.consecutiveFailures < UINT16_MAX) member.status.consecutiveFailures++;
+        } else {
+            member.status.consecutiveFailures = 0;
+            member.status.lastUpdateMs = now;
+        }
+        member.status.isReachable = !isUnreachable;
+        member.hasCycleFailed = false;
+
+        uint8_t backoffShift = (member.status.consecutiveFailures < settings.maxBackoffShift)
+                               ? member.status.consecutiveFailures : settings.maxBackoffShift;
+        member.nextPollMs = now + (settings.pollIntervalMs << backoffShift);
+    }
+};
+
+template<size_t capacity>
+constexpr Operation OctoprintFleet<capacity>::polledOperations[];
+
+} // namespace octoprint
@@ -0,0 +1,129 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "OctoprintPushClient.h"
+
+namespace octoprint {
+
+namespace internal {
+
+void selectPushedFields(JsonDocument &filter) {
+    for (const char *type : {"current", "history"}) {
+        filter[type]["state"]["text"] = true;
+        filter[type]["state"]["flags"] = true;
+        filter[type]["job"]["estimatedPrintTime"] = true;
+        filter[type]["job"]["file"]["date"] = true;
+        filter[type]["job"]["file"]["name"] = true;
+        filter[type]["job"]["file"]["origin"] = true;
+        filter[type]["job"]["file"]["size"] = true;
+        filter[type]["job"]["filament"]["tool0"] = true;
+        filter[type]["job"]["filament"]["tool1"] = true;
+        filter[type]["progress"]["completion"] = true;
+        filter[type]["progress"]["filepos"] = true;
+        filter[type]["progress"]["printTime"] = true;
+        filter[type]["progress"]["printTimeLeft"] = true;
+    }
+    // history carries minutes of samples, they would not fit; the next current brings the latest one.
+    // Every heater is kept, they are discovered from the keys.
+    filter["current"]["temps"][0]["*"] = true;
+    filter["reauthRequired"] = true;
+}
+
+} // namespace internal
+
+OctoprintPushClient::OctoprintPushClient(OctoprintClient &printer, Client &connection, const PushSettings &settings,
+                                         const PollSchedulerSettings &fallbackSettings) :
+        printer(printer),
+        connection(connection),
+        socket{connection, OPAPI_TIMEOUT},
+        settings(settings),
+        fallback{printer, fallbackSettings},
+        nextOpenMs{millis()} {
+    internal::selectPushedFields(filter);
+}
+
+bool OctoprintPushClient::poll() {
+    if (isActive) {
+        if (receive()) return true;
+        fallBack();
+        return false;
+    }
+
+    fallback.poll();
+    if (static_cast<long>(millis() - nextOpenMs) < 0 || printer.isBusy()) return false;
+    isActive = open();
+    if (!isActive) nextOpenMs = millis() + settings.reconnectIntervalMs;
+    return isActive;
+}
+
+bool OctoprintPushClient::isPushActive() const {
+    return isActive;
+}
+
+void OctoprintPushClient::setThrottle(uint8_t throttle) {
+    settings.throttle = throttle;
+    if (isActive && !sendThrottle()) fallBack();
+}
+
+void OctoprintPushClient::close() {
+    if (isActive) fallBack();
+}
+
+bool OctoprintPushClient::open() {
+    String user;
+    String session;
+    if (!printer.fetchPushSession(user, session)) return false;
+
+    if (!printer.connectToHost(connection)) return false;
+    if (!socket.handshake(printer.getHostName(), "/sockjs/websocket")) {
+        socket.close();
+        return false;
+    }
+
+    StaticJsonDocument<192> auth;
+    auth["auth"] = user + ":" + session;
+    char text[192];
+    serializeJson(auth, text, sizeof(text));
+    // without subscription OctoPrint (before 1.6 always) pushes logs, events and plugin messages too
+    const bool isSubscribed = socket.sendText(text) &&
+                              socket.sendText("{\"subscribe\": {\"state\": {\"logs\": false, \"messages\": false},"
+                                              " \"events\": false, \"plugins\": false}}") &&
+                              sendThrottle();
+    if (!isSubscribed) {
+        socket.close();
+        return false;
+    }
+    lastMessageMs = millis();
+    return true;
+}
+
+bool OctoprintPushClient::sendThrottle() {
+    char text[24];
+    snprintf(text, sizeof(text), "{\"throttle\": %u}", static_cast<unsigned>(settings.throttle));
+    return socket.sendText(text);
+}
+
+bool OctoprintPushClient::receive() {
+    const unsigned long now = millis();
+    while (socket.beginMessage()) {
+        const DeserializationError error = deserializeJson(message, socket, DeserializationOption::Filter(filter));
+        // e.g. {"connected": {..}} or {"event": {..}} deserialize to an empty document
+        if (error) return false;
+        lastMessageMs = now;
+
+        if (message.containsKey("reauthRequired")) return false;
+        if (message.containsKey("history")) printer.applyPushedState(message["history"]);
+        if (message.containsKey("current")) printer.applyPushedState(message["current"]);
+    }
+    return socket.isOpen() && now - lastMessageMs < settings.staleTimeoutMs;
+}
+
+void OctoprintPushClient::fallBack() {
+    if (isActive) socket.close();
+    isActive = false;
+    nextOpenMs = millis() + settings.reconnectIntervalMs;
+    fallback.pollNow();
+}
+
+} // namespace octoprint
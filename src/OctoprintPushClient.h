@@ -0,0 +1,99 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "OctoprintClient.h"
+#include "PollScheduler.h"
+#include "WebSocketConnection.h"
+
+namespace octoprint {
+
+namespace internal {
+
+/**
+ * Slots of the filter selectPushedFields() builds: per message type state{text, flags}, job{estimatedPrintTime, file,
+ * filament}, file{date, name, origin, size}, filament{tool0, tool1} and the four progress fields, plus temps in
+ * "current" and reauthRequired at the root.
+ */
+constexpr size_t pushedStateFilterCapacity =
+        JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(4) + JSON_OBJECT_SIZE(2) +
+        JSON_OBJECT_SIZE(4);
+constexpr size_t pushFilterCapacity =
+        JSON_OBJECT_SIZE(3) + 2 * pushedStateFilterCapacity + JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(1) +
+        JSON_OBJECT_SIZE(1);
+
+/** Selects the parts of "current" and "history" messages that end up in OverallState. */
+void selectPushedFields(JsonDocument &filter);
+
+} // namespace internal
+
+struct PushSettings {
+    // OctoPrint sends state updates at most every throttle * 500 ms
+    uint8_t throttle{1};
+    // a socket without any message for this long is considered dead, OctoPrint sends temperatures every few seconds
+    unsigned long staleTimeoutMs{30000};
+    // while falling back to polling, push is retried at this interval
+    unsigned long reconnectIntervalMs{30000};
+};
+
+/**
+ * Keeps an OctoprintClient's state up to date from OctoPrint's push api (/sockjs/websocket) instead of polling it.
+ *
+ * The socket authenticates with a session obtained by a passive login with the client's api key and subscribes to
+ * state updates only. "current" and "history" messages are deserialized straight from the socket and applied like
+ * fetched responses, so getState(), the change callbacks and the temperature history work as with polling.
+ * Whenever the socket cannot be opened, closes, asks for re-authentication or falls silent, the state is polled by a
+ * PollScheduler until push can be restored.
+ * Call poll() from loop().
+ */
+struct OctoprintPushClient {
+
+    /**
+     * @param printer must outlive the push client, its requests are waited for
+     * @param connection dedicated to the socket, not the one of printer
+     */
+    OctoprintPushClient(OctoprintClient &printer, Client &connection, const PushSettings &settings = PushSettings{},
+                        const PollSchedulerSettings &fallbackSettings = PollSchedulerSettings{});
+
+    /**
+     * Applies the messages that arrived, or polls and retries push while falling back.
+     * Opening the socket blocks for the login request and the handshake.
+     * @return true while updates are pushed
+     */
+    bool poll();
+
+    bool isPushActive() const;
+
+    /** Changes the update interval to throttle * 500 ms, sent right away if the socket is open. */
+    void setThrottle(uint8_t throttle);
+
+    /** Closes the socket and polls until the next reconnect attempt. */
+    void close();
+
+private:
+    OctoprintClient &printer;
+    Client &connection;
+    internal::WebSocketConnection socket;
+    PushSettings settings;
+    PollScheduler fallback;
+    DynamicJsonDocument message{1024};
+    // built once, applied to every message
+    StaticJsonDocument<internal::pushFilterCapacity> filter;
+
+    bool isActive{false};
+    unsigned long lastMessageMs{0};
+    unsigned long nextOpenMs;
+
+    bool open();
+
+    bool sendThrottle();
+
+    /** @return false if the socket has to be given up */
+    bool receive();
+
+    void fallBack();
+};
+
+} // namespace octoprint
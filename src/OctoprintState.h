@@ -0,0 +1,155 @@
+/**
+ * Author: https://github.com/rubienr
+ * based on OcttoPrintAPI Stephen Ludgate https://www.chunkymedia.co.uk
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+#include <type_traits>
+#include "HttpResponseParser.h"
+
+namespace octoprint {
+
+struct PrinterState {
+
+    enum class OperationalStateFlags : uint8_t {
+        Undefined = 0,
+        ClosedOrError = 2,
+        Error = 4,
+        Operational = 8,
+        Paused = 16,
+        Printing = 32,
+        Ready = 64,
+        SdReady = 128
+    };
+
+    using UnderlyingOperationalStateType = std::underlying_type<OperationalStateFlags>::type;
+
+    bool hasState(OperationalStateFlags stateFlag) const {
+        return (static_cast<UnderlyingOperationalStateType>(stateFlags) &
+                static_cast<UnderlyingOperationalStateType> (stateFlag)) != 0;
+    }
+
+    /** @return true if any of the given flags is set */
+    bool hasStates(UnderlyingOperationalStateType stateFlags) const {
+        return (static_cast<UnderlyingOperationalStateType>(this->stateFlags) & stateFlags) != 0;
+    }
+
+    void addState(OperationalStateFlags stateFlag) {
+        stateFlags = static_cast<OperationalStateFlags>(
+                static_cast<UnderlyingOperationalStateType>(stateFlags) |
+                static_cast<UnderlyingOperationalStateType>(stateFlag));
+    }
+
+    void setState(OperationalStateFlags stateFlag) {
+        stateFlags = stateFlag;
+    }
+
+    OperationalStateFlags stateFlags = OperationalStateFlags::Undefined;
+    String printerStateText;
+
+    // bed, chamber and up to 5 tools
+    static constexpr uint8_t maxHeaters = 7;
+
+    struct Heater {
+        // key in OctoPrint's temperature object, e.g. "bed", "chamber" or "tool3"
+        char name[12];
+        float currentCelsius;
+        float targetCelsius;
+    };
+
+    struct Thermal {
+        // in the order OctoPrint reported them first, a heater keeps its slot once discovered
+        Heater heaters[maxHeaters];
+        uint8_t heatersCount{0};
+
+        /** @return the heater with the given name, null if it has not been reported */
+        const Heater *findHeater(const char *name) const {
+            for (uint8_t idx = 0; idx < heatersCount; idx++) {
+                if (strcmp(heaters[idx].name, name) == 0) return &heaters[idx];
+            }
+            return nullptr;
+        }
+
+        // bed, tool0 and tool1 mirror their heaters, the bed fields are also set by /api/printer/bed
+        float bedCurrentCelsius;
+        float bedTargetCelsius;
+        float bedOffsetCelsius;
+
+        long bedHistoryTempTimestamp;
+        float bedHistoryTempCurrentCelsius;
+
+        float tool0CurrentCelsius;
+        float tool0TargetCelsius;
+
+        float tool1CurrentCelsius;
+        float tool1TargetCelsius;
+
+    } temperature;
+};
+
+struct OctoprintVersion {
+    String api;
+    String server;
+};
+
+namespace internal {
+struct JobRequest {
+
+    String printerState;
+    long estimatedPrintTime;
+
+    long jobFileDate;
+    String jobFileName;
+    String jobFileOrigin;
+    long jobFileSize;
+
+    float progressCompletion;
+    long progressFilepos;
+    long progressPrintTime;
+    long progressPrintTimeLeft;
+
+    long jobFilamentTool0Length;
+    float jobFilamentTool0Volume;
+    long jobFilamentTool1Length;
+    float jobFilamentTool1Volume;
+};
+
+struct BedCallRequest {
+    float tempActualCelsius;
+    float tempOffsetCelsius;
+    float tempTargetCelsius;
+    long tempHistoryTimestamp;
+    float tempHistoryActual;
+};
+} // namespace internal
+
+/**
+ * Each counter is incremented when a fetch changed the corresponding part of OverallState. Consumers remember the
+ * values they have seen and skip work while they are unchanged.
+ */
+struct StateGenerations {
+    // printerState.stateFlags and printerState.printerStateText
+    uint32_t printerState{0};
+    // printerState.temperature
+    uint32_t thermal{0};
+    // printJob
+    uint32_t job{0};
+    // octoprintVersion
+    uint32_t version{0};
+};
+
+struct OverallState {
+    PrinterState printerState;
+    OctoprintVersion octoprintVersion;
+    octoprint::internal::BedCallRequest bedRequest;
+    octoprint::internal::JobRequest printJob;
+    int httpStatusCode{0};
+    RequestOutcome requestOutcome{RequestOutcome::Complete};
+    String httpErrorBody{""};
+    StateGenerations generations;
+};
+
+} // namespace octoprint
@@ -0,0 +1,51 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace octoprint {
+
+/**
+ * Requests that can be issued without further parameters, plus the generic Get and Post.
+ */
+enum class Operation : uint8_t {
+    // GET of a custom api command, see OctoprintClient::sendCustomCommand
+    Get,
+    // POST expecting 204 No Content, see OctoprintClient::requestPost
+    Post,
+    FetchOctoprintVersion,
+    FetchPrinterStatistics,
+    FetchPrintJob,
+    FetchPrinterBed,
+    FetchPrinterSdStatus,
+    // GET of /api/printer with a temperature history of a limit given per request, see
+    // OctoprintClient::fetchTemperatureHistory
+    FetchTemperatureHistory,
+    // GET of a folder of /api/files/local streamed into a FileIndex, see OctoprintClient::fetchFiles
+    FetchFiles,
+    // POST /api/login with the api key, answers the session of the push api
+    Login,
+    // multipart POST of a file, see OctoprintClient::uploadFile
+    Upload,
+    ConnectionConnect,
+    ConnectionDisconnect,
+    ConnectionFakeAck,
+    PrintHeadHome,
+    JobStart,
+    JobCancel,
+    JobRestart,
+    JobPauseResume,
+    JobPause,
+    JobResume,
+    SdInit,
+    SdRefresh,
+    SdRelease
+};
+
+// keep in sync with the last Operation
+constexpr uint8_t operationsCount = static_cast<uint8_t>(Operation::SdRelease) + 1;
+
+} // namespace octoprint
@@ -0,0 +1,135 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "PollScheduler.h"
+
+namespace octoprint {
+
+namespace {
+
+bool isDue(unsigned long now, unsigned long dueMs) {
+    return static_cast<long>(now - dueMs) >= 0;
+}
+
+} // namespace
+
+PollScheduler::PollScheduler(OctoprintClient &client, const PollSchedulerSettings &settings) :
+        client(client),
+        settings(settings),
+        nextPrinterPollMs{millis()},
+        nextJobPollMs{millis()} {}
+
+bool PollScheduler::poll() {
+    if (isInFlight) {
+        client.poll();
+        return isInFlight;
+    }
+    if (client.isBusy()) return false;
+
+    const unsigned long now = millis();
+    Operation operation;
+    if (isDue(now, nextPrinterPollMs)) {
+        operation = hasVersion ? Operation::FetchPrinterStatistics : Operation::FetchOctoprintVersion;
+    } else if (profile != PollProfile::Unreachable && getIntervals(profile).jobMs != 0 && isDue(now, nextJobPollMs)) {
+        operation = Operation::FetchPrintJob;
+    } else {
+        return false;
+    }
+
+    isInFlight = client.request(operation, [this](const RequestStatus &status) { onCompleted(status); });
+    // connecting happens in the first poll, get it going right away
+    if (isInFlight) client.poll();
+    return isInFlight;
+}
+
+PollProfile PollScheduler::getProfile() const {
+    return profile;
+}
+
+bool PollScheduler::isVersionFetched() const {
+    return hasVersion;
+}
+
+void PollScheduler::pollNow() {
+    nextPrinterPollMs = nextJobPollMs = millis();
+}
+
+const PollIntervals &PollScheduler::getIntervals(PollProfile pollProfile) const {
+    switch (pollProfile) {
+        case PollProfile::Active:
+            return settings.active;
+        case PollProfile::Disconnected:
+            return settings.disconnected;
+        default:
+            return settings.idle;
+    }
+}
+
+PollProfile PollScheduler::selectProfile() const {
+    using Flags = PrinterState::OperationalStateFlags;
+    const OverallState &state = client.getState();
+    const PrinterState &printer = state.printerState;
+
+    // OctoPrint answers 409 while no printer is connected, 401/403 to a wrong api key, 5xx when it fails; the flags and
+    // temperatures are those of the last good response then and must not keep the printer active
+    if (state.httpStatusCode < 200 || state.httpStatusCode >= 300) return PollProfile::Disconnected;
+    if (printer.hasStates(static_cast<PrinterState::UnderlyingOperationalStateType>(Flags::ClosedOrError) |
+                          static_cast<PrinterState::UnderlyingOperationalStateType>(Flags::Error))) {
+        return PollProfile::Disconnected;
+    }
+
+    const PrinterState::Thermal &temperature = printer.temperature;
+    bool isHeating = temperature.bedTargetCelsius > 0;
+    for (uint8_t idx = 0; idx < temperature.heatersCount; idx++) {
+        if (temperature.heaters[idx].targetCelsius > 0) isHeating = true;
+    }
+    if (printer.hasState(Flags::Printing) || isHeating) return PollProfile::Active;
+    return PollProfile::Idle;
+}
+
+void PollScheduler::enterProfile(PollProfile pollProfile, unsigned long now) {
+    const bool isBackingOff = pollProfile == PollProfile::Disconnected || pollProfile == PollProfile::Unreachable;
+    if (isBackingOff && pollProfile == profile) {
+        if (backoffShift < settings.maxBackoffShift) backoffShift++;
+    } else {
+        backoffShift = 0;
+    }
+    // e.g. a print just started: the job is due now instead of after the idle interval
+    if (pollProfile != profile) nextJobPollMs = now;
+    profile = pollProfile;
+}
+
+void PollScheduler::onCompleted(const RequestStatus &status) {
+    isInFlight = false;
+    const unsigned long now = millis();
+
+    // a connection closed before any status line counts too, non-blocking clients report refused connects so
+    const bool isUnreachable = status.outcome == RequestOutcome::ConnectionFailed ||
+                               status.outcome == RequestOutcome::Timeout ||
+                               (status.outcome == RequestOutcome::ConnectionClosed && status.httpStatusCode < 0);
+    if (isUnreachable) {
+        enterProfile(PollProfile::Unreachable, now);
+        nextPrinterPollMs = now + (settings.unreachableMs << backoffShift);
+        return;
+    }
+
+    switch (status.operation) {
+        case Operation::FetchOctoprintVersion:
+            hasVersion = status.isSuccess;
+            // the printer state follows right away
+            if (!hasVersion) nextPrinterPollMs = now + getIntervals(profile).printerMs;
+            break;
+        case Operation::FetchPrinterStatistics:
+            enterProfile(selectProfile(), now);
+            nextPrinterPollMs = now + (getIntervals(profile).printerMs << backoffShift);
+            break;
+        case Operation::FetchPrintJob:
+            nextJobPollMs = now + getIntervals(profile).jobMs;
+            break;
+        default:
+            break;
+    }
+}
+
+} // namespace octoprint
@@ -0,0 +1,81 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "OctoprintClient.h"
+
+namespace octoprint {
+
+struct PollIntervals {
+    unsigned long printerMs;
+    // 0 stops polling /api/job
+    unsigned long jobMs;
+};
+
+struct PollSchedulerSettings {
+    // printing or any heater has a target temperature
+    PollIntervals active{1000, 2000};
+    // operational without heating, paused or not known yet
+    PollIntervals idle{10000, 30000};
+    // printer closed or in error, or /api/printer answered with an error status, e.g. 409 or 401; backs off
+    PollIntervals disconnected{10000, 0};
+    // OctoPrint refused the connection or timed out; backs off
+    unsigned long unreachableMs{5000};
+    // a backed off interval grows up to interval << maxBackoffShift
+    uint8_t maxBackoffShift{4};
+};
+
+enum class PollProfile : uint8_t {
+    Active,
+    Idle,
+    Disconnected,
+    Unreachable
+};
+
+/**
+ * Polls one printer with intervals picked from its state: /api/printer and /api/job are fetched often while the
+ * printer prints or heats, rarely while it is idle, and with growing intervals while it is closed or in error, or
+ * OctoPrint answers with an error or is unreachable. /api/version is fetched until it succeeded once.
+ * Call poll() from loop(), requests are issued with the client's non-blocking engine.
+ */
+struct PollScheduler {
+
+    /** @param client must outlive the scheduler, requests of other code are waited for */
+    explicit PollScheduler(OctoprintClient &client, const PollSchedulerSettings &settings = PollSchedulerSettings{});
+
+    /**
+     * Makes progress on the request in flight or starts the next one due.
+     * @return true while a request of the scheduler is in flight
+     */
+    bool poll();
+
+    PollProfile getProfile() const;
+
+    bool isVersionFetched() const;
+
+    /** Polls everything at the next poll(), e.g. after the user sent a command. */
+    void pollNow();
+
+private:
+    OctoprintClient &client;
+    PollSchedulerSettings settings;
+    PollProfile profile{PollProfile::Idle};
+    uint8_t backoffShift{0};
+    bool isInFlight{false};
+    bool hasVersion{false};
+    unsigned long nextPrinterPollMs;
+    unsigned long nextJobPollMs;
+
+    const PollIntervals &getIntervals(PollProfile pollProfile) const;
+
+    PollProfile selectProfile() const;
+
+    /** Switches to the profile, backing off if it keeps a backing off profile. */
+    void enterProfile(PollProfile pollProfile, unsigned long now);
+
+    void onCompleted(const RequestStatus &status);
+};
+
+} // namespace octoprint
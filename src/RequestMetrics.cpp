@@ -0,0 +1,112 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "RequestMetrics.h"
+
+namespace octoprint {
+
+constexpr uint32_t LatencyHistogram::bucketUpperBoundsUs[];
+
+void LatencyHistogram::record(unsigned long durationUs) {
+    uint8_t bucket = 0;
+    while (bucket < bucketsCount - 1 && durationUs > bucketUpperBoundsUs[bucket]) bucket++;
+    counts[bucket]++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (uint8_t bucket = 0; bucket < bucketsCount; bucket++) counts[bucket] += other.counts[bucket];
+}
+
+uint32_t LatencyHistogram::getCount() const {
+    uint32_t count = 0;
+    for (uint32_t bucketCount : counts) count += bucketCount;
+    return count;
+}
+
+uint32_t LatencyHistogram::getPercentileUs(uint8_t percent) const {
+    const uint32_t count = getCount();
+    if (count == 0) return 0;
+
+    // rank of the sample at the percentile, rounded up
+    const uint64_t rank = (static_cast<uint64_t>(count) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint8_t bucket = 0; bucket < bucketsCount - 1; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank && seen > 0) return bucketUpperBoundsUs[bucket];
+    }
+    return UINT32_MAX;
+}
+
+void EndpointMetrics::merge(const EndpointMetrics &other) {
+    requests += other.requests;
+    httpErrors += other.httpErrors;
+    timeouts += other.timeouts;
+    truncations += other.truncations;
+    connectionFailures += other.connectionFailures;
+    incompleteResponses += other.incompleteResponses;
+    connects += other.connects;
+    connectUsTotal += other.connectUsTotal;
+    if (other.connectUsMax > connectUsMax) connectUsMax = other.connectUsMax;
+    firstBytes += other.firstBytes;
+    firstByteUsTotal += other.firstByteUsTotal;
+    if (other.firstByteUsMax > firstByteUsMax) firstByteUsMax = other.firstByteUsMax;
+    bytesReceived += other.bytesReceived;
+    latency.merge(other.latency);
+}
+
+void RequestMetrics::record(Operation operation, const RequestSample &sample) {
+    EndpointMetrics &endpoint = endpoints[static_cast<uint8_t>(operation)];
+
+    endpoint.requests++;
+    const bool isSuccessCode = sample.httpStatusCode >= 200 && sample.httpStatusCode < 300;
+    if (sample.httpStatusCode >= 0 && !isSuccessCode && sample.httpStatusCode != 304) endpoint.httpErrors++;
+    switch (sample.outcome) {
+        case RequestOutcome::Timeout:
+            endpoint.timeouts++;
+            break;
+        case RequestOutcome::Truncated:
+            endpoint.truncations++;
+            break;
+        case RequestOutcome::ConnectionFailed:
+            endpoint.connectionFailures++;
+            break;
+        case RequestOutcome::ConnectionClosed:
+        case RequestOutcome::Malformed:
+        case RequestOutcome::SourceFailed:
+            endpoint.incompleteResponses++;
+            break;
+        case RequestOutcome::InProgress:
+        case RequestOutcome::Complete:
+            break;
+    }
+
+    if (sample.isConnected) {
+        endpoint.connects++;
+        endpoint.connectUsTotal += sample.connectUs;
+        if (sample.connectUs > endpoint.connectUsMax) endpoint.connectUsMax = sample.connectUs;
+    }
+    if (sample.hasFirstByte) {
+        endpoint.firstBytes++;
+        endpoint.firstByteUsTotal += sample.firstByteUs;
+        if (sample.firstByteUs > endpoint.firstByteUsMax) endpoint.firstByteUsMax = sample.firstByteUs;
+    }
+    endpoint.bytesReceived += sample.bytesReceived;
+    endpoint.latency.record(sample.latencyUs);
+}
+
+void RequestMetrics::reset() {
+    for (EndpointMetrics &endpoint : endpoints) endpoint = EndpointMetrics{};
+}
+
+const EndpointMetrics &RequestMetrics::get(Operation operation) const {
+    return endpoints[static_cast<uint8_t>(operation)];
+}
+
+EndpointMetrics RequestMetrics::getTotal() const {
+    EndpointMetrics total;
+    for (const EndpointMetrics &endpoint : endpoints) total.merge(endpoint);
+    return total;
+}
+
+} // namespace octoprint
@@ -0,0 +1,101 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "HttpResponseParser.h"
+#include "Operation.h"
+
+namespace octoprint {
+
+/**
+ * Latency distribution in fixed buckets, recording is a few comparisons and an increment.
+ */
+struct LatencyHistogram {
+    static constexpr uint8_t bucketsCount = 14;
+    // upper bounds in microseconds, the last bucket collects everything above the last bound
+    static constexpr uint32_t bucketUpperBoundsUs[bucketsCount - 1] = {
+            250, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000, 3000000};
+
+    uint32_t counts[bucketsCount]{};
+
+    void record(unsigned long durationUs);
+
+    void merge(const LatencyHistogram &other);
+
+    uint32_t getCount() const;
+
+    /**
+     * @return upper bound of the bucket the percentile falls into, UINT32_MAX for the last bucket and 0 if empty
+     */
+    uint32_t getPercentileUs(uint8_t percent) const;
+};
+
+/**
+ * Counters of one endpoint. Durations are measured from the start of the request.
+ */
+struct EndpointMetrics {
+    uint32_t requests{0};
+    // responses with a status code outside 2xx, except 304 Not Modified answering a conditional request
+    uint32_t httpErrors{0};
+    uint32_t timeouts{0};
+    uint32_t truncations{0};
+    uint32_t connectionFailures{0};
+    // closed by the server or malformed before the response was complete, or the request body's source failed
+    uint32_t incompleteResponses{0};
+
+    // time spent in Client::connect(), for requests which established a new connection
+    uint32_t connects{0};
+    uint64_t connectUsTotal{0};
+    uint32_t connectUsMax{0};
+
+    // time until the first response byte arrived, for requests which received one
+    uint32_t firstBytes{0};
+    uint64_t firstByteUsTotal{0};
+    uint32_t firstByteUsMax{0};
+
+    uint64_t bytesReceived{0};
+    LatencyHistogram latency;
+
+    void merge(const EndpointMetrics &other);
+};
+
+/**
+ * What OctoprintClient reports per finished request.
+ */
+struct RequestSample {
+    RequestOutcome outcome{RequestOutcome::Complete};
+    // -1 if no status line was received
+    int httpStatusCode{-1};
+    // a new connection was established, connectUs is the time it took
+    bool isConnected{false};
+    unsigned long connectUs{0};
+    bool hasFirstByte{false};
+    unsigned long firstByteUs{0};
+    unsigned long latencyUs{0};
+    unsigned long bytesReceived{0};
+};
+
+/**
+ * Request metrics per Operation, see OctoprintClient::setMetrics().
+ * Custom GET and POST requests are accounted to Operation::Get and Operation::Post.
+ * The struct is plain data: copying it is the snapshot, e.g. to export deltas copy it and reset() it.
+ */
+struct RequestMetrics {
+
+    void record(Operation operation, const RequestSample &sample);
+
+    void reset();
+
+    const EndpointMetrics &get(Operation operation) const;
+
+    /** @return all endpoints merged */
+    EndpointMetrics getTotal() const;
+
+private:
+    EndpointMetrics endpoints[operationsCount];
+};
+
+} // namespace octoprint
@@ -0,0 +1,65 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace octoprint {
+
+/**
+ * Fixed capacity FIFO, pushing into a full buffer overwrites the oldest element.
+ * @tparam capacity maximum number of elements, storage is allocated in place
+ */
+template<typename T, size_t capacity>
+struct RingBuffer {
+    static_assert(capacity > 0, "capacity must not be 0");
+
+    void push(const T &value) {
+        items[(first + count) % capacity] = value;
+        if (count < capacity) {
+            count++;
+        } else {
+            first = (first + 1) % capacity;
+        }
+    }
+
+    void clear() {
+        first = 0;
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool isEmpty() const {
+        return count == 0;
+    }
+
+    bool isFull() const {
+        return count == capacity;
+    }
+
+    static constexpr size_t getCapacity() {
+        return capacity;
+    }
+
+    /** @param index 0 is the oldest element */
+    const T &operator[](size_t index) const {
+        return items[(first + index) % capacity];
+    }
+
+    /** @return the most recently pushed element, the buffer must not be empty */
+    const T &newest() const {
+        return (*this)[count - 1];
+    }
+
+private:
+    T items[capacity];
+    size_t first{0};
+    size_t count{0};
+};
+
+} // namespace octoprint
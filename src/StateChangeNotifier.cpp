@@ -0,0 +1,114 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "StateChangeNotifier.h"
+
+namespace octoprint {
+namespace internal {
+
+namespace {
+
+bool exceeds(float current, float reported, float deadband) {
+    const float difference = current > reported ? current - reported : reported - current;
+    return difference > deadband;
+}
+
+bool isTemperatureChanged(const PrinterState::Thermal &current, const PrinterState::Thermal &reported,
+                          float deadband) {
+    // a heater being discovered counts, slots keep their heater so they compare pairwise
+    if (current.heatersCount != reported.heatersCount) return true;
+    for (uint8_t idx = 0; idx < current.heatersCount; idx++) {
+        const PrinterState::Heater &heater = current.heaters[idx];
+        const PrinterState::Heater &reportedHeater = reported.heaters[idx];
+        // targets are set values, any change counts
+        if (heater.targetCelsius != reportedHeater.targetCelsius ||
+            exceeds(heater.currentCelsius, reportedHeater.currentCelsius, deadband)) {
+            return true;
+        }
+    }
+    // e.g. /api/printer/bed sets the bed fields only
+    return current.bedTargetCelsius != reported.bedTargetCelsius ||
+           exceeds(current.bedCurrentCelsius, reported.bedCurrentCelsius, deadband);
+}
+
+bool hasActiveJob(const PrinterState &printerState) {
+    // OctoPrint reports printing while starting, resuming and finishing, paused while pausing
+    return printerState.hasStates(
+            static_cast<PrinterState::UnderlyingOperationalStateType>(PrinterState::OperationalStateFlags::Printing) |
+            static_cast<PrinterState::UnderlyingOperationalStateType>(PrinterState::OperationalStateFlags::Paused));
+}
+
+} // namespace
+
+void StateChangeNotifier::setStateFlagsCallback(StateFlagsCallback callback) {
+    stateFlagsCallback = std::move(callback);
+}
+
+void StateChangeNotifier::setTemperatureCallback(float deadbandCelsius, TemperatureCallback callback) {
+    this->deadbandCelsius = deadbandCelsius;
+    temperatureCallback = std::move(callback);
+    hasReportedTemperature = false;
+}
+
+void StateChangeNotifier::setJobStartedCallback(JobCallback callback) {
+    jobStartedCallback = std::move(callback);
+}
+
+void StateChangeNotifier::setJobFinishedCallback(JobCallback callback) {
+    jobFinishedCallback = std::move(callback);
+}
+
+void StateChangeNotifier::setProgressCallback(float stepPercent, JobCallback callback) {
+    progressStepPercent = stepPercent > 0 ? stepPercent : 1.0f;
+    progressCallback = std::move(callback);
+    reportedProgressStep = -1;
+}
+
+void StateChangeNotifier::notify(const OverallState &state, const StateGenerations &previous) {
+    if (state.generations.printerState != previous.printerState &&
+        state.printerState.stateFlags != reportedFlags) {
+        const PrinterState::OperationalStateFlags previousFlags = reportedFlags;
+        reportedFlags = state.printerState.stateFlags;
+        if (stateFlagsCallback) stateFlagsCallback(previousFlags, reportedFlags);
+    }
+    if (state.generations.thermal != previous.thermal) notifyTemperature(state.printerState.temperature);
+    if (state.generations.printerState != previous.printerState || state.generations.job != previous.job) {
+        notifyJob(state);
+    }
+}
+
+void StateChangeNotifier::notifyTemperature(const PrinterState::Thermal &temperature) {
+    if (hasReportedTemperature && !isTemperatureChanged(temperature, reportedTemperature, deadbandCelsius)) return;
+
+    // the reference point only moves when reported, slow drifts add up until they exceed the deadband
+    reportedTemperature = temperature;
+    hasReportedTemperature = true;
+    if (temperatureCallback) temperatureCallback(temperature);
+}
+
+void StateChangeNotifier::notifyJob(const OverallState &state) {
+    const JobRequest &job = state.printJob;
+    const bool isActive = hasActiveJob(state.printerState);
+    if (isActive && !isJobActive) {
+        isJobActive = true;
+        reportedProgressStep = -1;
+        if (jobStartedCallback) jobStartedCallback(job);
+    }
+
+    if (isActive) {
+        const long step = static_cast<long>(job.progressCompletion / progressStepPercent);
+        if (step != reportedProgressStep) {
+            reportedProgressStep = step;
+            if (progressCallback) progressCallback(job);
+        }
+    }
+
+    if (!isActive && isJobActive) {
+        isJobActive = false;
+        if (jobFinishedCallback) jobFinishedCallback(job);
+    }
+}
+
+} // namespace internal
+} // namespace octoprint
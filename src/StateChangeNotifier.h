@@ -0,0 +1,63 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include "OctoprintState.h"
+
+namespace octoprint {
+
+using StateFlagsCallback = std::function<void(PrinterState::OperationalStateFlags previous,
+                                              PrinterState::OperationalStateFlags current)>;
+using TemperatureCallback = std::function<void(const PrinterState::Thermal &temperature)>;
+using JobCallback = std::function<void(const internal::JobRequest &job)>;
+
+namespace internal {
+
+/**
+ * Turns the changes a completed fetch made to OverallState into callbacks.
+ * Only sections whose generation moved are looked at, so a poll without changes costs a few comparisons.
+ */
+struct StateChangeNotifier {
+
+    void setStateFlagsCallback(StateFlagsCallback callback);
+
+    void setTemperatureCallback(float deadbandCelsius, TemperatureCallback callback);
+
+    void setJobStartedCallback(JobCallback callback);
+
+    void setJobFinishedCallback(JobCallback callback);
+
+    void setProgressCallback(float stepPercent, JobCallback callback);
+
+    /**
+     * @param previous generations before the fetch was applied
+     */
+    void notify(const OverallState &state, const StateGenerations &previous);
+
+private:
+    StateFlagsCallback stateFlagsCallback;
+    TemperatureCallback temperatureCallback;
+    JobCallback jobStartedCallback;
+    JobCallback jobFinishedCallback;
+    JobCallback progressCallback;
+
+    float deadbandCelsius{1.0f};
+    float progressStepPercent{10.0f};
+
+    PrinterState::OperationalStateFlags reportedFlags{PrinterState::OperationalStateFlags::Undefined};
+    bool hasReportedTemperature{false};
+    PrinterState::Thermal reportedTemperature{};
+    bool isJobActive{false};
+    long reportedProgressStep{-1};
+
+    void notifyTemperature(const PrinterState::Thermal &temperature);
+
+    void notifyJob(const OverallState &state);
+};
+
+} // namespace internal
+} // namespace octoprint
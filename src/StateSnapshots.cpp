@@ -0,0 +1,37 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "StateSnapshots.h"
+
+namespace octoprint {
+
+bool StateSnapshots::publish(const OverallState &state) {
+    const uint8_t back = 1 - published.load();
+    // a reader that registered before the previous publication may still be copying it
+    if (readers[back].load() != 0) return false;
+    buffers[back] = state;
+    published.store(back);
+    return true;
+}
+
+void StateSnapshots::read(OverallState &snapshot) const {
+    uint8_t idx = published.load();
+    readers[idx].fetch_add(1);
+    // the buffer may have become the back buffer and be filled before the reader registered
+    while (published.load() != idx) {
+        readers[idx].fetch_sub(1);
+        idx = published.load();
+        readers[idx].fetch_add(1);
+    }
+    snapshot = buffers[idx];
+    readers[idx].fetch_sub(1);
+}
+
+OverallState StateSnapshots::read() const {
+    OverallState snapshot;
+    read(snapshot);
+    return snapshot;
+}
+
+} // namespace octoprint
@@ -0,0 +1,47 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "OctoprintState.h"
+
+namespace octoprint {
+
+/**
+ * Hands consistent copies of OverallState from the network task to readers on other cores or threads.
+ * The client fills the buffer no reader is on and publishes it by switching an index; neither side takes a lock.
+ * A reader that starts copying a buffer registers on it first, the writer does not touch a buffer with readers but
+ * skips the publication and repeats it later instead of waiting.
+ *
+ *     octoprint::StateSnapshots snapshots;
+ *     printer.setStateSnapshots(&snapshots);
+ *     // on the other core
+ *     const octoprint::OverallState state = snapshots.read();
+ */
+struct StateSnapshots {
+
+    /**
+     * Called by the client only, there is a single writer.
+     * @return false if a reader still copies the buffer to be filled, nothing is published then
+     */
+    bool publish(const OverallState &state);
+
+    /**
+     * Copies the latest published state, from any core or thread. Never waits for the writer; it only starts over if
+     * a publication happened before it registered on the buffer.
+     */
+    void read(OverallState &snapshot) const;
+
+    /** @return a copy of the latest published state, prefer read(OverallState&) to reuse the Strings' memory */
+    OverallState read() const;
+
+private:
+    OverallState buffers[2];
+    std::atomic<uint8_t> published{0};
+    mutable std::atomic<uint8_t> readers[2]{{0}, {0}};
+};
+
+} // namespace octoprint
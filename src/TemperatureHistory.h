@@ -0,0 +1,144 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "RingBuffer.h"
+
+namespace octoprint {
+
+/**
+ * One reading of the heaters the history tracks. The channels are fixed to the bed, tool0 and tool1 to keep samples
+ * small and preallocated; unlike PrinterState::Thermal, which keys heaters by OctoPrint's name, a chamber or tools
+ * beyond tool1 are not recorded and a heater OctoPrint did not report reads as 0.
+ */
+struct TemperatureSample {
+    enum Channel : uint8_t {
+        BedActual,
+        BedTarget,
+        Tool0Actual,
+        Tool0Target,
+        Tool1Actual,
+        Tool1Target,
+        ChannelsCount
+    };
+
+    // seconds as reported by OctoPrint (unix time)
+    uint32_t timestamp{0};
+    float values[ChannelsCount]{};
+};
+
+/**
+ * Minimum, maximum and mean of consecutive samples.
+ */
+struct TemperatureAggregate {
+    uint32_t firstTimestamp{0};
+    uint32_t lastTimestamp{0};
+    // number of raw samples covered
+    uint16_t count{0};
+    float minimum[TemperatureSample::ChannelsCount]{};
+    float maximum[TemperatureSample::ChannelsCount]{};
+    float mean[TemperatureSample::ChannelsCount]{};
+};
+
+/**
+ * Receives the temperature samples OctoprintClient fetches, see OctoprintClient::setTemperatureHistory().
+ */
+struct TemperatureSampleSink {
+    virtual ~TemperatureSampleSink() = default;
+
+    /** @return false if the sample was not taken, e.g. because it is not newer than the last one */
+    virtual bool add(const TemperatureSample &sample) = 0;
+};
+
+/**
+ * Temperature time series in preallocated ring buffers: the latest raw samples plus downsampling tiers.
+ * Tier 0 aggregates samplesPerAggregate raw samples, each further tier aggregates samplesPerAggregate aggregates of
+ * the tier below, so with the defaults and a 2 s poll interval tier 0 covers 32 x 20 s and tier 1 32 x 200 s.
+ * Samples not newer than the newest one are dropped, overlapping history backfills therefore add nothing twice.
+ *
+ * @tparam rawCapacity number of raw samples kept
+ * @tparam tierCapacity number of aggregates kept per tier
+ * @tparam tiersCount number of downsampling tiers
+ * @tparam samplesPerAggregate downsampling factor between adjacent tiers
+ */
+template<size_t rawCapacity, size_t tierCapacity = 32, uint8_t tiersCount = 2, uint8_t samplesPerAggregate = 10>
+struct TemperatureHistory : public TemperatureSampleSink {
+    static_assert(samplesPerAggregate > 1, "aggregating a single sample does not downsample");
+
+    bool add(const TemperatureSample &sample) override {
+        if (!samples.isEmpty() && sample.timestamp <= samples.newest().timestamp) return false;
+
+        samples.push(sample);
+        TemperatureAggregate single;
+        single.firstTimestamp = single.lastTimestamp = sample.timestamp;
+        single.count = 1;
+        for (uint8_t channel = 0; channel < TemperatureSample::ChannelsCount; channel++) {
+            single.minimum[channel] = single.maximum[channel] = single.mean[channel] = sample.values[channel];
+        }
+        aggregate(0, single);
+        return true;
+    }
+
+    void clear() {
+        samples.clear();
+        for (uint8_t tier = 0; tier < tiersCount; tier++) {
+            tiers[tier].clear();
+            pending[tier] = TemperatureAggregate{};
+            pendingInputs[tier] = 0;
+        }
+    }
+
+    /** @return raw samples, oldest first */
+    const RingBuffer<TemperatureSample, rawCapacity> &getSamples() const {
+        return samples;
+    }
+
+    /** @return aggregates of a tier, oldest first */
+    const RingBuffer<TemperatureAggregate, tierCapacity> &getTier(uint8_t tier) const {
+        return tiers[tier];
+    }
+
+    static constexpr uint8_t getTiersCount() {
+        return tiersCount;
+    }
+
+private:
+    RingBuffer<TemperatureSample, rawCapacity> samples;
+    RingBuffer<TemperatureAggregate, tierCapacity> tiers[tiersCount];
+    // aggregate under construction per tier
+    TemperatureAggregate pending[tiersCount];
+    uint8_t pendingInputs[tiersCount]{};
+
+    void aggregate(uint8_t tier, const TemperatureAggregate &input) {
+        if (tier >= tiersCount) return;
+
+        merge(pending[tier], input);
+        if (++pendingInputs[tier] < samplesPerAggregate) return;
+
+        const TemperatureAggregate completed = pending[tier];
+        tiers[tier].push(completed);
+        pending[tier] = TemperatureAggregate{};
+        pendingInputs[tier] = 0;
+        aggregate(tier + 1, completed);
+    }
+
+    static void merge(TemperatureAggregate &into, const TemperatureAggregate &input) {
+        if (into.count == 0) {
+            into = input;
+            return;
+        }
+        const float total = static_cast<float>(into.count) + input.count;
+        for (uint8_t channel = 0; channel < TemperatureSample::ChannelsCount; channel++) {
+            if (input.minimum[channel] < into.minimum[channel]) into.minimum[channel] = input.minimum[channel];
+            if (input.maximum[channel] > into.maximum[channel]) into.maximum[channel] = input.maximum[channel];
+            into.mean[channel] = (into.mean[channel] * into.count + input.mean[channel] * input.count) / total;
+        }
+        into.lastTimestamp = input.lastTimestamp;
+        into.count += input.count;
+    }
+};
+
+} // namespace octoprint
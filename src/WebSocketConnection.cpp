@@ -0,0 +1,389 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "WebSocketConnection.h"
+
+namespace octoprint {
+namespace internal {
+
+namespace {
+
+constexpr const char *webSocketGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+constexpr uint8_t maxHandshakeLineLength = 127;
+
+uint32_t rotateLeft(uint32_t value, uint8_t bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+/**
+ * SHA-1, only needed to check the handshake. The input is at most a few blocks long.
+ */
+void sha1(const uint8_t *data, size_t length, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    const uint64_t bitLength = static_cast<uint64_t>(length) * 8;
+    // message, 0x80, zero padding, 64 bit length
+    const size_t paddedLength = ((length + 8) / 64 + 1) * 64;
+
+    for (size_t blockBegin = 0; blockBegin < paddedLength; blockBegin += 64) {
+        uint32_t w[80];
+        for (uint8_t idx = 0; idx < 64; idx++) {
+            const size_t position = blockBegin + idx;
+            uint8_t byte = 0;
+            if (position < length) {
+                byte = data[position];
+            } else if (position == length) {
+                byte = 0x80;
+            } else if (position >= paddedLength - 8) {
+                byte = static_cast<uint8_t>(bitLength >> ((paddedLength - 1 - position) * 8));
+            }
+            if (idx % 4 == 0) w[idx / 4] = 0;
+            w[idx / 4] |= static_cast<uint32_t>(byte) << ((3 - idx % 4) * 8);
+        }
+        for (uint8_t idx = 16; idx < 80; idx++) {
+            w[idx] = rotateLeft(w[idx - 3] ^ w[idx - 8] ^ w[idx - 14] ^ w[idx - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (uint8_t idx = 0; idx < 80; idx++) {
+            uint32_t f, k;
+            if (idx < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            } else if (idx < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (idx < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            const uint32_t temp = rotateLeft(a, 5) + f + e + k + w[idx];
+            e = d;
+            d = c;
+            c = rotateLeft(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    for (uint8_t idx = 0; idx < 20; idx++) {
+        digest[idx] = static_cast<uint8_t>(h[idx / 4] >> ((3 - idx % 4) * 8));
+    }
+}
+
+/**
+ * @param text receives ((length + 2) / 3) * 4 characters plus the terminating null
+ */
+void encodeBase64(const uint8_t *data, size_t length, char *text) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (size_t idx = 0; idx < length; idx += 3) {
+        const uint32_t group = (static_cast<uint32_t>(data[idx]) << 16) |
+                               ((idx + 1 < length) ? static_cast<uint32_t>(data[idx + 1]) << 8 : 0) |
+                               ((idx + 2 < length) ? data[idx + 2] : 0);
+        *text++ = alphabet[(group >> 18) & 0x3f];
+        *text++ = alphabet[(group >> 12) & 0x3f];
+        *text++ = (idx + 1 < length) ? alphabet[(group >> 6) & 0x3f] : '=';
+        *text++ = (idx + 2 < length) ? alphabet[group & 0x3f] : '=';
+    }
+    *text = '\0';
+}
+
+bool startsWithIgnoringCase(const char *text, const char *prefix) {
+    return strncasecmp(text, prefix, strlen(prefix)) == 0;
+}
+
+} // namespace
+
+void computeWebSocketAccept(const char *key, char accept[29]) {
+    char input[96];
+    snprintf(input, sizeof(input), "%s%s", key, webSocketGuid);
+    uint8_t digest[20];
+    sha1(reinterpret_cast<const uint8_t *>(input), strlen(input), digest);
+    encodeBase64(digest, sizeof(digest), accept);
+}
+
+WebSocketConnection::WebSocketConnection(Client &client, unsigned long timeoutMs) :
+        client(client),
+        timeoutMs{timeoutMs} {
+    // read() blocks on its own deadline, Stream's per byte timeout must not add to it
+    setTimeout(0);
+}
+
+bool WebSocketConnection::handshake(const String &host, const char *path) {
+    uint8_t nonce[16];
+    for (uint8_t &byte : nonce) byte = static_cast<uint8_t>(random(256));
+    char key[25];
+    encodeBase64(nonce, sizeof(nonce), key);
+    char expectedAccept[29];
+    computeWebSocketAccept(key, expectedAccept);
+
+    isOpened = false;
+    isInMessage = false;
+    payloadLeft = 0;
+    peeked = -1;
+    startMs = millis();
+
+    client.print("GET ");
+    client.print(path);
+    client.print(" HTTP/1.1\r\nHost: ");
+    client.print(host);
+    client.print("\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Version: 13\r\nSec-WebSocket-Key: ");
+    client.print(key);
+    client.print("\r\n\r\n");
+
+    // the answer is read bytewise, frames may follow the header section right away
+    bool isStatusLine = true;
+    bool isSwitching = false;
+    bool isAccepted = false;
+    char line[maxHandshakeLineLength + 1];
+    uint8_t lineLength = 0;
+    for (;;) {
+        const int c = readByte();
+        if (c < 0) return false;
+        if (c == '\r') continue;
+        if (c != '\n') {
+            if (lineLength < maxHandshakeLineLength) line[lineLength++] = static_cast<char>(c);
+            continue;
+        }
+        line[lineLength] = '\0';
+        if (lineLength == 0) break;
+        lineLength = 0;
+
+        if (isStatusLine) {
+            // HTTP/1.1 101 Switching Protocols
+            const char *status = strchr(line, ' ');
+            isSwitching = status != nullptr && atoi(status + 1) == 101;
+            isStatusLine = false;
+        } else if (startsWithIgnoringCase(line, "Sec-WebSocket-Accept:")) {
+            const char *value = line + strlen("Sec-WebSocket-Accept:");
+            while (*value == ' ') value++;
+            isAccepted = strcmp(value, expectedAccept) == 0;
+        }
+    }
+    isOpened = isSwitching && isAccepted;
+    return isOpened;
+}
+
+bool WebSocketConnection::isOpen() {
+    if (isOpened && !client.connected()) isOpened = false;
+    return isOpened;
+}
+
+void WebSocketConnection::close() {
+    if (isOpened) {
+        // status 1000, normal closure
+        const uint8_t status[] = {0x03, 0xe8};
+        sendFrame(Close, status, sizeof(status));
+    }
+    abort();
+}
+
+bool WebSocketConnection::sendText(const char *text) {
+    return isOpened && sendFrame(Text, reinterpret_cast<const uint8_t *>(text), strlen(text));
+}
+
+bool WebSocketConnection::beginMessage() {
+    if (isInMessage) {
+        while (read() >= 0) {}
+    }
+    while (isOpen() && client.available() > 0) {
+        startMs = millis();
+        uint8_t opcode;
+        if (!readFrameHeader(opcode)) return false;
+        if (opcode == Text) {
+            isInMessage = true;
+            return true;
+        }
+        // control frames are handled already, binary messages and stray continuations are not of interest
+        skipPayload();
+    }
+    return false;
+}
+
+int WebSocketConnection::available() {
+    if (peeked >= 0) return 1;
+    if (!isInMessage || payloadLeft == 0) return 0;
+    const int received = client.available();
+    if (received <= 0) return 0;
+    return (payloadLeft < static_cast<uint64_t>(received)) ? static_cast<int>(payloadLeft) : received;
+}
+
+int WebSocketConnection::read() {
+    if (peeked >= 0) {
+        const int c = peeked;
+        peeked = -1;
+        return c;
+    }
+    if (!isInMessage) return -1;
+
+    while (payloadLeft == 0) {
+        if (isFinalFrame) {
+            isInMessage = false;
+            return -1;
+        }
+        uint8_t opcode;
+        if (!readFrameHeader(opcode)) return -1;
+        if (opcode != Continuation) {
+            // control frames were handled, anything else interrupting a fragmented message is a protocol error
+            if (opcode == Ping || opcode == Pong) continue;
+            abort();
+            return -1;
+        }
+    }
+
+    const int c = readByte();
+    if (c < 0) {
+        abort();
+        return -1;
+    }
+    payloadLeft--;
+    if (!isMasked) return c;
+    const uint8_t unmasked = static_cast<uint8_t>(c) ^ mask[maskIndex];
+    maskIndex = (maskIndex + 1) % 4;
+    return unmasked;
+}
+
+int WebSocketConnection::peek() {
+    if (peeked < 0) peeked = read();
+    return peeked;
+}
+
+int WebSocketConnection::readByte() {
+    while (!client.available()) {
+        if (!client.connected() || millis() - startMs >= timeoutMs) return -1;
+        yield();
+    }
+    return client.read();
+}
+
+bool WebSocketConnection::readFrameHeader(uint8_t &opcode) {
+    const int first = readByte();
+    const int second = readByte();
+    if (first < 0 || second < 0) {
+        abort();
+        return false;
+    }
+
+    uint64_t length = static_cast<uint8_t>(second) & 0x7f;
+    const uint8_t lengthBytes = (length == 126) ? 2 : (length == 127) ? 8 : 0;
+    if (lengthBytes > 0) length = 0;
+    for (uint8_t idx = 0; idx < lengthBytes; idx++) {
+        const int c = readByte();
+        if (c < 0) {
+            abort();
+            return false;
+        }
+        length = (length << 8) | static_cast<uint8_t>(c);
+    }
+
+    // servers do not mask their frames, tolerated nevertheless
+    isMasked = (second & 0x80) != 0;
+    maskIndex = 0;
+    for (uint8_t idx = 0; isMasked && idx < sizeof(mask); idx++) {
+        const int c = readByte();
+        if (c < 0) {
+            abort();
+            return false;
+        }
+        mask[idx] = static_cast<uint8_t>(c);
+    }
+
+    opcode = static_cast<uint8_t>(first) & 0x0f;
+    payloadLeft = length;
+    if (opcode >= Close) return handleControlFrame(opcode);
+    isFinalFrame = (first & 0x80) != 0;
+    return true;
+}
+
+bool WebSocketConnection::handleControlFrame(uint8_t opcode) {
+    if (payloadLeft > maxControlPayloadLength) {
+        abort();
+        return false;
+    }
+    uint8_t payload[maxControlPayloadLength];
+    const size_t length = static_cast<size_t>(payloadLeft);
+    for (size_t idx = 0; idx < length; idx++) {
+        const int c = readByte();
+        if (c < 0) {
+            abort();
+            return false;
+        }
+        payload[idx] = static_cast<uint8_t>(c) ^ (isMasked ? mask[idx % 4] : 0);
+    }
+    payloadLeft = 0;
+
+    switch (opcode) {
+        case Ping:
+            return sendFrame(Pong, payload, length);
+        case Close:
+            // echo the status code, then the server closes the TCP connection
+            sendFrame(Close, payload, length < 2 ? length : 2);
+            abort();
+            return false;
+        default:
+            return true;
+    }
+}
+
+void WebSocketConnection::skipPayload() {
+    while (payloadLeft > 0) {
+        if (readByte() < 0) {
+            abort();
+            return;
+        }
+        payloadLeft--;
+    }
+}
+
+bool WebSocketConnection::sendFrame(uint8_t opcode, const uint8_t *payload, size_t length) {
+    // header and masked payload are collected so that small messages leave in a single write
+    uint8_t buffer[128];
+    size_t used = 0;
+    buffer[used++] = 0x80 | opcode;
+    if (length < 126) {
+        buffer[used++] = 0x80 | static_cast<uint8_t>(length);
+    } else if (length <= 0xffff) {
+        buffer[used++] = 0x80 | 126;
+        buffer[used++] = static_cast<uint8_t>(length >> 8);
+        buffer[used++] = static_cast<uint8_t>(length);
+    } else {
+        buffer[used++] = 0x80 | 127;
+        for (int8_t shift = 56; shift >= 0; shift -= 8) {
+            buffer[used++] = static_cast<uint8_t>(static_cast<uint64_t>(length) >> shift);
+        }
+    }
+    // clients must mask every frame
+    uint8_t frameMask[4];
+    for (uint8_t &byte : frameMask) {
+        byte = static_cast<uint8_t>(random(256));
+        buffer[used++] = byte;
+    }
+
+    for (size_t idx = 0; idx < length; idx++) {
+        if (used == sizeof(buffer)) {
+            if (client.write(buffer, used) != used) return false;
+            used = 0;
+        }
+        buffer[used++] = payload[idx] ^ frameMask[idx % 4];
+    }
+    return client.write(buffer, used) == used;
+}
+
+void WebSocketConnection::abort() {
+    isOpened = false;
+    isInMessage = false;
+    payloadLeft = 0;
+    peeked = -1;
+    client.stop();
+}
+
+} // namespace internal
+} // namespace octoprint
@@ -0,0 +1,108 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <Client.h>
+
+namespace octoprint {
+namespace internal {
+
+/**
+ * Client side of a WebSocket (RFC 6455) on a connected Client.
+ *
+ * Text messages are not buffered: once beginMessage() reported one, its payload is available through the Stream
+ * interface, across continuation frames, until read() returns -1. Control frames are answered as they arrive, pings
+ * with a pong and a close with a close. Binary messages are skipped.
+ * Reading a message blocks on the timeout measured from beginMessage().
+ */
+struct WebSocketConnection : public Stream {
+
+    WebSocketConnection(Client &client, unsigned long timeoutMs);
+
+    /**
+     * Sends the opening handshake on the connected client and validates the server's answer.
+     * @param host value of the Host header
+     */
+    bool handshake(const String &host, const char *path);
+
+    bool isOpen();
+
+    /** Sends a close frame if the connection is open and stops the client. */
+    void close();
+
+    bool sendText(const char *text);
+
+    /**
+     * Handles the frames that arrived so far without blocking, a started frame is read completely though.
+     * Skips what is left of the previous message.
+     * @return true if a text message begins, read its payload through the Stream interface
+     */
+    bool beginMessage();
+
+    /** @return number of payload bytes of the current message readily available without blocking */
+    int available() override;
+
+    /** Blocks until the next payload byte arrived. @return -1 at the end of the message, on timeout or close */
+    int read() override;
+
+    int peek() override;
+
+    size_t write(uint8_t) override {
+        return 0;
+    }
+
+private:
+    enum Opcode : uint8_t {
+        Continuation = 0x0,
+        Text = 0x1,
+        Binary = 0x2,
+        Close = 0x8,
+        Ping = 0x9,
+        Pong = 0xa
+    };
+
+    static constexpr uint8_t maxControlPayloadLength = 125;
+
+    Client &client;
+    unsigned long timeoutMs;
+    unsigned long startMs{0};
+    bool isOpened{false};
+
+    // the frame currently read
+    uint64_t payloadLeft{0};
+    bool isFinalFrame{true};
+    uint8_t mask[4]{};
+    bool isMasked{false};
+    uint8_t maskIndex{0};
+
+    bool isInMessage{false};
+    int peeked{-1};
+
+    /** Blocks until a byte arrived. @return -1 on timeout or if the connection closed */
+    int readByte();
+
+    /** Reads the header of the next frame and handles it if it is a control frame. @return false on error */
+    bool readFrameHeader(uint8_t &opcode);
+
+    /** Consumes a control frame's payload and answers it. @return false if the connection is closing */
+    bool handleControlFrame(uint8_t opcode);
+
+    void skipPayload();
+
+    bool sendFrame(uint8_t opcode, const uint8_t *payload, size_t length);
+
+    /** Fails the connection, e.g. on a protocol error. */
+    void abort();
+};
+
+/**
+ * Computes the Sec-WebSocket-Accept value of a Sec-WebSocket-Key.
+ * @param accept receives 28 characters plus the terminating null
+ */
+void computeWebSocketAccept(const char *key, char accept[29]);
+
+} // namespace internal
+} // namespace octoprint
@@ -0,0 +1,596 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#ifndef ARDUINO
+
+#include "Arduino.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdarg>
+#include <sched.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+std::string formatInteger(unsigned long value, bool isNegative, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char digits[sizeof(unsigned long) * 8 + 2];
+    size_t idx = sizeof(digits);
+    do {
+        const unsigned long digit = value % base;
+        digits[--idx] = static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value > 0);
+    if (isNegative) digits[--idx] = '-';
+    return std::string(digits + idx, sizeof(digits) - idx);
+}
+
+std::string formatSigned(long value, unsigned char base) {
+    if (value < 0 && base == 10) return formatInteger(0UL - static_cast<unsigned long>(value), true, base);
+    return formatInteger(static_cast<unsigned long>(value), false, base);
+}
+
+std::string formatFloat(double value, unsigned char decimalPlaces) {
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", static_cast<int>(decimalPlaces), value);
+    return text;
+}
+
+} // namespace
+
+unsigned long millis() {
+    using namespace std::chrono;
+    return static_cast<unsigned long>(duration_cast<milliseconds>(steady_clock::now() - startTime).count());
+}
+
+unsigned long micros() {
+    using namespace std::chrono;
+    return static_cast<unsigned long>(duration_cast<microseconds>(steady_clock::now() - startTime).count());
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {
+    sched_yield();
+}
+
+long random(long howBig) {
+    if (howBig <= 0) return 0;
+    return ::random() % howBig;
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) srandom(static_cast<unsigned int>(seed));
+}
+
+String::String(const char *cstr) : buffer(cstr != nullptr ? cstr : "") {}
+
+String::String(const char *cstr, unsigned int length) : buffer(cstr != nullptr ? std::string(cstr, length) : "") {}
+
+String::String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {}
+
+String::String(char c) : buffer(1, c) {}
+
+String::String(unsigned char value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+
+String::String(int value, unsigned char base) : buffer(formatSigned(value, base)) {}
+
+String::String(unsigned int value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+
+String::String(long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+
+String::String(unsigned long value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+
+String::String(float value, unsigned char decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+
+String::String(double value, unsigned char decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+
+String &String::operator=(const char *cstr) {
+    // ArduinoJson assigns a null pointer to reset a destination string
+    buffer.assign(cstr != nullptr ? cstr : "");
+    return *this;
+}
+
+unsigned int String::length() const {
+    return static_cast<unsigned int>(buffer.length());
+}
+
+bool String::isEmpty() const {
+    return buffer.empty();
+}
+
+const char *String::c_str() const {
+    return buffer.c_str();
+}
+
+bool String::reserve(unsigned int size) {
+    buffer.reserve(size);
+    return true;
+}
+
+void String::clear() {
+    buffer.clear();
+}
+
+bool String::concat(const String &other) {
+    buffer.append(other.buffer);
+    return true;
+}
+
+bool String::concat(const char *cstr) {
+    if (cstr == nullptr) return false;
+    buffer.append(cstr);
+    return true;
+}
+
+bool String::concat(const char *cstr, unsigned int length) {
+    if (cstr == nullptr) return false;
+    buffer.append(cstr, length);
+    return true;
+}
+
+bool String::concat(char c) {
+    buffer.push_back(c);
+    return true;
+}
+
+bool String::concat(int value) {
+    return concat(String(value));
+}
+
+bool String::concat(unsigned int value) {
+    return concat(String(value));
+}
+
+bool String::concat(long value) {
+    return concat(String(value));
+}
+
+bool String::concat(unsigned long value) {
+    return concat(String(value));
+}
+
+bool String::concat(double value) {
+    return concat(String(value));
+}
+
+bool String::equals(const String &other) const {
+    return buffer == other.buffer;
+}
+
+bool String::equals(const char *cstr) const {
+    return buffer == (cstr != nullptr ? cstr : "");
+}
+
+bool String::equalsIgnoreCase(const String &other) const {
+    if (buffer.length() != other.buffer.length()) return false;
+    for (size_t idx = 0; idx < buffer.length(); idx++) {
+        if (tolower(static_cast<unsigned char>(buffer[idx])) != tolower(static_cast<unsigned char>(other.buffer[idx])))
+            return false;
+    }
+    return true;
+}
+
+bool String::operator==(const String &other) const {
+    return equals(other);
+}
+
+bool String::operator==(const char *cstr) const {
+    return equals(cstr);
+}
+
+bool String::operator!=(const String &other) const {
+    return !equals(other);
+}
+
+bool String::operator!=(const char *cstr) const {
+    return !equals(cstr);
+}
+
+bool String::operator<(const String &other) const {
+    return buffer < other.buffer;
+}
+
+char String::charAt(unsigned int index) const {
+    return index < buffer.length() ? buffer[index] : '\0';
+}
+
+char String::operator[](unsigned int index) const {
+    return charAt(index);
+}
+
+char &String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= buffer.length()) {
+        dummy = '\0';
+        return dummy;
+    }
+    return buffer[index];
+}
+
+bool String::startsWith(const String &prefix) const {
+    return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String &prefix, unsigned int offset) const {
+    if (offset > buffer.length()) return false;
+    return buffer.compare(offset, prefix.buffer.length(), prefix.buffer) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+    if (suffix.buffer.length() > buffer.length()) return false;
+    return buffer.compare(buffer.length() - suffix.buffer.length(), suffix.buffer.length(), suffix.buffer) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    const size_t pos = buffer.find(c, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::indexOf(const String &str, unsigned int from) const {
+    const size_t pos = buffer.find(str.buffer, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(char c) const {
+    const size_t pos = buffer.rfind(c);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(const String &str) const {
+    const size_t pos = buffer.rfind(str.buffer);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+String String::substring(unsigned int beginIndex) const {
+    return substring(beginIndex, length());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+    if (beginIndex >= buffer.length()) return String();
+    if (endIndex > buffer.length()) endIndex = length();
+    return String(buffer.c_str() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(const String &find, const String &replacement) {
+    if (find.buffer.empty()) return;
+    size_t pos = 0;
+    while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+        buffer.replace(pos, find.buffer.length(), replacement.buffer);
+        pos += replacement.buffer.length();
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= buffer.length()) return;
+    buffer.erase(index, count);
+}
+
+void String::toLowerCase() {
+    for (char &c : buffer) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+}
+
+void String::toUpperCase() {
+    for (char &c : buffer) c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+}
+
+void String::trim() {
+    const size_t first = buffer.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        buffer.clear();
+        return;
+    }
+    buffer = buffer.substr(first, buffer.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+long String::toInt() const {
+    return strtol(buffer.c_str(), nullptr, 10);
+}
+
+float String::toFloat() const {
+    return strtof(buffer.c_str(), nullptr);
+}
+
+double String::toDouble() const {
+    return strtod(buffer.c_str(), nullptr);
+}
+
+String operator+(const String &lhs, const String &rhs) {
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const String &lhs, const char *rhs) {
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const char *lhs, const String &rhs) {
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const String &lhs, char rhs) {
+    String sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+String operator+(const String &lhs, int rhs) {
+    return lhs + String(rhs);
+}
+
+String operator+(const String &lhs, unsigned int rhs) {
+    return lhs + String(rhs);
+}
+
+String operator+(const String &lhs, long rhs) {
+    return lhs + String(rhs);
+}
+
+String operator+(const String &lhs, unsigned long rhs) {
+    return lhs + String(rhs);
+}
+
+String operator+(const String &lhs, double rhs) {
+    return lhs + String(rhs);
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1) written++;
+    return written;
+}
+
+size_t Print::write(const char *str) {
+    return str != nullptr ? write(reinterpret_cast<const uint8_t *>(str), strlen(str)) : 0;
+}
+
+size_t Print::write(const char *buffer, size_t size) {
+    return write(reinterpret_cast<const uint8_t *>(buffer), size);
+}
+
+size_t Print::print(const __FlashStringHelper *str) {
+    return write(reinterpret_cast<const char *>(str));
+}
+
+size_t Print::print(const String &str) {
+    return write(str.c_str(), str.length());
+}
+
+size_t Print::print(const char *str) {
+    return write(str);
+}
+
+size_t Print::print(char c) {
+    return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(int value, int base) {
+    return print(static_cast<long>(value), base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(long value, int base) {
+    return print(String(value, static_cast<unsigned char>(base)));
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return print(String(value, static_cast<unsigned char>(base)));
+}
+
+size_t Print::print(double value, int digits) {
+    return print(String(value, static_cast<unsigned char>(digits)));
+}
+
+size_t Print::print(const Printable &printable) {
+    return printable.printTo(*this);
+}
+
+size_t Print::println() {
+    return write("\r\n");
+}
+
+size_t Print::printf(const char *format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    if (static_cast<size_t>(length) < sizeof(text)) return write(text, static_cast<size_t>(length));
+
+    std::string longText(static_cast<size_t>(length) + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&longText[0], longText.size(), format, args);
+    va_end(args);
+    return write(longText.c_str(), static_cast<size_t>(length));
+}
+
+void Stream::setTimeout(unsigned long timeoutMs) {
+    _timeout = timeoutMs;
+}
+
+unsigned long Stream::getTimeout() const {
+    return _timeout;
+}
+
+int Stream::timedRead() {
+    const unsigned long startMs = millis();
+    do {
+        const int c = read();
+        if (c >= 0) return c;
+        yield();
+    } while (millis() - startMs < _timeout);
+    return -1;
+}
+
+int Stream::timedPeek() {
+    const unsigned long startMs = millis();
+    do {
+        const int c = peek();
+        if (c >= 0) return c;
+        yield();
+    } while (millis() - startMs < _timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        const int c = timedRead();
+        if (c < 0) break;
+        buffer[count++] = static_cast<char>(c);
+    }
+    return count;
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length) {
+    return readBytes(reinterpret_cast<char *>(buffer), length);
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        const int c = timedRead();
+        if (c < 0 || c == terminator) break;
+        buffer[count++] = static_cast<char>(c);
+    }
+    return count;
+}
+
+bool Stream::find(const char *target) {
+    return findUntil(target, nullptr);
+}
+
+bool Stream::findUntil(const char *target, const char *terminator) {
+    const size_t targetLength = strlen(target);
+    const size_t terminatorLength = terminator != nullptr ? strlen(terminator) : 0;
+    if (targetLength == 0) return true;
+
+    size_t matched = 0;
+    size_t terminatorMatched = 0;
+    for (;;) {
+        const int c = timedRead();
+        if (c < 0) return false;
+        // naive restart is sufficient for the header/field names searched with this
+        matched = (c == target[matched]) ? matched + 1 : (c == target[0] ? 1 : 0);
+        if (matched == targetLength) return true;
+        if (terminatorLength > 0) {
+            terminatorMatched = (c == terminator[terminatorMatched])
+                                ? terminatorMatched + 1 : (c == terminator[0] ? 1 : 0);
+            if (terminatorMatched == terminatorLength) return false;
+        }
+    }
+}
+
+String Stream::readString() {
+    String text;
+    for (int c = timedRead(); c >= 0; c = timedRead()) text.concat(static_cast<char>(c));
+    return text;
+}
+
+const IPAddress INADDR_NONE_IP(0, 0, 0, 0);
+
+IPAddress::IPAddress() : bytes{0, 0, 0, 0} {}
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) :
+        bytes{first, second, third, fourth} {}
+
+IPAddress::IPAddress(uint32_t address) {
+    memcpy(bytes, &address, sizeof(bytes));
+}
+
+IPAddress::operator uint32_t() const {
+    uint32_t address;
+    memcpy(&address, bytes, sizeof(address));
+    return address;
+}
+
+bool IPAddress::operator==(const IPAddress &other) const {
+    return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+}
+
+bool IPAddress::operator!=(const IPAddress &other) const {
+    return !(*this == other);
+}
+
+uint8_t IPAddress::operator[](int index) const {
+    return bytes[index];
+}
+
+uint8_t &IPAddress::operator[](int index) {
+    return bytes[index];
+}
+
+bool IPAddress::fromString(const char *address) {
+    unsigned int parts[4];
+    char tail;
+    if (sscanf(address, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4) return false;
+    for (uint8_t idx = 0; idx < 4; idx++) {
+        if (parts[idx] > 255) return false;
+        bytes[idx] = static_cast<uint8_t>(parts[idx]);
+    }
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return text;
+}
+
+size_t IPAddress::printTo(Print &p) const {
+    return p.print(toString());
+}
+
+HostSerial Serial;
+
+size_t HostSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HostSerial::write(const uint8_t *buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+int HostSerial::available() {
+    return 0;
+}
+
+int HostSerial::read() {
+    return -1;
+}
+
+int HostSerial::peek() {
+    return -1;
+}
+
+void HostSerial::flush() {
+    fflush(stdout);
+}
+
+#endif // ARDUINO
@@ -0,0 +1,65 @@
+/**
+ * Author: https://github.com/rubienr
+ *
+ * Minimal Arduino core replacement for building the library on POSIX hosts.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Client.h"
+#include "IPAddress.h"
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define memcpy_P memcpy
+
+typedef uint8_t byte;
+
+unsigned long millis();
+
+unsigned long micros();
+
+void delay(unsigned long ms);
+
+void yield();
+
+long random(long howBig);
+
+long random(long howSmall, long howBig);
+
+void randomSeed(unsigned long seed);
+
+/**
+ * Serial replacement writing to stdout.
+ */
+class HostSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    int available() override;
+
+    int read() override;
+
+    int peek() override;
+
+    void flush() override;
+
+    using Print::write;
+};
+
+extern HostSerial Serial;
@@ -0,0 +1,54 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#ifndef ARDUINO
+
+#include "FileDescriptorStream.h"
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace octoprint {
+namespace host {
+
+FileDescriptorStream::FileDescriptorStream(int fd) : fd{fd} {}
+
+long FileDescriptorStream::getSize() const {
+    struct stat status {};
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) return -1;
+    return static_cast<long>(status.st_size);
+}
+
+int FileDescriptorStream::available() {
+    if (inputBegin == inputEnd) fillInput();
+    return static_cast<int>(inputEnd - inputBegin);
+}
+
+int FileDescriptorStream::read() {
+    if (inputBegin == inputEnd && !fillInput()) return -1;
+    return input[inputBegin++];
+}
+
+int FileDescriptorStream::peek() {
+    if (inputBegin == inputEnd && !fillInput()) return -1;
+    return input[inputBegin];
+}
+
+bool FileDescriptorStream::fillInput() {
+    if (isAtEnd) return false;
+    ssize_t received;
+    do {
+        received = ::read(fd, input, sizeof(input));
+    } while (received < 0 && errno == EINTR);
+    // read() blocks on pipes too, 0 means the end in any case
+    isAtEnd = received <= 0;
+    inputBegin = 0;
+    inputEnd = isAtEnd ? 0 : static_cast<size_t>(received);
+    return !isAtEnd;
+}
+
+} // namespace host
+} // namespace octoprint
+
+#endif // ARDUINO
@@ -0,0 +1,55 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "Stream.h"
+
+namespace octoprint {
+namespace host {
+
+/**
+ * Read-only Arduino Stream on a POSIX file descriptor, e.g. the source of OctoprintClient::uploadFile().
+ * Reads are served from an input buffer refilled by a single read() per call, so the byte-wise readBytes() of Stream
+ * does not end in a system call per byte. The descriptor is not closed.
+ */
+struct FileDescriptorStream : public Stream {
+
+    static constexpr size_t inputBufferSize = 512;
+
+    explicit FileDescriptorStream(int fd);
+
+    FileDescriptorStream(const FileDescriptorStream &) = delete;
+
+    FileDescriptorStream &operator=(const FileDescriptorStream &) = delete;
+
+    /** @return size of a regular file, -1 if it is not one or unknown */
+    long getSize() const;
+
+    int available() override;
+
+    int read() override;
+
+    int peek() override;
+
+    size_t write(uint8_t) override {
+        return 0;
+    }
+
+    using Print::write;
+
+private:
+    int fd;
+    bool isAtEnd{false};
+
+    uint8_t input[inputBufferSize];
+    size_t inputBegin{0};
+    size_t inputEnd{0};
+
+    /** @return false at the end of the file or on error */
+    bool fillInput();
+};
+
+} // namespace host
+} // namespace octoprint
@@ -0,0 +1,43 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "Printable.h"
+#include "WString.h"
+
+/**
+ * Host replacement of Arduino's IPv4 IPAddress.
+ */
+class IPAddress : public Printable {
+public:
+    IPAddress();
+
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth);
+
+    explicit IPAddress(uint32_t address);
+
+    /** @return the address in network byte order */
+    operator uint32_t() const;
+
+    bool operator==(const IPAddress &other) const;
+
+    bool operator!=(const IPAddress &other) const;
+
+    uint8_t operator[](int index) const;
+
+    uint8_t &operator[](int index);
+
+    bool fromString(const char *address);
+
+    String toString() const;
+
+    size_t printTo(Print &p) const override;
+
+private:
+    uint8_t bytes[4];
+};
+
+extern const IPAddress INADDR_NONE_IP;
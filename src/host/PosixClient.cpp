@@ -0,0 +1,295 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#ifndef ARDUINO
+
+#include "PosixClient.h"
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace octoprint {
+namespace host {
+
+PosixPoller::PosixPoller() : epollFd{epoll_create1(EPOLL_CLOEXEC)} {}
+
+PosixPoller::~PosixPoller() {
+    if (epollFd >= 0) close(epollFd);
+}
+
+bool PosixPoller::add(int fd) {
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = fd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void PosixPoller::remove(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+int PosixPoller::wait(int timeoutMs) {
+    epoll_event events[32];
+    int ready;
+    do {
+        ready = epoll_wait(epollFd, events, sizeof(events) / sizeof(events[0]), timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+    return ready;
+}
+
+bool PosixResolver::resolve(const char *hostName, IPAddress &ip) {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(hostName, nullptr, &hints, &result) != 0 || result == nullptr) return false;
+
+    ip = IPAddress(reinterpret_cast<const sockaddr_in *>(result->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(result);
+    return true;
+}
+
+PosixClient::PosixClient(PosixPoller *poller) : poller{poller} {}
+
+PosixClient::~PosixClient() {
+    stop();
+}
+
+int PosixClient::connect(IPAddress ip, uint16_t port) {
+    stop();
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return 0;
+
+    // requests are assembled in the output buffer, Nagle would only delay them
+    const int isNoDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &isNoDelay, sizeof(isNoDelay));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = static_cast<uint32_t>(ip);
+
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0) {
+        state = State::Connected;
+    } else if (errno == EINPROGRESS) {
+        state = State::Connecting;
+        connectStartMs = millis();
+    } else {
+        fail();
+        return 0;
+    }
+
+    if (poller != nullptr) poller->add(fd);
+    return 1;
+}
+
+int PosixClient::connect(const char *host, uint16_t port) {
+    IPAddress ip;
+    if (!PosixResolver().resolve(host, ip)) return 0;
+    return connect(ip, port);
+}
+
+size_t PosixClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t PosixClient::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        if (state != State::Connecting && state != State::Connected) break;
+
+        if (outputLength == outputBufferSize) {
+            flushOutput();
+            if (outputLength == outputBufferSize && !waitWritable(writeTimeoutMs)) break;
+            continue;
+        }
+
+        size_t run = size - written;
+        if (run > outputBufferSize - outputLength) run = outputBufferSize - outputLength;
+        memcpy(output + outputLength, buffer + written, run);
+        outputLength += run;
+        written += run;
+    }
+    // a filled buffer is worth a syscall right away, small writes wait for the request to be complete
+    if (outputLength == outputBufferSize) flushOutput();
+    return written;
+}
+
+int PosixClient::available() {
+    flushOutput();
+    if (inputBegin == inputEnd) fillInput();
+    return static_cast<int>(inputEnd - inputBegin);
+}
+
+int PosixClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int PosixClient::read(uint8_t *buffer, size_t size) {
+    if (available() == 0) return -1;
+
+    size_t run = inputEnd - inputBegin;
+    if (run > size) run = size;
+    memcpy(buffer, input + inputBegin, run);
+    inputBegin += run;
+    return static_cast<int>(run);
+}
+
+int PosixClient::peek() {
+    if (available() == 0) return -1;
+    return input[inputBegin];
+}
+
+void PosixClient::flush() {
+    const unsigned long startMs = millis();
+    while (outputLength > 0 && flushOutput() && outputLength > 0) {
+        const unsigned long elapsedMs = millis() - startMs;
+        if (elapsedMs >= writeTimeoutMs || !waitWritable(writeTimeoutMs - elapsedMs)) break;
+    }
+}
+
+void PosixClient::stop() {
+    if (fd >= 0) {
+        if (poller != nullptr) poller->remove(fd);
+        close(fd);
+    }
+    fd = -1;
+    state = State::Closed;
+    inputBegin = inputEnd = 0;
+    outputLength = 0;
+}
+
+uint8_t PosixClient::connected() {
+    flushOutput();
+    // detects a peer close on an idle connection
+    if (state == State::Connected && inputBegin == inputEnd) fillInput();
+
+    switch (state) {
+        case State::Connecting:
+        case State::Connected:
+            return 1;
+        case State::PeerClosed:
+            return inputBegin < inputEnd ? 1 : 0;
+        case State::Closed:
+            break;
+    }
+    return 0;
+}
+
+PosixClient::operator bool() {
+    return fd >= 0;
+}
+
+void PosixClient::setConnectTimeout(unsigned long timeoutMs) {
+    connectTimeoutMs = timeoutMs;
+}
+
+void PosixClient::setWriteTimeout(unsigned long timeoutMs) {
+    writeTimeoutMs = timeoutMs;
+}
+
+int PosixClient::getFd() const {
+    return fd;
+}
+
+void PosixClient::updateConnecting() {
+    if (state != State::Connecting) return;
+
+    pollfd pending{fd, POLLOUT, 0};
+    if (poll(&pending, 1, 0) == 0) {
+        if (millis() - connectStartMs >= connectTimeoutMs) fail();
+        return;
+    }
+
+    int error = 0;
+    socklen_t errorLength = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLength) != 0 || error != 0) {
+        fail();
+        return;
+    }
+    state = State::Connected;
+}
+
+void PosixClient::fillInput() {
+    updateConnecting();
+    if (state != State::Connected) return;
+
+    inputBegin = inputEnd = 0;
+    ssize_t received;
+    do {
+        received = recv(fd, input, inputBufferSize, 0);
+    } while (received < 0 && errno == EINTR);
+
+    if (received > 0) {
+        inputEnd = static_cast<size_t>(received);
+    } else if (received == 0) {
+        state = State::PeerClosed;
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        // reset by peer and friends, whatever was received before stays readable
+        state = State::PeerClosed;
+    }
+}
+
+bool PosixClient::flushOutput() {
+    updateConnecting();
+    if (outputLength == 0) return true;
+    if (state != State::Connected) return state == State::Connecting;
+
+    size_t sent = 0;
+    while (sent < outputLength) {
+        const ssize_t result = send(fd, output + sent, outputLength - sent, MSG_NOSIGNAL);
+        if (result > 0) {
+            sent += static_cast<size_t>(result);
+        } else if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            fail();
+            return false;
+        }
+    }
+    memmove(output, output + sent, outputLength - sent);
+    outputLength -= sent;
+    return true;
+}
+
+bool PosixClient::waitWritable(unsigned long timeoutMs) {
+    if (fd < 0) return false;
+
+    pollfd pending{fd, POLLOUT, 0};
+    int ready;
+    do {
+        ready = poll(&pending, 1, static_cast<int>(timeoutMs));
+    } while (ready < 0 && errno == EINTR);
+    if (ready <= 0) return false;
+
+    updateConnecting();
+    return state == State::Connected;
+}
+
+void PosixClient::fail() {
+    if (fd >= 0) {
+        if (poller != nullptr) poller->remove(fd);
+        close(fd);
+    }
+    fd = -1;
+    state = State::Closed;
+    outputLength = 0;
+}
+
+} // namespace host
+} // namespace octoprint
+
+#endif // ARDUINO
@@ -0,0 +1,142 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "Client.h"
+#include "HostResolver.h"
+
+namespace octoprint {
+namespace host {
+
+/**
+ * Sleeps until one of many sockets becomes ready, so that a host event loop driving several clients does not spin.
+ * Sockets are registered edge triggered: a wake-up means "something changed", the clients' poll() does the rest.
+ */
+struct PosixPoller {
+
+    PosixPoller();
+
+    ~PosixPoller();
+
+    PosixPoller(const PosixPoller &) = delete;
+
+    PosixPoller &operator=(const PosixPoller &) = delete;
+
+    bool add(int fd);
+
+    void remove(int fd);
+
+    /**
+     * @param timeoutMs upper bound of the sleep, also bounds the latency of events consumed by someone else
+     * @return number of sockets with events, 0 on timeout, -1 on error
+     */
+    int wait(int timeoutMs);
+
+private:
+    int epollFd;
+};
+
+/**
+ * Resolves IPv4 addresses with getaddrinfo(), which blocks and includes mDNS where the system resolver does.
+ */
+struct PosixResolver : public HostResolver {
+    bool resolve(const char *hostName, IPAddress &ip) override;
+};
+
+/**
+ * Arduino Client on top of a non-blocking POSIX TCP socket.
+ *
+ * Nothing blocks unless buffers are exhausted: connect() returns while the handshake is still in progress, writes
+ * are collected in an output buffer and sent once the connection is established (which also merges the many small
+ * print() calls of a request into few send() calls), and reads are served from an input buffer refilled by a single
+ * recv() per call.
+ */
+struct PosixClient : public Client {
+
+    static constexpr size_t inputBufferSize = 4096;
+    static constexpr size_t outputBufferSize = 2048;
+
+    /**
+     * @param poller optional, the socket is registered with it while open
+     */
+    explicit PosixClient(PosixPoller *poller = nullptr);
+
+    ~PosixClient() override;
+
+    PosixClient(const PosixClient &) = delete;
+
+    PosixClient &operator=(const PosixClient &) = delete;
+
+    int connect(IPAddress ip, uint16_t port) override;
+
+    /** Resolves the host name with getaddrinfo(), which blocks. */
+    int connect(const char *host, uint16_t port) override;
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    int available() override;
+
+    int read() override;
+
+    int read(uint8_t *buffer, size_t size) override;
+
+    int peek() override;
+
+    /** Sends all buffered output, waits at most the write timeout. */
+    void flush() override;
+
+    void stop() override;
+
+    uint8_t connected() override;
+
+    operator bool() override;
+
+    void setConnectTimeout(unsigned long timeoutMs);
+
+    /** Bounds how long write() and flush() wait for the socket to drain once the output buffer is full. */
+    void setWriteTimeout(unsigned long timeoutMs);
+
+    int getFd() const;
+
+    using Print::write;
+
+private:
+    enum class State : uint8_t {
+        Closed,
+        Connecting,
+        Connected,
+        // the peer finished sending, buffered input may still be read
+        PeerClosed
+    };
+
+    PosixPoller *poller;
+    int fd{-1};
+    State state{State::Closed};
+    unsigned long connectStartMs{0};
+    unsigned long connectTimeoutMs{3000};
+    unsigned long writeTimeoutMs{3000};
+
+    uint8_t input[inputBufferSize];
+    size_t inputBegin{0};
+    size_t inputEnd{0};
+
+    uint8_t output[outputBufferSize];
+    size_t outputLength{0};
+
+    void updateConnecting();
+
+    void fillInput();
+
+    bool flushOutput();
+
+    bool waitWritable(unsigned long timeoutMs);
+
+    void fail();
+};
+
+} // namespace host
+} // namespace octoprint
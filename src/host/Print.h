@@ -0,0 +1,71 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Printable.h"
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+/**
+ * Host replacement of Arduino's Print.
+ */
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    size_t write(const char *str);
+
+    size_t write(const char *buffer, size_t size);
+
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper *str);
+
+    size_t print(const String &str);
+
+    size_t print(const char *str);
+
+    size_t print(char c);
+
+    size_t print(unsigned char value, int base = DEC);
+
+    size_t print(int value, int base = DEC);
+
+    size_t print(unsigned int value, int base = DEC);
+
+    size_t print(long value, int base = DEC);
+
+    size_t print(unsigned long value, int base = DEC);
+
+    size_t print(double value, int digits = 2);
+
+    size_t print(const Printable &printable);
+
+    size_t println();
+
+    template<typename T>
+    size_t println(const T &value) {
+        const size_t written = print(value);
+        return written + println();
+    }
+
+    template<typename T>
+    size_t println(const T &value, int format) {
+        const size_t written = print(value, format);
+        return written + println();
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
@@ -0,0 +1,16 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <cstddef>
+
+class Print;
+
+class Printable {
+public:
+    virtual ~Printable() = default;
+
+    virtual size_t printTo(Print &p) const = 0;
+};
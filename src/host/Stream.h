@@ -0,0 +1,42 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "Print.h"
+
+/**
+ * Host replacement of Arduino's Stream.
+ */
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+
+    virtual int read() = 0;
+
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeoutMs);
+
+    unsigned long getTimeout() const;
+
+    size_t readBytes(char *buffer, size_t length);
+
+    size_t readBytes(uint8_t *buffer, size_t length);
+
+    size_t readBytesUntil(char terminator, char *buffer, size_t length);
+
+    bool find(const char *target);
+
+    bool findUntil(const char *target, const char *terminator);
+
+    String readString();
+
+protected:
+    unsigned long _timeout{1000};
+
+    int timedRead();
+
+    int timedPeek();
+};
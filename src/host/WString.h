@@ -0,0 +1,159 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class __FlashStringHelper;
+
+/**
+ * Host replacement of Arduino's String, backed by std::string.
+ */
+class String {
+public:
+    String(const char *cstr = "");
+
+    String(const char *cstr, unsigned int length);
+
+    String(const String &other) = default;
+
+    String(String &&other) = default;
+
+    String(const __FlashStringHelper *str);
+
+    explicit String(char c);
+
+    explicit String(unsigned char value, unsigned char base = 10);
+
+    explicit String(int value, unsigned char base = 10);
+
+    explicit String(unsigned int value, unsigned char base = 10);
+
+    explicit String(long value, unsigned char base = 10);
+
+    explicit String(unsigned long value, unsigned char base = 10);
+
+    explicit String(float value, unsigned char decimalPlaces = 2);
+
+    explicit String(double value, unsigned char decimalPlaces = 2);
+
+    String &operator=(const String &other) = default;
+
+    String &operator=(String &&other) = default;
+
+    String &operator=(const char *cstr);
+
+    unsigned int length() const;
+
+    bool isEmpty() const;
+
+    const char *c_str() const;
+
+    bool reserve(unsigned int size);
+
+    void clear();
+
+    bool concat(const String &other);
+
+    bool concat(const char *cstr);
+
+    bool concat(const char *cstr, unsigned int length);
+
+    bool concat(char c);
+
+    bool concat(int value);
+
+    bool concat(unsigned int value);
+
+    bool concat(long value);
+
+    bool concat(unsigned long value);
+
+    bool concat(double value);
+
+    template<typename T>
+    String &operator+=(const T &value) {
+        concat(value);
+        return *this;
+    }
+
+    bool equals(const String &other) const;
+
+    bool equals(const char *cstr) const;
+
+    bool equalsIgnoreCase(const String &other) const;
+
+    bool operator==(const String &other) const;
+
+    bool operator==(const char *cstr) const;
+
+    bool operator!=(const String &other) const;
+
+    bool operator!=(const char *cstr) const;
+
+    bool operator<(const String &other) const;
+
+    char charAt(unsigned int index) const;
+
+    char operator[](unsigned int index) const;
+
+    char &operator[](unsigned int index);
+
+    bool startsWith(const String &prefix) const;
+
+    bool startsWith(const String &prefix, unsigned int offset) const;
+
+    bool endsWith(const String &suffix) const;
+
+    int indexOf(char c, unsigned int from = 0) const;
+
+    int indexOf(const String &str, unsigned int from = 0) const;
+
+    int lastIndexOf(char c) const;
+
+    int lastIndexOf(const String &str) const;
+
+    String substring(unsigned int beginIndex) const;
+
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(const String &find, const String &replacement);
+
+    void remove(unsigned int index, unsigned int count = ~0u);
+
+    void toLowerCase();
+
+    void toUpperCase();
+
+    void trim();
+
+    long toInt() const;
+
+    float toFloat() const;
+
+    double toDouble() const;
+
+private:
+    std::string buffer;
+};
+
+String operator+(const String &lhs, const String &rhs);
+
+String operator+(const String &lhs, const char *rhs);
+
+String operator+(const char *lhs, const String &rhs);
+
+String operator+(const String &lhs, char rhs);
+
+String operator+(const String &lhs, int rhs);
+
+String operator+(const String &lhs, unsigned int rhs);
+
+String operator+(const String &lhs, long rhs);
+
+String operator+(const String &lhs, unsigned long rhs);
+
+String operator+(const String &lhs, double rhs);
@@ -0,0 +1,30 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include "HostResolver.h"
+
+namespace octoprint {
+namespace test {
+
+/**
+ * Resolves every name to a settable address, or fails, and counts the lookups.
+ */
+struct FakeHostResolver : public HostResolver {
+
+    bool resolve(const char *, IPAddress &ip) override {
+        lookupsCount++;
+        if (isFailing) return false;
+        ip = address;
+        return true;
+    }
+
+    IPAddress address{192, 168, 1, 20};
+    bool isFailing{false};
+    unsigned lookupsCount{0};
+};
+
+} // namespace test
+} // namespace octoprint
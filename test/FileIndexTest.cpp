@@ -0,0 +1,178 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "FileIndex.h"
+#include "HttpResponseParser.h"
+#include "StringStream.h"
+#include "TestSupport.h"
+#include <limits>
+
+using namespace octoprint;
+using octoprint::test::StringStream;
+
+namespace {
+
+DeserializationError readListing(const std::string &listing, FileIndex &index) {
+    StringStream body(listing);
+    index.beginListing();
+    const DeserializationError error = internal::readFileListing(body, index);
+    index.endListing(!error, "\"etag\"", "Wed, 21 Oct 2015 07:28:00 GMT");
+    return error;
+}
+
+std::string file(const std::string &path, const std::string &more = "") {
+    return R"({"name":"n","path":")" + path + R"(","type":"machinecode")" + more + "}";
+}
+
+/** A folder holding a file and the next folder, down to the given depth. */
+std::string nestedFolder(unsigned depth, unsigned lastDepth) {
+    const std::string path = "f" + std::to_string(depth);
+    std::string children = file("d" + std::to_string(depth + 1) + ".gcode");
+    if (depth < lastDepth) children += "," + nestedFolder(depth + 1, lastDepth);
+    return R"({"path":")" + path + R"(","type":"folder","children":[)" + children + "]}";
+}
+
+} // namespace
+
+TEST(plainListing) {
+    StaticFileIndex<4> index;
+    const DeserializationError error = readListing(
+            R"({"files":[)" +
+            file("a.gcode", R"(,"size":1234,"date":1700000000,"gcodeAnalysis":{"estimatedPrintTime":93.5})") + "," +
+            file("b.gcode", R"(,"size":null,"gcodeAnalysis":null)") +
+            R"(],"free":1000,"total":2000})", index);
+    CHECK_STRING("Ok", error.c_str());
+    CHECK_EQUAL(2, index.size());
+    CHECK_EQUAL(2, index.getTotalCount());
+    CHECK_STRING("a.gcode", index[0].path);
+    CHECK_EQUAL(1234u, index[0].size);
+    CHECK_EQUAL(1700000000u, index[0].date);
+    CHECK_NEAR(93.5, index[0].estimatedPrintTime, 1e-3);
+    CHECK_EQUAL(0u, index[1].size);
+    CHECK(!index[1].isFolder);
+}
+
+TEST(foldersNestedBeyondTheMaximumDepthAreSkipped) {
+    // folders f0 to f11, the content of folders deeper than 8 levels is skipped
+    StaticFileIndex<32> index("", true);
+    const DeserializationError error = readListing(
+            R"({"files":[)" + nestedFolder(0, 11) + "," + file("after.gcode") + "]}", index);
+    CHECK_STRING("Ok", error.c_str());
+    // d1 to d8 and f8 to f0, the content of a folder precedes the folder
+    CHECK_EQUAL(18, index.size());
+    if (index.size() != 18) return;
+    CHECK_STRING("d1.gcode", index[0].path);
+    CHECK_STRING("d8.gcode", index[7].path);
+    CHECK_STRING("f8", index[8].path);
+    CHECK(index[8].isFolder);
+    CHECK_STRING("f0", index[16].path);
+    CHECK_STRING("after.gcode", index[17].path);
+}
+
+TEST(escapedNamesAreDecoded) {
+    StaticFileIndex<2> index;
+    const DeserializationError error = readListing(
+            R"({"files":[)" + file(R"(a\"b\\c\/d\u00e9€\ud83d\ude00\t.gcode)") + "]}", index);
+    CHECK_STRING("Ok", error.c_str());
+    CHECK_EQUAL(1, index.size());
+    CHECK_STRING("a\"b\\c/d\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\t.gcode", index[0].path);
+    CHECK(!index[0].isPathTruncated);
+}
+
+TEST(longPathsAreMarkedTruncated) {
+    StaticFileIndex<1> index;
+    readListing(R"({"files":[)" + file(std::string(200, 'p')) + "]}", index);
+    CHECK_EQUAL(1, index.size());
+    CHECK(index[0].isPathTruncated);
+    CHECK_EQUAL(static_cast<size_t>(FileEntry::maxPathLength), strlen(index[0].path));
+}
+
+TEST(unknownMembersAreSkipped) {
+    StaticFileIndex<2> index;
+    const DeserializationError error = readListing(
+            R"({"unknown":[[1,[2,{}]],{"a":"]}"}],"files":[)" +
+            file("x.gcode",
+                 R"(,"refs":{"resource":[[1,2],{"a":[3,"]}\"["]}]},"prints":{"success":1,"last":{"date":[]}},)"
+                 R"("a very long member name that does not fit":{"size":1},"size":10)") +
+            R"(],"children":{"not":"a list"}})", index);
+    CHECK_STRING("Ok", error.c_str());
+    CHECK_EQUAL(1, index.size());
+    CHECK_STRING("x.gcode", index[0].path);
+    CHECK_EQUAL(10u, index[0].size);
+}
+
+TEST(numbersOutOfRangeAreClamped) {
+    StaticFileIndex<4> index;
+    const DeserializationError error = readListing(
+            R"({"files":[)" +
+            file("negative", R"(,"size":-5,"date":-1e300)") + "," +
+            file("huge", R"(,"size":1e20,"date":4294967296,"gcodeAnalysis":{"estimatedPrintTime":1e400})") + "," +
+            file("fraction", R"(,"size":12.7,"gcodeAnalysis":{"estimatedPrintTime":-1e400})") +
+            "]}", index);
+    CHECK_STRING("Ok", error.c_str());
+    CHECK_EQUAL(3, index.size());
+    CHECK_EQUAL(0u, index[0].size);
+    CHECK_EQUAL(0u, index[0].date);
+    CHECK_EQUAL(UINT32_MAX, index[1].size);
+    CHECK_EQUAL(UINT32_MAX, index[1].date);
+    CHECK(index[1].estimatedPrintTime == std::numeric_limits<float>::max());
+    CHECK_EQUAL(12u, index[2].size);
+    CHECK(index[2].estimatedPrintTime == std::numeric_limits<float>::lowest());
+}
+
+TEST(brokenListings) {
+    StaticFileIndex<2> index;
+    CHECK_STRING("IncompleteInput", readListing(R"({"files":[)" + file("a.gcode") + ",", index).c_str());
+    CHECK_EQUAL(1, index.size());
+    CHECK_STRING("", index.getConditionalHeaders().c_str());
+    CHECK_STRING("InvalidInput", readListing(R"({"files":[)" + file("a.gcode") + "}", index).c_str());
+    CHECK_STRING("IncompleteInput", readListing(R"({"files":[{"path":"a\u00)", index).c_str());
+}
+
+TEST(deeplyNestedUnknownValueFails) {
+    // deeper than the nesting counter of skipped values reaches
+    StaticFileIndex<1> index;
+    const std::string listing = R"({"unknown":)" + std::string(70000, '[') + std::string(70000, ']') + "}";
+    CHECK_STRING("TooDeep", readListing(listing, index).c_str());
+}
+
+TEST(pagesKeepTheirEntriesAndCountAll) {
+    StaticFileIndex<2> index;
+    index.setPageOffset(3);
+    std::string listing = R"({"files":[)";
+    for (unsigned idx = 0; idx < 7; idx++) listing += (idx > 0 ? "," : "") + file("p" + std::to_string(idx));
+    listing += "]}";
+    CHECK_STRING("Ok", readListing(listing, index).c_str());
+    CHECK_EQUAL(2, index.size());
+    CHECK_EQUAL(7, index.getTotalCount());
+    CHECK_STRING("p3", index[0].path);
+    CHECK_STRING("p4", index[1].path);
+}
+
+TEST(validatorsAreKeptUntilThePageChanges) {
+    StaticFileIndex<2> index;
+    CHECK_STRING("", index.getConditionalHeaders().c_str());
+    readListing(R"({"files":[]})", index);
+    CHECK_EQUAL(1u, index.getGeneration());
+    CHECK_STRING("If-None-Match: \"etag\"\r\nIf-Modified-Since: Wed, 21 Oct 2015 07:28:00 GMT\r\n",
+                 index.getConditionalHeaders().c_str());
+
+    // the same page keeps them
+    index.setPageOffset(0);
+    CHECK(!index.getConditionalHeaders().isEmpty());
+
+    index.setPageOffset(2);
+    CHECK_STRING("", index.getConditionalHeaders().c_str());
+    CHECK_EQUAL(2, index.getPageOffset());
+}
+
+TEST(cutEtagIsNotKept) {
+    StaticFileIndex<1> index;
+    StringStream body(R"({"files":[]})");
+    index.beginListing();
+    internal::readFileListing(body, index);
+    const std::string cutEtag(internal::HttpResponseParser::maxEtagLength, 'e');
+    index.endListing(true, cutEtag.c_str(), "");
+    CHECK_STRING("", index.getConditionalHeaders().c_str());
+}
@@ -0,0 +1,142 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "GcodeQueue.h"
+#include "ScriptedServer.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+using octoprint::test::ScriptedServer;
+using octoprint::test::response;
+
+namespace {
+
+std::string appended(const char *text, size_t capacity = 64) {
+    char buffer[64] = "";
+    size_t length = 0;
+    if (!internal::appendJsonString(buffer, capacity, length, text)) return "<not fitting>";
+    return std::string(buffer, length);
+}
+
+} // namespace
+
+TEST(plainTextIsQuoted) {
+    CHECK_STRING(R"("G28")", appended("G28"));
+    CHECK_STRING(R"("")", appended(""));
+}
+
+TEST(quotesAndBackslashesAreEscaped) {
+    CHECK_STRING(R"("M117 \"hi\"")", appended("M117 \"hi\""));
+    CHECK_STRING(R"("a\\b")", appended("a\\b"));
+}
+
+TEST(controlCharactersAreEscaped) {
+    CHECK_STRING(R"("a\nb\rc\td")", appended("a\nb\rc\td"));
+    CHECK_STRING(R"("\u0001\u001f")", appended("\x01\x1f"));
+    // DEL and bytes above are no control characters to Json
+    CHECK_STRING("\"\x7f\xc3\xa4\"", appended("\x7f\xc3\xa4"));
+}
+
+TEST(appendingContinuesAtTheGivenLength) {
+    char buffer[16] = "[";
+    size_t length = 1;
+    CHECK(internal::appendJsonString(buffer, sizeof(buffer), length, "a"));
+    CHECK_EQUAL(4u, length);
+    CHECK_STRING(R"(["a")", buffer);
+}
+
+TEST(textNotFittingLeavesTheBufferAsItWas) {
+    // "ab" takes 4 bytes plus the terminating null
+    CHECK_STRING(R"("ab")", appended("ab", 5));
+    CHECK_STRING("<not fitting>", appended("abc", 5));
+
+    char buffer[8] = "[";
+    size_t length = 1;
+    // the escape of the quote would end beyond the buffer
+    CHECK(!internal::appendJsonString(buffer, sizeof(buffer), length, "abcd\""));
+    CHECK_EQUAL(1u, length);
+    CHECK_STRING("[", buffer);
+}
+
+TEST(linesAreSentInOneBatch) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    GcodeQueue queue(printer);
+    server.answer(response(204, ""));
+
+    CHECK(queue.add("G28"));
+    CHECK(queue.add("M117 \"done\""));
+    CHECK_EQUAL(2, queue.getQueuedCount());
+    CHECK(queue.awaitSent());
+
+    CHECK_EQUAL(1u, server.requests.size());
+    CHECK_STRING("POST /api/printer/command HTTP/1.1", server.requestLine(0));
+    CHECK_STRING(R"({"commands": ["G28","M117 \"done\""]})", server.requestBody(0));
+    CHECK_EQUAL(0, queue.getQueuedCount());
+}
+
+TEST(longestLineFillsTheBodyExactly) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    GcodeQueue queue(printer);
+    server.answer(response(204, ""));
+
+    // {"commands": [ and "]} and the terminating null leave 493 bytes for the line
+    const std::string line(493, 'x');
+    CHECK(queue.add(line.c_str()));
+    CHECK(queue.awaitSent());
+    CHECK_EQUAL(GcodeQueue::maxBodyLength - 1, server.requestBody(0).size());
+    CHECK_STRING("{\"commands\": [\"" + line + "\"]}", server.requestBody(0));
+}
+
+TEST(lineTooLongForAnyBatchIsRejected) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    GcodeQueue queue(printer);
+
+    const std::string line(494, 'x');
+    CHECK(!queue.add(line.c_str()));
+    CHECK_EQUAL(0, queue.getQueuedCount());
+    CHECK(!queue.poll());
+    CHECK(server.requests.empty());
+}
+
+TEST(lineNotFittingTheBatchStartsTheNext) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    GcodeQueue queue(printer);
+    server.answer(response(204, ""));
+    server.answer(response(204, ""));
+
+    CHECK(queue.add("G28"));
+    const std::string line(493, 'x');
+    CHECK(queue.add(line.c_str()));
+    CHECK_EQUAL(1, queue.getQueuedCount());
+    CHECK(queue.awaitSent());
+
+    CHECK_EQUAL(2u, server.requests.size());
+    CHECK_STRING(R"({"commands": ["G28"]})", server.requestBody(0));
+    CHECK_STRING("{\"commands\": [\"" + line + "\"]}", server.requestBody(1));
+}
+
+TEST(awaitSentDrivesARequestOfOtherCodeFirst) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    GcodeQueue queue(printer);
+    server.answer(response(200, R"({"job":{},"progress":{},"state":"Operational"})"));
+    server.answer(response(204, ""));
+
+    bool isJobFetched = false;
+    CHECK(printer.request(Operation::FetchPrintJob, [&](const RequestStatus &status) {
+        isJobFetched = status.isSuccess;
+    }));
+    CHECK(queue.add("G28"));
+    CHECK(queue.awaitSent());
+
+    CHECK(isJobFetched);
+    CHECK_EQUAL(2u, server.requests.size());
+    CHECK_STRING("GET /api/job HTTP/1.1", server.requestLine(0));
+    CHECK_STRING("POST /api/printer/command HTTP/1.1", server.requestLine(1));
+    CHECK_STRING(R"({"commands": ["G28"]})", server.requestBody(1));
+}
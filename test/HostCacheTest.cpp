@@ -0,0 +1,133 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "FakeHostResolver.h"
+#include "HostResolver.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+using octoprint::test::FakeHostResolver;
+
+namespace {
+
+internal::HostCache cacheWith(FakeHostResolver &resolver, unsigned long ttlMs, unsigned long negativeTtlMs,
+                              unsigned long refreshAheadMs = 0) {
+    internal::HostCache cache;
+    cache.resolver = &resolver;
+    cache.settings.ttlMs = ttlMs;
+    cache.settings.negativeTtlMs = negativeTtlMs;
+    cache.settings.refreshAheadMs = refreshAheadMs;
+    return cache;
+}
+
+} // namespace
+
+TEST(addressIsResolvedOncePerTtl) {
+    FakeHostResolver resolver;
+    internal::HostCache cache = cacheWith(resolver, 40, 1000);
+    IPAddress ip;
+
+    CHECK(!cache.getPinned(ip));
+    CHECK(cache.lookup("octopi.local", ip));
+    CHECK(ip == resolver.address);
+    CHECK(cache.lookup("octopi.local", ip));
+    CHECK(cache.getPinned(ip));
+    CHECK_EQUAL(1u, resolver.lookupsCount);
+
+    delay(50);
+    CHECK(!cache.getPinned(ip));
+    resolver.address = IPAddress(192, 168, 1, 21);
+    CHECK(cache.lookup("octopi.local", ip));
+    CHECK(ip == IPAddress(192, 168, 1, 21));
+    CHECK_EQUAL(2u, resolver.lookupsCount);
+}
+
+TEST(failedResolutionIsCachedForTheNegativeTtl) {
+    FakeHostResolver resolver;
+    resolver.isFailing = true;
+    internal::HostCache cache = cacheWith(resolver, 1000, 40);
+    IPAddress ip;
+
+    CHECK(!cache.lookup("octopi.local", ip));
+    CHECK(!cache.lookup("octopi.local", ip));
+    CHECK(!cache.getPinned(ip));
+    CHECK_EQUAL(1u, resolver.lookupsCount);
+
+    resolver.isFailing = false;
+    delay(50);
+    CHECK(cache.lookup("octopi.local", ip));
+    CHECK_EQUAL(2u, resolver.lookupsCount);
+}
+
+TEST(invalidateForgetsTheAddressButNotAFailure) {
+    FakeHostResolver resolver;
+    internal::HostCache cache = cacheWith(resolver, 1000, 1000);
+    IPAddress ip;
+
+    CHECK(cache.lookup("octopi.local", ip));
+    cache.invalidate();
+    CHECK(!cache.getPinned(ip));
+    CHECK(cache.lookup("octopi.local", ip));
+    CHECK_EQUAL(2u, resolver.lookupsCount);
+
+    internal::HostCache failed = cacheWith(resolver, 1000, 1000);
+    resolver.isFailing = true;
+    CHECK(!failed.lookup("octopi.local", ip));
+    failed.invalidate();
+    CHECK(!failed.lookup("octopi.local", ip));
+    CHECK_EQUAL(3u, resolver.lookupsCount);
+}
+
+TEST(refreshIsOptIn) {
+    FakeHostResolver resolver;
+    internal::HostCache cache = cacheWith(resolver, 40, 1000);
+    IPAddress ip;
+
+    CHECK(cache.lookup("octopi.local", ip));
+    delay(30);
+    cache.refresh("octopi.local");
+    CHECK_EQUAL(1u, resolver.lookupsCount);
+}
+
+TEST(refreshResolvesAheadOfExpiry) {
+    FakeHostResolver resolver;
+    internal::HostCache cache = cacheWith(resolver, 100, 1000, 60);
+    IPAddress ip;
+
+    CHECK(cache.lookup("octopi.local", ip));
+    // not due before 40 ms
+    cache.refresh("octopi.local");
+    CHECK_EQUAL(1u, resolver.lookupsCount);
+
+    delay(50);
+    resolver.address = IPAddress(192, 168, 1, 21);
+    cache.refresh("octopi.local");
+    CHECK_EQUAL(2u, resolver.lookupsCount);
+    CHECK(cache.getPinned(ip));
+    CHECK(ip == IPAddress(192, 168, 1, 21));
+
+    // the refreshed address starts a new TTL
+    delay(60);
+    CHECK(cache.getPinned(ip));
+}
+
+TEST(failedRefreshKeepsThePinnedAddress) {
+    FakeHostResolver resolver;
+    internal::HostCache cache = cacheWith(resolver, 200, 1000, 180);
+    IPAddress ip;
+
+    CHECK(cache.lookup("octopi.local", ip));
+    delay(30);
+    resolver.isFailing = true;
+    cache.refresh("octopi.local");
+    CHECK_EQUAL(2u, resolver.lookupsCount);
+    CHECK(cache.getPinned(ip));
+    CHECK(ip == IPAddress(192, 168, 1, 20));
+
+    // retried after the negative TTL only
+    cache.refresh("octopi.local");
+    CHECK_EQUAL(2u, resolver.lookupsCount);
+    CHECK(cache.lookup("octopi.local", ip));
+    CHECK_EQUAL(2u, resolver.lookupsCount);
+}
@@ -0,0 +1,245 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "HttpResponseParser.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+using namespace octoprint::internal;
+
+namespace {
+
+struct StringBodySink : public BodySink {
+    bool write(const char *data, size_t length) override {
+        body.append(data, length);
+        return true;
+    }
+
+    std::string body;
+};
+
+/** Feeds the response in parts of partLength bytes, like packets arriving one by one. */
+size_t feedSplit(HttpResponseParser &parser, const std::string &response, size_t partLength, BodySink &sink) {
+    size_t consumed = 0;
+    for (size_t begin = 0; begin < response.size() && !parser.isComplete(); begin += partLength) {
+        const size_t length = (response.size() - begin < partLength) ? response.size() - begin : partLength;
+        consumed += parser.feed(response.data() + begin, length, &sink);
+    }
+    return consumed;
+}
+
+} // namespace
+
+TEST(contentLengthBodyFedBytewise) {
+    const std::string response = "HTTP/1.1 200 OK\r\n"
+                                 "Content-Type: application/json\r\n"
+                                 "Content-Length: 13\r\n"
+                                 "ETag: \"abc\"\r\n"
+                                 "Last-Modified: Wed, 21 Oct 2015 07:28:00 GMT\r\n"
+                                 "\r\n"
+                                 "{\"api\":\"0.1\"}";
+    for (size_t partLength : {1, 2, 7, 64, 1024}) {
+        HttpResponseParser parser;
+        StringBodySink sink;
+        CHECK_EQUAL(response.size(), feedSplit(parser, response, partLength, sink));
+        CHECK(parser.isComplete());
+        CHECK_EQUAL(200, parser.getStatusCode());
+        CHECK_EQUAL(13L, parser.getContentLength());
+        CHECK_STRING("{\"api\":\"0.1\"}", sink.body);
+        CHECK_STRING("\"abc\"", parser.getEtag());
+        CHECK_STRING("Wed, 21 Oct 2015 07:28:00 GMT", parser.getLastModified());
+        CHECK(!parser.isConnectionClosing());
+        CHECK(!parser.isBodyTruncated());
+    }
+}
+
+TEST(bytesBeyondTheResponseAreNotConsumed) {
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nokHTTP/1.1";
+    HttpResponseParser parser;
+    StringBodySink sink;
+    CHECK_EQUAL(response.size() - 8, parser.feed(response.data(), response.size(), &sink));
+    CHECK_STRING("ok", sink.body);
+}
+
+TEST(withoutSinkTheParserStopsAfterTheHeaders) {
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+    HttpResponseParser parser;
+    CHECK_EQUAL(response.size() - 2, parser.feed(response.data(), response.size(), nullptr));
+    CHECK(parser.isHeaderComplete());
+    CHECK(!parser.isComplete());
+}
+
+TEST(chunkedBodyWithExtensionsAndTrailers) {
+    const std::string response = "HTTP/1.1 200 OK\r\n"
+                                 "Transfer-Encoding: gzip, Chunked\r\n"
+                                 "\r\n"
+                                 "5;name=value\r\nhello\r\n"
+                                 "19\r\n, chunked world of bytes!\r\n"
+                                 "0\r\n"
+                                 "X-Trailer: 1\r\n"
+                                 "X-Other: 2\r\n"
+                                 "\r\n";
+    for (size_t partLength : {1, 3, 16, 1024}) {
+        HttpResponseParser parser;
+        StringBodySink sink;
+        CHECK_EQUAL(response.size(), feedSplit(parser, response, partLength, sink));
+        CHECK(parser.isComplete());
+        CHECK(parser.isChunked());
+        CHECK_STRING("hello, chunked world of bytes!", sink.body);
+        CHECK_EQUAL(30UL, parser.getBodyLength());
+    }
+}
+
+TEST(chunkedBodyWithoutTrailers) {
+    const std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nok\r\n0\r\n\r\n";
+    HttpResponseParser parser;
+    StringBodySink sink;
+    parser.feed(response.data(), response.size(), &sink);
+    CHECK(parser.isComplete());
+    CHECK_STRING("ok", sink.body);
+}
+
+TEST(chunkSizeAboveTheLimitIsMalformed) {
+    // 0x0FFFFFFF is the largest chunk accepted, it keeps the size within 32 bits
+    const std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n10000000\r\n";
+    HttpResponseParser parser;
+    StringBodySink sink;
+    parser.feed(response.data(), response.size(), &sink);
+    CHECK_EQUAL(HttpResponseParser::State::Malformed, parser.getState());
+
+    const std::string largest = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nFFFFFFF\r\nabc";
+    HttpResponseParser accepting;
+    accepting.feed(largest.data(), largest.size(), &sink);
+    CHECK_EQUAL(HttpResponseParser::State::Body, accepting.getState());
+}
+
+TEST(invalidChunkSizeIsMalformed) {
+    const std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n";
+    HttpResponseParser parser;
+    StringBodySink sink;
+    parser.feed(response.data(), response.size(), &sink);
+    CHECK_EQUAL(HttpResponseParser::State::Malformed, parser.getState());
+}
+
+TEST(interimResponsesAreSkipped) {
+    const std::string response = "HTTP/1.1 100 Continue\r\n\r\n"
+                                 "HTTP/1.1 102 Processing\r\nX-Progress: 1\r\n\r\n"
+                                 "HTTP/1.1 201 Created\r\nContent-Length: 4\r\n\r\ndone";
+    for (size_t partLength : {1, 1024}) {
+        HttpResponseParser parser;
+        StringBodySink sink;
+        feedSplit(parser, response, partLength, sink);
+        CHECK(parser.isComplete());
+        CHECK_EQUAL(201, parser.getStatusCode());
+        CHECK_STRING("done", sink.body);
+    }
+}
+
+TEST(connectionCloseOfAnInterimResponseIsKept) {
+    const std::string response = "HTTP/1.1 100 Continue\r\nConnection: close\r\n\r\n"
+                                 "HTTP/1.1 204 No Content\r\n\r\n";
+    HttpResponseParser parser;
+    StringBodySink sink;
+    parser.feed(response.data(), response.size(), &sink);
+    CHECK(parser.isComplete());
+    CHECK(parser.isConnectionClosing());
+}
+
+TEST(connectionClosing) {
+    struct Case {
+        const char *response;
+        bool isClosing;
+    };
+    const Case cases[] = {
+            {"HTTP/1.1 204 No Content\r\nConnection: close\r\n\r\n", true},
+            {"HTTP/1.1 204 No Content\r\nconnection: Keep-Alive, CLOSE\r\n\r\n", true},
+            {"HTTP/1.1 204 No Content\r\n\r\n", false},
+            {"HTTP/1.0 204 No Content\r\n\r\n", true},
+            {"HTTP/1.0 204 No Content\r\nConnection: keep-alive\r\n\r\n", false},
+    };
+    for (const Case &testCase : cases) {
+        HttpResponseParser parser;
+        StringBodySink sink;
+        parser.feed(testCase.response, strlen(testCase.response), &sink);
+        CHECK(parser.isComplete());
+        CHECK_EQUAL(testCase.isClosing, parser.isConnectionClosing());
+    }
+}
+
+TEST(bodyWithoutLengthEndsWithTheConnection) {
+    const std::string response = "HTTP/1.1 200 OK\r\n\r\npartial";
+    HttpResponseParser parser;
+    StringBodySink sink;
+    parser.feed(response.data(), response.size(), &sink);
+    CHECK(!parser.isComplete());
+    CHECK(parser.isConnectionClosing());
+    parser.onConnectionClosed();
+    CHECK(parser.isComplete());
+    CHECK_STRING("partial", sink.body);
+}
+
+TEST(noBodyFor304And204) {
+    for (const char *response : {"HTTP/1.1 304 Not Modified\r\nContent-Length: 120\r\n\r\n",
+                                 "HTTP/1.1 204 No Content\r\n\r\n",
+                                 "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n"}) {
+        HttpResponseParser parser;
+        StringBodySink sink;
+        CHECK_EQUAL(strlen(response), parser.feed(response, strlen(response), &sink));
+        CHECK(parser.isComplete());
+        CHECK(sink.body.empty());
+    }
+}
+
+TEST(overlongHeaderLinesAreCut) {
+    // the value of the long header runs past maxLineLength, the headers after it are still read
+    const std::string response = "HTTP/1.1 200 OK\r\n"
+                                 "X-Padding: " + std::string(300, 'x') + "\r\n"
+                                 "ETag: \"" + std::string(100, 'e') + "\"\r\n"
+                                 "Content-Length: 2\r\n"
+                                 "\r\n"
+                                 "ok";
+    HttpResponseParser parser;
+    StringBodySink sink;
+    CHECK_EQUAL(response.size(), feedSplit(parser, response, 5, sink));
+    CHECK(parser.isComplete());
+    CHECK_EQUAL(2L, parser.getContentLength());
+    CHECK_STRING("ok", sink.body);
+    CHECK_EQUAL(static_cast<size_t>(HttpResponseParser::maxEtagLength), strlen(parser.getEtag()));
+}
+
+TEST(malformedStatusLine) {
+    for (const char *response : {"SSH-2.0-OpenSSH\r\n", "HTTP/1.1 2x0 OK\r\n", "HTTP/1.1\r\n"}) {
+        HttpResponseParser parser;
+        StringBodySink sink;
+        parser.feed(response, strlen(response), &sink);
+        CHECK_EQUAL(HttpResponseParser::State::Malformed, parser.getState());
+        CHECK(!parser.isHeaderComplete());
+    }
+}
+
+TEST(droppedBytesMarkTheBodyTruncated) {
+    struct RefusingSink : public BodySink {
+        bool write(const char *, size_t) override {
+            return false;
+        }
+    } sink;
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabc";
+    HttpResponseParser parser;
+    CHECK_EQUAL(response.size(), parser.feed(response.data(), response.size(), &sink));
+    CHECK(parser.isComplete());
+    CHECK(parser.isBodyTruncated());
+}
+
+TEST(resetForgetsThePreviousResponse) {
+    const std::string response = "HTTP/1.1 200 OK\r\nETag: \"x\"\r\nConnection: close\r\nContent-Length: 1\r\n\r\na";
+    HttpResponseParser parser;
+    StringBodySink sink;
+    parser.feed(response.data(), response.size(), &sink);
+    parser.reset();
+    CHECK_EQUAL(HttpResponseParser::State::StatusLine, parser.getState());
+    CHECK_EQUAL(0, parser.getStatusCode());
+    CHECK_STRING("", parser.getEtag());
+    CHECK(!parser.isConnectionClosing());
+    CHECK_EQUAL(0UL, parser.getBodyLength());
+}
@@ -0,0 +1,268 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "HttpResponseReader.h"
+#include "ScriptedClient.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+using namespace octoprint::internal;
+using octoprint::test::ScriptedClient;
+
+namespace {
+
+constexpr unsigned long timeoutMs = 50;
+
+struct StringBodySink : public BodySink {
+    bool write(const char *data, size_t length) override {
+        body.append(data, length);
+        return true;
+    }
+
+    std::string body;
+};
+
+/** Reads headers and body in blocking mode. */
+RequestOutcome readResponse(HttpResponseReader &reader, BodySink &sink) {
+    const RequestOutcome outcome = reader.readHeaders();
+    if (outcome != RequestOutcome::InProgress) return outcome;
+    return reader.readBody(sink);
+}
+
+/** Reads the decoded body through the Stream interface. */
+std::string readStream(HttpResponseReader &reader) {
+    std::string body;
+    for (int c = reader.read(); c >= 0; c = reader.read()) body += static_cast<char>(c);
+    return body;
+}
+
+const std::string chunkedResponse = "HTTP/1.1 200 OK\r\n"
+                                    "Transfer-Encoding: chunked\r\n"
+                                    "\r\n"
+                                    "4;ext=1\r\n{\"a\"\r\n"
+                                    "6\r\n:[1,2]\r\n"
+                                    "1\r\n}\r\n"
+                                    "0\r\n"
+                                    "Expires: never\r\n"
+                                    "\r\n";
+
+} // namespace
+
+TEST(completeResponseSplitIntoBytes) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    client.receiveSplit("HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello", 1);
+    char buffer[16];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+    CHECK_EQUAL(200, reader.getParser().getStatusCode());
+    CHECK_STRING("hello", sink.body);
+    CHECK_EQUAL(43UL, reader.getBytesReceived());
+}
+
+TEST(headersAndBodyInOneRead) {
+    ScriptedClient client;
+    client.receive("HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\n\r\nnot found");
+    char buffer[256];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+    CHECK_EQUAL(404, reader.getParser().getStatusCode());
+    CHECK_STRING("not found", sink.body);
+}
+
+TEST(chunkedBodyWithTrailers) {
+    for (size_t partLength : {1, 5, 1024}) {
+        ScriptedClient client;
+        client.setClosingWhenDrained(false);
+        client.receiveSplit(chunkedResponse, partLength);
+        char buffer[32];
+        HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+        StringBodySink sink;
+        CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+        CHECK_STRING("{\"a\":[1,2]}", sink.body);
+    }
+}
+
+TEST(chunkedBodyThroughTheStream) {
+    for (size_t partLength : {1, 7, 1024}) {
+        ScriptedClient client;
+        client.setClosingWhenDrained(false);
+        client.receiveSplit(chunkedResponse, partLength);
+        char buffer[16];
+        HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+        CHECK_EQUAL(RequestOutcome::InProgress, reader.readHeaders());
+        CHECK_STRING("{\"a\":[1,2]}", readStream(reader));
+        CHECK(reader.getParser().isComplete());
+        CHECK_EQUAL(-1, reader.peek());
+    }
+}
+
+TEST(bodyAfterStreamReadsIsNotRepeated) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    client.receiveSplit("HTTP/1.1 200 OK\r\nContent-Length: 6\r\n\r\nabcdef", 40);
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    CHECK_EQUAL(RequestOutcome::InProgress, reader.readHeaders());
+    CHECK_EQUAL('a', reader.read());
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::Complete, reader.readBody(sink));
+    CHECK_STRING("bcdef", sink.body);
+}
+
+TEST(interimResponseIsSkipped) {
+    ScriptedClient client;
+    client.receive("HTTP/1.1 100 Continue\r\n\r\n");
+    client.receive("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+    CHECK_EQUAL(200, reader.getParser().getStatusCode());
+    CHECK_STRING("ok", sink.body);
+}
+
+TEST(notModifiedCompletesWithTheHeaders) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    client.receive("HTTP/1.1 304 Not Modified\r\nETag: \"v1\"\r\n\r\n");
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    CHECK_EQUAL(RequestOutcome::Complete, reader.readHeaders());
+    CHECK_EQUAL(304, reader.getParser().getStatusCode());
+    CHECK_STRING("\"v1\"", reader.getParser().getEtag());
+}
+
+TEST(connectionCloseIsReported) {
+    ScriptedClient client;
+    client.receive("HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 2\r\n\r\nok");
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+    CHECK(reader.getParser().isConnectionClosing());
+}
+
+TEST(bodyUntilCloseCompletesOnClose) {
+    ScriptedClient client;
+    client.receive("HTTP/1.0 200 OK\r\n\r\nfirst ");
+    client.receive("second");
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+    CHECK_STRING("first second", sink.body);
+}
+
+TEST(closeBeforeTheResponseCompleted) {
+    ScriptedClient inHeaders;
+    inHeaders.receive("HTTP/1.1 200 OK\r\nContent-Le");
+    char buffer[64];
+    HttpResponseReader headersReader(inHeaders, buffer, sizeof(buffer), timeoutMs);
+    CHECK_EQUAL(RequestOutcome::ConnectionClosed, headersReader.readHeaders());
+
+    ScriptedClient inBody;
+    inBody.receive("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort");
+    HttpResponseReader bodyReader(inBody, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::ConnectionClosed, readResponse(bodyReader, sink));
+    CHECK_STRING("short", sink.body);
+}
+
+TEST(silentServerTimesOut) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    client.receive("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort");
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    const unsigned long startMs = millis();
+    CHECK_EQUAL(RequestOutcome::Timeout, readResponse(reader, sink));
+    CHECK(millis() - startMs >= timeoutMs);
+    CHECK_STRING("short", sink.body);
+
+    // the stream gives up at the same deadline
+    ScriptedClient streamClient;
+    streamClient.setClosingWhenDrained(false);
+    streamClient.receive("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nab");
+    HttpResponseReader streamReader(streamClient, buffer, sizeof(buffer), timeoutMs);
+    CHECK_EQUAL(RequestOutcome::InProgress, streamReader.readHeaders());
+    CHECK_STRING("ab", readStream(streamReader));
+}
+
+TEST(truncatedBodyIsReported) {
+    ScriptedClient client;
+    client.receive("HTTP/1.1 200 OK\r\nContent-Length: 11\r\n\r\nhello world");
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    char body[6];
+    BufferBodySink sink(body, sizeof(body));
+    CHECK_EQUAL(RequestOutcome::Truncated, readResponse(reader, sink));
+    CHECK_STRING("hello", sink.c_str());
+}
+
+TEST(oversizedHeaderLinesAreSkipped) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    client.receiveSplit("HTTP/1.1 200 OK\r\n"
+                        "Set-Cookie: session=" + std::string(500, 's') + "\r\n"
+                        "Content-Length: 2\r\n"
+                        "\r\n"
+                        "ok", 64);
+    char buffer[32];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+    CHECK_STRING("ok", sink.body);
+}
+
+TEST(malformedResponse) {
+    ScriptedClient client;
+    client.receive("220 smtp.example.com ESMTP\r\n");
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    CHECK_EQUAL(RequestOutcome::Malformed, reader.readHeaders());
+}
+
+TEST(nonBlockingReadsReturnWhileWaiting) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), 1000);
+    reader.setBlocking(false);
+    CHECK_EQUAL(RequestOutcome::InProgress, reader.readHeaders());
+
+    client.receive("HTTP/1.1 200 OK\r\nContent-");
+    CHECK_EQUAL(RequestOutcome::InProgress, reader.readHeaders());
+    CHECK(!reader.getParser().isHeaderComplete());
+
+    client.receive("Length: 4\r\n\r\nab");
+    CHECK_EQUAL(RequestOutcome::InProgress, reader.readHeaders());
+    CHECK(reader.getParser().isHeaderComplete());
+
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::InProgress, reader.readBody(sink));
+    client.receive("cd");
+    CHECK_EQUAL(RequestOutcome::Complete, reader.readBody(sink));
+    CHECK_STRING("abcd", sink.body);
+}
+
+TEST(resetRestartsForTheNextResponse) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    client.receive("HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\na");
+    char buffer[64];
+    HttpResponseReader reader(client, buffer, sizeof(buffer), timeoutMs);
+    StringBodySink sink;
+    CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+
+    client.receive("HTTP/1.1 201 Created\r\nContent-Length: 1\r\n\r\nb");
+    reader.reset();
+    CHECK_EQUAL(0UL, reader.getBytesReceived());
+    CHECK_EQUAL(RequestOutcome::Complete, readResponse(reader, sink));
+    CHECK_EQUAL(201, reader.getParser().getStatusCode());
+    CHECK_STRING("ab", sink.body);
+}
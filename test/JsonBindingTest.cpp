@@ -0,0 +1,119 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "JsonBinding.h"
+#include "TestSupport.h"
+
+using namespace octoprint::internal;
+
+namespace {
+
+enum class Light : uint8_t {
+    None = 0,
+    Red = 1,
+    Green = 2,
+    Blue = 4
+};
+
+Light lights(uint8_t bits) {
+    return static_cast<Light>(bits);
+}
+
+struct Lamp {
+    Light lights{Light::None};
+    float level{-1};
+    String label{"unset"};
+    long count{-1};
+};
+
+template<Light light>
+void bindLight(Lamp &target, JsonVariantConst value, bool &isChanged) {
+    bindFlag<Lamp, Light, &Lamp::lights, light>(target, value, isChanged);
+}
+
+constexpr JsonBinding<Lamp> colorBindings[] = {
+        {"red", &bindLight<Light::Red>},
+        {"green", &bindLight<Light::Green>},
+        {"blue", &bindLight<Light::Blue>},
+};
+constexpr JsonBinding<Lamp> detailBindings[] = {
+        {"count", &bindValue<Lamp, long, &Lamp::count>},
+};
+constexpr JsonBinding<Lamp> lampBindings[] = {
+        {"colors", colorBindings},
+        {"label", &bindText<Lamp, &Lamp::label>},
+        {"level", &bindValue<Lamp, float, &Lamp::level>},
+        {"detail", detailBindings},
+};
+
+/** @return true if any field changed */
+bool apply(const char *json, Lamp &lamp, bool isMissingApplied = true) {
+    StaticJsonDocument<512> document;
+    CHECK(!deserializeJson(document, json));
+    return applyBindings(document.as<JsonObjectConst>(), lampBindings, lamp, isMissingApplied);
+}
+
+} // namespace
+
+TEST(membersAreAppliedByKey) {
+    Lamp lamp;
+    CHECK(apply(R"({"unknown":[1,{"label":"no"}],"level":0.5,"detail":{"count":3,"more":1},"label":"desk"})", lamp));
+    CHECK_NEAR(0.5, lamp.level, 1e-6);
+    CHECK_STRING("desk", lamp.label.c_str());
+    CHECK_EQUAL(3L, lamp.count);
+    // the missing colors are applied as null, which clears them
+    CHECK_EQUAL(Light::None, lamp.lights);
+
+    CHECK(!apply(R"({"level":0.5,"detail":{"count":3},"label":"desk","colors":{}})", lamp));
+}
+
+TEST(flagsAreOredAndCleared) {
+    Lamp lamp;
+    CHECK(apply(R"({"colors":{"red":true,"green":true,"blue":false}})", lamp, false));
+    CHECK_EQUAL(lights(1 | 2), lamp.lights);
+
+    CHECK(apply(R"({"colors":{"blue":true,"red":false}})", lamp, false));
+    // green is missing from the colors, which clears it as well
+    CHECK_EQUAL(Light::Blue, lamp.lights);
+
+    CHECK(!apply(R"({"colors":{"blue":true}})", lamp, false));
+    CHECK(apply(R"({"colors":{"red":1,"green":"yes","blue":null}})", lamp, false));
+    CHECK_EQUAL(Light::Red, lamp.lights);
+}
+
+TEST(missingNestedObjectsAreAppliedAsNull) {
+    Lamp lamp;
+    lamp.lights = lights(1 | 4);
+    lamp.count = 7;
+    CHECK(apply(R"({"colors":null,"detail":{}})", lamp, false));
+    CHECK_EQUAL(Light::None, lamp.lights);
+    CHECK_EQUAL(0L, lamp.count);
+    // missing members of the applied object itself are left
+    CHECK_NEAR(-1, lamp.level, 1e-6);
+    CHECK_STRING("unset", lamp.label.c_str());
+
+    lamp.count = 7;
+    lamp.lights = Light::Green;
+    CHECK(apply("{}", lamp));
+    CHECK_EQUAL(Light::None, lamp.lights);
+    CHECK_EQUAL(0L, lamp.count);
+    CHECK_NEAR(0, lamp.level, 1e-6);
+    CHECK_STRING("", lamp.label.c_str());
+}
+
+TEST(nonObjectAppliesAllMembersAsNull) {
+    Lamp lamp;
+    lamp.count = 7;
+    CHECK(apply(R"({"detail":[1,2]})", lamp, false));
+    CHECK_EQUAL(0L, lamp.count);
+}
+
+TEST(filterSelectsTheBoundMembers) {
+    StaticJsonDocument<512> filter;
+    selectBindings(filter.to<JsonObject>(), lampBindings);
+    std::string text;
+    serializeJson(filter, text);
+    CHECK_STRING(R"({"colors":{"red":true,"green":true,"blue":true},"label":true,"level":true,)"
+                 R"("detail":{"count":true}})", text);
+}
@@ -0,0 +1,108 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "MotionChannel.h"
+#include "ScriptedServer.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+using octoprint::test::ScriptedServer;
+using octoprint::test::response;
+
+namespace {
+
+void pollUntilIdle(MotionChannel &motion) {
+    while (motion.poll()) {
+        yield();
+    }
+}
+
+} // namespace
+
+TEST(jogsAreMergedIntoOneRequest) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    MotionChannel motion(printer);
+    server.answer(response(204, ""));
+
+    motion.jog(0.1f, 0, 0);
+    motion.jog(0.1f, -0.25f, 0);
+    motion.jog(0.1f, 0, 2);
+    pollUntilIdle(motion);
+
+    CHECK_EQUAL(1u, server.requests.size());
+    CHECK_STRING("POST /api/printer/printhead HTTP/1.1", server.requestLine(0));
+    CHECK_STRING(R"({"command": "jog", "x": 0.300, "y": -0.250, "z": 2.000, "absolute": false})",
+                 server.requestBody(0));
+    CHECK_EQUAL(1u, motion.getSentCount());
+}
+
+TEST(movesCancellingOutSendNothing) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    MotionChannel motion(printer);
+
+    // summed as floats 0.1 three times minus 0.3 is not 0
+    for (int step = 0; step < 3; step++) motion.jog(0.1f, 0, 0);
+    motion.jog(-0.3f, 0, 0);
+    motion.extrude(0.7f);
+    motion.extrude(-0.7f);
+    pollUntilIdle(motion);
+
+    CHECK(server.requests.empty());
+    CHECK_EQUAL(0u, motion.getSentCount());
+}
+
+TEST(extrusionIsSentInMillimetres) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    MotionChannel motion(printer);
+    server.answer(response(204, ""));
+
+    motion.extrude(1.5f);
+    motion.extrude(-0.0004f);
+    motion.extrude(0.001f);
+    pollUntilIdle(motion);
+
+    CHECK_EQUAL(1u, server.requests.size());
+    CHECK_STRING("POST /api/printer/tool HTTP/1.1", server.requestLine(0));
+    CHECK_STRING(R"({"command": "extrude", "amount": 1.501})", server.requestBody(0));
+}
+
+TEST(staleTimeIsAtLeastTwoIntervals) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    MotionSettings settings;
+    settings.intervalMs = 50;
+    settings.staleMs = 10;
+    MotionChannel motion(printer, settings);
+    server.answer(response(204, ""));
+    server.answer(response(204, ""));
+
+    motion.jog(1, 0, 0);
+    pollUntilIdle(motion);
+    // waits for the next interval, longer than the configured stale time
+    motion.jog(2, 0, 0);
+    pollUntilIdle(motion);
+
+    CHECK_EQUAL(0u, motion.getDroppedCount());
+    CHECK_EQUAL(2u, motion.getSentCount());
+    CHECK_EQUAL(2u, server.requests.size());
+}
+
+TEST(requestOfOtherCodeIsDrivenFirst) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    MotionChannel motion(printer);
+    server.answer(response(200, R"({"job":{},"progress":{},"state":"Operational"})"));
+    server.answer(response(204, ""));
+
+    CHECK(printer.request(Operation::FetchPrintJob));
+    motion.jog(1, 0, 0);
+    pollUntilIdle(motion);
+
+    CHECK_EQUAL(2u, server.requests.size());
+    CHECK_STRING("GET /api/job HTTP/1.1", server.requestLine(0));
+    CHECK_STRING("POST /api/printer/printhead HTTP/1.1", server.requestLine(1));
+}
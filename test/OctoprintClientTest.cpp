@@ -0,0 +1,521 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "FakeHostResolver.h"
+#include "OctoprintClient.h"
+#include "ScriptedServer.h"
+#include "StringStream.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+using octoprint::test::FakeHostResolver;
+using octoprint::test::ScriptedServer;
+using octoprint::test::StringStream;
+using octoprint::test::response;
+
+TEST(unchangedFolderIsAnsweredWith304) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    StaticFileIndex<4> index;
+
+    server.answer(response(200, R"({"files":[{"path":"a.gcode","type":"machinecode","size":12}]})",
+                           "ETag: \"v1\"\r\n"));
+    CHECK(printer.fetchFiles(index));
+    CHECK_EQUAL(1, index.size());
+    CHECK_EQUAL(1u, index.getGeneration());
+    CHECK(!server.hasHeader(0, "If-None-Match: \"v1\""));
+
+    server.answer("HTTP/1.1 304 Not Modified\r\nETag: \"v1\"\r\n\r\n");
+    CHECK(printer.fetchFiles(index));
+    CHECK(server.hasHeader(1, "If-None-Match: \"v1\""));
+    CHECK_EQUAL(304, printer.getRequestStatus().httpStatusCode);
+    CHECK_EQUAL(1, index.size());
+    CHECK_EQUAL(1u, index.getGeneration());
+    CHECK_STRING("a.gcode", index[0].path);
+
+    // another page has to be listed again
+    index.setPageOffset(1);
+    server.answer(response(200, R"({"files":[{"path":"a.gcode"},{"path":"b.gcode"}]})", "ETag: \"v1\"\r\n"));
+    CHECK(printer.fetchFiles(index));
+    CHECK(!server.hasHeader(2, "If-None-Match: \"v1\""));
+    CHECK_EQUAL(2u, index.getGeneration());
+    CHECK_EQUAL(1, index.size());
+    CHECK_STRING("b.gcode", index[0].path);
+}
+
+TEST(toolTargetsArePostedTogetherBeforeBedAndChamber) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    for (unsigned idx = 0; idx < 3; idx++) server.answer(response(204, ""));
+
+    CHECK(printer.setTargets({{"bed", 60}, {"tool0", 215}, {"chamber", 40}, {"tool1", 170}}));
+    CHECK_EQUAL(3u, server.requests.size());
+    CHECK_STRING("POST /api/printer/tool HTTP/1.1", server.requestLine(0));
+    CHECK_STRING(R"({ "command": "target", "targets": { "tool0": 215, "tool1": 170 } })", server.requestBody(0));
+    CHECK_STRING("POST /api/printer/bed HTTP/1.1", server.requestLine(1));
+    CHECK_STRING(R"({ "command": "target", "target": 60 })", server.requestBody(1));
+    CHECK_STRING("POST /api/printer/chamber HTTP/1.1", server.requestLine(2));
+}
+
+TEST(targetsFailingValidationSendNothing) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+
+    CHECK(!printer.setTargets({{"bed", 60}, {"extruder", 200}}));
+    CHECK(!printer.setTargets({{"bed", 60}, {"tool", 200}}));
+
+    // more tools than fit into the request body
+    HeaterTarget targets[24];
+    const char *names[] = {"tool0", "tool1", "tool2", "tool3", "tool4", "tool5", "tool6", "tool7",
+                           "tool8", "tool9", "tool10", "tool11", "tool12", "tool13", "tool14", "tool15",
+                           "tool16", "tool17", "tool18", "tool19", "tool20", "tool21", "tool22", "bed"};
+    for (uint8_t idx = 0; idx < 24; idx++) targets[idx] = HeaterTarget{names[idx], 200};
+    CHECK(!printer.setTargets(targets));
+    CHECK_EQUAL(0u, server.requests.size());
+}
+
+TEST(failedBedPostIsReported) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    server.answer(response(204, ""));
+    server.answer(response(409, "no heated bed"));
+
+    CHECK(!printer.setTargets({{"tool0", 215}, {"bed", 60}}));
+    CHECK_EQUAL(2u, server.requests.size());
+    CHECK_STRING("POST /api/printer/tool HTTP/1.1", server.requestLine(0));
+}
+
+TEST(connectMetricsOnlyForEstablishedConnections) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    RequestMetrics metrics;
+    printer.setMetrics(&metrics);
+    printer.setConnectionReuse(true);
+
+    server.connection.connectResult = 0;
+    CHECK(!printer.printerCommand("M115"));
+    const EndpointMetrics &posts = metrics.get(Operation::Post);
+    CHECK_EQUAL(1u, posts.connectionFailures);
+    CHECK_EQUAL(0u, posts.connects);
+    CHECK_EQUAL(0u, posts.connectUsTotal);
+
+    server.connection.connectResult = 1;
+    server.answer(response(204, ""));
+    server.answer(response(204, ""));
+    CHECK(printer.printerCommand("M115"));
+    CHECK(printer.printerCommand("M115"));
+    // the second one reused the connection
+    CHECK_EQUAL(3u, posts.requests);
+    CHECK_EQUAL(1u, posts.connects);
+}
+
+TEST(notModifiedIsNoHttpError) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    RequestMetrics metrics;
+    printer.setMetrics(&metrics);
+    StaticFileIndex<1> index;
+
+    server.answer(response(200, R"({"files":[]})", "ETag: \"v1\"\r\n"));
+    server.answer("HTTP/1.1 304 Not Modified\r\n\r\n");
+    server.answer(response(404, ""));
+    CHECK(printer.fetchFiles(index));
+    CHECK(printer.fetchFiles(index));
+    CHECK(!printer.fetchFiles(index));
+    CHECK_EQUAL(3u, metrics.get(Operation::FetchFiles).requests);
+    CHECK_EQUAL(1u, metrics.get(Operation::FetchFiles).httpErrors);
+}
+
+namespace {
+
+std::string printerBody(bool isPrinting, float bedActual, float bedTarget) {
+    char text[512];
+    snprintf(text, sizeof(text),
+             R"({"sd":{"ready":true},"state":{"error":"","flags":{"cancelling":false,"closedOrError":false,)"
+             R"("error":false,"finishing":false,"operational":true,"paused":false,"pausing":false,)"
+             R"("printing":%s,"ready":%s,"resuming":false,"sdReady":true},"text":"%s"},)"
+             R"("temperature":{"bed":{"actual":%.1f,"offset":0,"target":%.1f},)"
+             R"("tool0":{"actual":214.8,"offset":0,"target":215.0}}})",
+             isPrinting ? "true" : "false", isPrinting ? "false" : "true", isPrinting ? "Printing" : "Operational",
+             bedActual, bedTarget);
+    return text;
+}
+
+} // namespace
+
+TEST(stateFlagsAreReportedTogether) {
+    using Flags = PrinterState::OperationalStateFlags;
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+
+    server.answer(response(200, printerBody(true, 60.1f, 60.0f)));
+    CHECK(printer.fetchPrinterStatistics());
+    const PrinterState &printerState = printer.getState().printerState;
+    CHECK(printerState.hasState(Flags::Operational));
+    CHECK(printerState.hasState(Flags::Printing));
+    CHECK(printerState.hasState(Flags::SdReady));
+    CHECK(!printerState.hasState(Flags::Ready));
+    CHECK_STRING("Printing", printerState.printerStateText.c_str());
+
+    // a flag reported false clears its bit, the others stay
+    server.answer(response(200, printerBody(false, 60.1f, 60.0f)));
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK(printerState.hasState(Flags::Operational));
+    CHECK(!printerState.hasState(Flags::Printing));
+    CHECK(printerState.hasState(Flags::Ready));
+
+    // flags missing from the response are cleared as if reported false
+    server.answer(response(200, R"({"state":{"flags":{"operational":true},"text":"Operational"},"temperature":{}})"));
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK(printerState.hasState(Flags::Operational));
+    CHECK(!printerState.hasState(Flags::Ready));
+    CHECK(!printerState.hasState(Flags::SdReady));
+}
+
+TEST(bedCurrentAndTargetAreNotMixedUp) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    const PrinterState::Thermal &temperature = printer.getState().printerState.temperature;
+
+    server.answer(response(200, printerBody(true, 58.3f, 65.0f)));
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK_NEAR(58.3, temperature.bedCurrentCelsius, 1e-3);
+    CHECK_NEAR(65.0, temperature.bedTargetCelsius, 1e-3);
+    const PrinterState::Heater *bed = temperature.findHeater("bed");
+    CHECK(bed != nullptr);
+    if (bed != nullptr) {
+        CHECK_NEAR(58.3, bed->currentCelsius, 1e-3);
+        CHECK_NEAR(65.0, bed->targetCelsius, 1e-3);
+    }
+
+    server.answer(response(200, R"({"bed":{"actual":41.5,"offset":2,"target":70.0},)"
+                                R"("history":[{"time":1700000000,"bed":{"actual":41.0,"target":70.0}}]})"));
+    CHECK(printer.fetchPrinterBed());
+    CHECK_NEAR(41.5, temperature.bedCurrentCelsius, 1e-3);
+    CHECK_NEAR(70.0, temperature.bedTargetCelsius, 1e-3);
+    CHECK_NEAR(2.0, temperature.bedOffsetCelsius, 1e-3);
+    CHECK_NEAR(41.0, temperature.bedHistoryTempCurrentCelsius, 1e-3);
+    CHECK_EQUAL(1700000000L, temperature.bedHistoryTempTimestamp);
+    bed = temperature.findHeater("bed");
+    CHECK(bed != nullptr);
+    if (bed != nullptr) {
+        CHECK_NEAR(41.5, bed->currentCelsius, 1e-3);
+        CHECK_NEAR(70.0, bed->targetCelsius, 1e-3);
+    }
+    // the other heaters are not part of the response and keep their temperatures
+    const PrinterState::Heater *tool = temperature.findHeater("tool0");
+    CHECK(tool != nullptr);
+    if (tool != nullptr) CHECK_NEAR(214.8, tool->currentCelsius, 1e-3);
+    CHECK_NEAR(214.8, temperature.tool0CurrentCelsius, 1e-3);
+}
+
+TEST(malformedStatisticsKeepTheStateText) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    const OverallState &state = printer.getState();
+
+    server.answer(response(200, printerBody(true, 60.1f, 60.0f)));
+    CHECK(printer.fetchPrinterStatistics());
+    const uint32_t generation = state.generations.printerState;
+
+    // deserialized from the connection, nothing is left of the body afterwards
+    server.answer(response(200, R"({"state":{"text":"Printing","flags":)"));
+    CHECK(!printer.fetchPrinterStatistics());
+    CHECK_STRING("Printing", state.printerState.printerStateText.c_str());
+    CHECK_EQUAL(generation, state.generations.printerState);
+
+    // error bodies are buffered and are the text OctoPrint wants to show
+    server.answer(response(409, "Printer is not operational"));
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK_STRING("Printer is not operational", state.printerState.printerStateText.c_str());
+    CHECK_EQUAL(generation + 1, state.generations.printerState);
+}
+
+namespace {
+
+const char *const jobBody = R"({"job":{"file":{"name":"a.gcode"}},"progress":{"completion":12.5},"state":"Printing"})";
+
+} // namespace
+
+TEST(freshResponseIsServedWithoutRequest) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    CHECK(printer.setResponseTtl(Operation::FetchPrintJob, 60000));
+    CHECK(!printer.setResponseTtl(Operation::JobStart, 60000));
+    server.answer(response(200, jobBody));
+
+    CHECK(printer.fetchPrintJob());
+    CHECK(printer.fetchPrintJob());
+    CHECK(printer.fetchPrintJob());
+    CHECK_EQUAL(1u, server.requests.size());
+    CHECK_STRING("a.gcode", printer.getState().printJob.jobFileName.c_str());
+}
+
+TEST(expiredResponseIsFetchedAgain) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    CHECK(printer.setResponseTtl(Operation::FetchPrintJob, 20));
+    server.answer(response(200, jobBody));
+    server.answer(response(200, jobBody));
+
+    CHECK(printer.fetchPrintJob());
+    delay(30);
+    CHECK(printer.fetchPrintJob());
+    CHECK_EQUAL(2u, server.requests.size());
+}
+
+TEST(failedResponseIsNotServedFromTheCache) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    CHECK(printer.setResponseTtl(Operation::FetchPrintJob, 60000));
+    server.answer(response(500, "Internal Server Error"));
+    server.answer(response(200, jobBody));
+
+    CHECK(!printer.fetchPrintJob());
+    CHECK(printer.fetchPrintJob());
+    CHECK_EQUAL(2u, server.requests.size());
+}
+
+TEST(postInvalidatesAllCachedResponses) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    CHECK(printer.setResponseTtl(Operation::FetchPrintJob, 60000));
+    CHECK(printer.setResponseTtl(Operation::FetchPrinterStatistics, 60000));
+    server.answer(response(200, jobBody));
+    server.answer(response(200, printerBody(true, 60.1f, 60.0f)));
+    server.answer(response(204, ""));
+    server.answer(response(200, jobBody));
+    server.answer(response(200, printerBody(true, 60.1f, 60.0f)));
+
+    CHECK(printer.fetchPrintJob());
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK(printer.fetchPrintJob());
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK_EQUAL(2u, server.requests.size());
+
+    CHECK(printer.printerCommand("M115"));
+    CHECK(printer.fetchPrintJob());
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK_EQUAL(5u, server.requests.size());
+    CHECK_STRING("GET /api/job HTTP/1.1", server.requestLine(3));
+}
+
+TEST(blockingFetchJoinsTheAsynchronousOneInFlight) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    server.answer(response(200, jobBody));
+    server.answer(response(500, "Internal Server Error"));
+
+    bool isAsyncSuccess = false;
+    CHECK(printer.request(Operation::FetchPrintJob, [&](const RequestStatus &status) {
+        isAsyncSuccess = status.isSuccess;
+    }));
+    CHECK(printer.fetchPrintJob());
+    CHECK(isAsyncSuccess);
+    CHECK_EQUAL(1u, server.requests.size());
+
+    // the joined fetch reports the result of the one in flight
+    CHECK(printer.request(Operation::FetchPrintJob));
+    CHECK(!printer.fetchPrintJob());
+    CHECK_EQUAL(2u, server.requests.size());
+}
+
+TEST(changedPrinterFieldsAreNotJoined) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    server.answer(response(200, printerBody(true, 60.1f, 60.0f)));
+    server.answer(response(200, printerBody(true, 60.1f, 60.0f)));
+
+    CHECK(printer.request(Operation::FetchPrinterStatistics));
+    printer.setPrinterFields(PrinterFields::Temperature);
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK_EQUAL(2u, server.requests.size());
+    CHECK_STRING("GET /api/printer?exclude=sd HTTP/1.1", server.requestLine(0));
+    CHECK_STRING("GET /api/printer?exclude=state,sd HTTP/1.1", server.requestLine(1));
+}
+
+TEST(printerFieldsSelectTheExcludedSections) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    TemperatureHistory<4> history;
+    const struct {
+        PrinterFields fields;
+        bool hasHistory;
+        const char *requestLine;
+    } expectations[] = {
+            {PrinterFields::All, false, "GET /api/printer?exclude=sd HTTP/1.1"},
+            {PrinterFields::State, false, "GET /api/printer?exclude=temperature,sd HTTP/1.1"},
+            {PrinterFields::Temperature, false, "GET /api/printer?exclude=state,sd HTTP/1.1"},
+            {PrinterFields::All, true, "GET /api/printer?exclude=sd&history=true&limit=1 HTTP/1.1"},
+            // without temperatures there is no sample for the history
+            {PrinterFields::State, true, "GET /api/printer?exclude=temperature,sd HTTP/1.1"},
+            {PrinterFields::Temperature, true, "GET /api/printer?exclude=state,sd&history=true&limit=1 HTTP/1.1"},
+    };
+    size_t idx = 0;
+    for (const auto &expectation : expectations) {
+        printer.setPrinterFields(expectation.fields);
+        CHECK(expectation.fields == printer.getPrinterFields());
+        printer.setTemperatureHistory(expectation.hasHistory ? &history : nullptr);
+        server.answer(response(200, printerBody(true, 60.1f, 60.0f)));
+        CHECK(printer.fetchPrinterStatistics());
+        CHECK_STRING(expectation.requestLine, server.requestLine(idx++));
+    }
+}
+
+TEST(excludedPrinterFieldsKeepTheirValues) {
+    using Flags = PrinterState::OperationalStateFlags;
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    const OverallState &state = printer.getState();
+    const PrinterState::Thermal &temperature = state.printerState.temperature;
+
+    server.answer(response(200, printerBody(true, 60.1f, 60.0f)));
+    CHECK(printer.fetchPrinterStatistics());
+
+    printer.setPrinterFields(PrinterFields::Temperature);
+    server.answer(response(200, R"({"temperature":{"bed":{"actual":50.5,"offset":0,"target":55.0},)"
+                                R"("tool0":{"actual":210.2,"offset":0,"target":215.0}}})"));
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK_NEAR(50.5, temperature.bedCurrentCelsius, 1e-3);
+    CHECK_NEAR(55.0, temperature.bedTargetCelsius, 1e-3);
+    CHECK(state.printerState.hasState(Flags::Printing));
+    CHECK(state.printerState.hasState(Flags::Operational));
+    CHECK_STRING("Printing", state.printerState.printerStateText.c_str());
+
+    printer.setPrinterFields(PrinterFields::State);
+    const uint32_t thermalGeneration = state.generations.thermal;
+    server.answer(response(200, R"({"state":{"flags":{"operational":true,"ready":true},"text":"Operational"}})"));
+    CHECK(printer.fetchPrinterStatistics());
+    CHECK(!state.printerState.hasState(Flags::Printing));
+    CHECK(state.printerState.hasState(Flags::Ready));
+    CHECK_STRING("Operational", state.printerState.printerStateText.c_str());
+    CHECK_NEAR(50.5, temperature.bedCurrentCelsius, 1e-3);
+    CHECK_NEAR(55.0, temperature.bedTargetCelsius, 1e-3);
+    const PrinterState::Heater *tool = temperature.findHeater("tool0");
+    CHECK(tool != nullptr);
+    if (tool != nullptr) CHECK_NEAR(210.2, tool->currentCelsius, 1e-3);
+    CHECK_EQUAL(thermalGeneration, state.generations.thermal);
+}
+
+namespace {
+
+// two and a half blocks of maxMessageLengthBytes
+std::string uploadData() {
+    std::string data;
+    for (size_t idx = 0; idx < 2500; idx++) data += (idx % 64 == 63) ? '\n' : static_cast<char>('a' + idx % 26);
+    return data;
+}
+
+std::string uploadBoundaryOf(const std::string &request) {
+    const std::string prefix = "Content-Type: multipart/form-data; boundary=";
+    const size_t begin = request.find(prefix);
+    if (begin == std::string::npos) return "";
+    return request.substr(begin + prefix.size(), request.find("\r\n", begin) - begin - prefix.size());
+}
+
+std::string filePart(const std::string &boundary, const std::string &fileName, const std::string &data) {
+    return "--" + boundary + "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"" + fileName +
+           "\"\r\nContent-Type: application/octet-stream\r\n\r\n" + data + "\r\n";
+}
+
+std::string fieldPart(const std::string &boundary, const std::string &name) {
+    return "--" + boundary + "\r\nContent-Disposition: form-data; name=\"" + name + "\"\r\n\r\ntrue\r\n";
+}
+
+} // namespace
+
+TEST(uploadIsStreamedAsMultipartBlockByBlock) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    server.answer(response(201, R"({"done":true,"files":{"local":{"name":"part.gcode"}}})"));
+    const std::string data = uploadData();
+    StringStream source(data);
+
+    std::vector<UploadProgress> progresses;
+    std::vector<int> unreadBytes;
+    UploadOptions options;
+    options.isPrinted = true;
+    options.progress = [&](const UploadProgress &progress) {
+        progresses.push_back(progress);
+        unreadBytes.push_back(source.available());
+    };
+    CHECK(printer.uploadFile("part.gcode", source, data.size(), options));
+    CHECK_EQUAL(201, printer.getRequestStatus().httpStatusCode);
+
+    CHECK_EQUAL(1u, server.requests.size());
+    CHECK_STRING("POST /api/files/local HTTP/1.1", server.requestLine(0));
+    const std::string boundary = uploadBoundaryOf(server.requests[0]);
+    CHECK(!boundary.empty());
+    CHECK(data.find(boundary) == std::string::npos);
+    // printing implies selecting
+    const std::string body = filePart(boundary, "part.gcode", data) + fieldPart(boundary, "select") +
+                             fieldPart(boundary, "print") + "--" + boundary + "--\r\n";
+    CHECK(server.requestBody(0) == body);
+    CHECK(server.hasHeader(0, "Content-Length: " + std::to_string(body.size())));
+
+    // the source is read one block ahead of the progress, never as a whole
+    CHECK_EQUAL(3u, progresses.size());
+    const size_t expectedSent[] = {1000, 2000, 2500};
+    for (size_t idx = 0; idx < progresses.size() && idx < 3; idx++) {
+        CHECK_EQUAL(expectedSent[idx], progresses[idx].bytesSent);
+        CHECK_EQUAL(data.size(), progresses[idx].totalBytes);
+        CHECK_EQUAL(static_cast<int>(data.size() - expectedSent[idx]), unreadBytes[idx]);
+    }
+}
+
+TEST(uploadSendsOnlyTheRequestedFormFields) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    server.answer(response(201, "{}"));
+    server.answer(response(201, "{}"));
+
+    StringStream selected("G28\n");
+    UploadOptions options;
+    options.isSelected = true;
+    CHECK(printer.uploadFile("a.gcode", selected, 4, options));
+    std::string boundary = uploadBoundaryOf(server.requests[0]);
+    CHECK(server.requestBody(0) ==
+          filePart(boundary, "a.gcode", "G28\n") + fieldPart(boundary, "select") + "--" + boundary + "--\r\n");
+
+    StringStream stored("G28\n");
+    CHECK(printer.uploadFile("b.gcode", stored, 4));
+    boundary = uploadBoundaryOf(server.requests[1]);
+    CHECK(server.requestBody(1) == filePart(boundary, "b.gcode", "G28\n") + "--" + boundary + "--\r\n");
+}
+
+TEST(shortUploadSourceFailsTheUpload) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    server.answer(response(201, "{}"));
+    StringStream source("G28\n");
+    source.setTimeout(10);
+
+    CHECK(!printer.uploadFile("a.gcode", source, 10));
+    CHECK(RequestOutcome::SourceFailed == printer.getRequestStatus().outcome);
+    CHECK(!printer.uploadFile("a\"b.gcode", source, 4));
+}
+
+TEST(failedConnectResolvesTheHostAgain) {
+    ScriptedServer server;
+    FakeHostResolver resolver;
+    OctoprintClient printer("key", server.connection, String("octopi.local"), 5000);
+    printer.setHostResolver(&resolver);
+    server.answer(response(200, jobBody));
+    server.answer(response(200, jobBody));
+
+    CHECK(printer.fetchPrintJob());
+    CHECK_EQUAL(1u, resolver.lookupsCount);
+
+    // the printer moved, connecting to the pinned address fails
+    server.connection.stop();
+    server.connection.connectResult = 0;
+    CHECK(!printer.fetchPrintJob());
+    CHECK_EQUAL(RequestOutcome::ConnectionFailed, printer.getRequestStatus().outcome);
+    CHECK_EQUAL(1u, resolver.lookupsCount);
+
+    server.connection.connectResult = 1;
+    CHECK(printer.fetchPrintJob());
+    CHECK_EQUAL(2u, resolver.lookupsCount);
+    CHECK_EQUAL(2u, server.requests.size());
+}
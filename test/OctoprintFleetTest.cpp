@@ -0,0 +1,161 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "../examples/benchmark/MockOctoprintServer.h"
+#include "OctoprintFleet.h"
+#include "PosixClient.h"
+#include "TestSupport.h"
+#include <arpa/inet.h>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace octoprint;
+
+namespace {
+
+constexpr size_t printersCount = 3;
+
+/** @return a loopback port nothing listens on */
+uint16_t findDeadPort() {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length);
+    close(fd);
+    return ntohs(address.sin_port);
+}
+
+/**
+ * Printers polled by a fleet, those with isDead set point to a port nothing listens on, the others to the mock server.
+ */
+struct FleetFixture {
+
+    FleetFixture(const FleetSettings &settings, const bool (&isDead)[printersCount]) : fleet(settings) {
+        CHECK(server.start());
+        const uint16_t deadPort = findDeadPort();
+        for (size_t idx = 0; idx < printersCount; idx++) {
+            connections.emplace_back(new host::PosixClient());
+            clients.emplace_back(new OctoprintClient("key", *connections.back(), IPAddress(127, 0, 0, 1),
+                                                     isDead[idx] ? deadPort : server.getPort()));
+            clients.back()->setMetrics(&metrics[idx]);
+            fleet.add(*clients.back());
+        }
+    }
+
+    /**
+     * Polls for the duration.
+     * @param onPoll invoked after each poll
+     */
+    template<typename Observer>
+    void run(unsigned long durationMs, Observer onPoll) {
+        const unsigned long startMs = millis();
+        while (millis() - startMs < durationMs) {
+            fleet.poll();
+            onPoll();
+            usleep(100);
+        }
+        // let the requests in flight finish, so that the metrics are complete
+        for (unsigned attempt = 0; attempt < 10000 && fleet.poll() > 0; attempt++) usleep(100);
+    }
+
+    uint32_t requestsOf(size_t idx, Operation operation) const {
+        return metrics[idx].get(operation).requests;
+    }
+
+    benchmark::MockOctoprintServer server;
+    std::vector<std::unique_ptr<host::PosixClient>> connections;
+    std::vector<std::unique_ptr<OctoprintClient>> clients;
+    RequestMetrics metrics[printersCount];
+    OctoprintFleet<printersCount> fleet;
+};
+
+} // namespace
+
+TEST(firstPollsAreSpreadOverTheInterval) {
+    FleetSettings settings;
+    settings.pollIntervalMs = 300;
+    FleetFixture fixture(settings, {false, false, false});
+
+    const unsigned long startMs = millis();
+    unsigned long firstUpdateMs[printersCount]{};
+    fixture.run(250, [&] {
+        for (size_t idx = 0; idx < printersCount; idx++) {
+            if (firstUpdateMs[idx] == 0 && fixture.fleet.getStatus(idx).lastUpdateMs != 0) {
+                firstUpdateMs[idx] = millis() - startMs + 1;
+            }
+        }
+    });
+
+    // due at 0, 100 and 200 ms
+    CHECK(firstUpdateMs[0] > 0 && firstUpdateMs[0] < 80);
+    CHECK(firstUpdateMs[1] >= 100 && firstUpdateMs[1] < 180);
+    CHECK(firstUpdateMs[2] >= 200);
+}
+
+TEST(duePrintersShareTheSlotsRoundRobin) {
+    // every printer is always due, one request at a time
+    FleetSettings settings;
+    settings.pollIntervalMs = 1;
+    settings.maxConcurrentRequests = 1;
+    FleetFixture fixture(settings, {false, false, false});
+    uint8_t maxInFlight = 0;
+    fixture.run(300, [&] {
+        uint8_t inFlight = 0;
+        for (size_t idx = 0; idx < printersCount; idx++) inFlight += fixture.clients[idx]->isBusy() ? 1 : 0;
+        if (inFlight > maxInFlight) maxInFlight = inFlight;
+    });
+
+    CHECK_EQUAL(1, maxInFlight);
+    uint32_t minRequests = UINT32_MAX;
+    uint32_t maxRequests = 0;
+    for (size_t idx = 0; idx < printersCount; idx++) {
+        const uint32_t requests = fixture.requestsOf(idx, Operation::FetchPrinterStatistics) +
+                                  fixture.requestsOf(idx, Operation::FetchPrintJob);
+        if (requests < minRequests) minRequests = requests;
+        if (requests > maxRequests) maxRequests = requests;
+    }
+    CHECK(minRequests >= 10);
+    CHECK(maxRequests - minRequests <= 2);
+}
+
+TEST(unreachablePrinterBacksOffAndRestartsItsCycle) {
+    FleetSettings settings;
+    settings.pollIntervalMs = 50;
+    settings.maxBackoffShift = 2;
+    FleetFixture fixture(settings, {true, false, false});
+    fixture.run(1000, [] {});
+
+    // attempts at 0, 100, 300, 500, 700 and 900 ms instead of every 50 ms
+    const uint32_t deadAttempts = fixture.requestsOf(0, Operation::FetchPrinterStatistics);
+    CHECK(deadAttempts >= 4 && deadAttempts <= 8);
+    CHECK_EQUAL(deadAttempts, fixture.metrics[0].get(Operation::FetchPrinterStatistics).connectionFailures +
+                              fixture.metrics[0].get(Operation::FetchPrinterStatistics).incompleteResponses);
+    // the cycle restarts after the failed first fetch instead of going on with the job
+    CHECK_EQUAL(0u, fixture.requestsOf(0, Operation::FetchPrintJob));
+
+    const FleetPrinterStatus &dead = fixture.fleet.getStatus(0);
+    CHECK(!dead.isReachable);
+    CHECK_EQUAL(deadAttempts, dead.consecutiveFailures);
+    CHECK_EQUAL(0ul, dead.lastUpdateMs);
+
+    for (size_t idx = 1; idx < printersCount; idx++) {
+        const FleetPrinterStatus &live = fixture.fleet.getStatus(idx);
+        CHECK(live.isReachable);
+        CHECK_EQUAL(0, live.consecutiveFailures);
+        CHECK(fixture.requestsOf(idx, Operation::FetchPrinterStatistics) >= 12);
+        CHECK(fixture.requestsOf(idx, Operation::FetchPrintJob) >= 12);
+    }
+
+    const FleetSummary summary = fixture.fleet.summarize();
+    CHECK_EQUAL(3, summary.printers);
+    CHECK_EQUAL(2, summary.reachable);
+    CHECK_EQUAL(2, summary.operational);
+    CHECK_EQUAL(2, summary.printing);
+}
@@ -0,0 +1,93 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "../examples/benchmark/MockOctoprintServer.h"
+#include "OctoprintPushClient.h"
+#include "PosixClient.h"
+#include "TemperatureHistory.h"
+#include "TestSupport.h"
+#include <unistd.h>
+
+using namespace octoprint;
+
+namespace {
+
+using Flags = PrinterState::OperationalStateFlags;
+
+/**
+ * Polls until the condition holds or the time is up.
+ * @return the condition's last result
+ */
+template<typename Condition>
+bool pollUntil(OctoprintPushClient &push, Condition isReached, unsigned long timeoutMs = 5000) {
+    const unsigned long startMs = millis();
+    while (!isReached()) {
+        if (millis() - startMs >= timeoutMs) return false;
+        push.poll();
+        usleep(1000);
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(filterKeepsEverySelectedField) {
+    StaticJsonDocument<internal::pushFilterCapacity> filter;
+    internal::selectPushedFields(filter);
+    CHECK(!filter.overflowed());
+    // the last entries are lost first once the pool runs out
+    CHECK(filter["current"]["progress"]["printTimeLeft"].as<bool>());
+    CHECK(filter["history"]["progress"]["printTimeLeft"].as<bool>());
+    CHECK(filter["current"]["temps"][0]["*"].as<bool>());
+    CHECK(filter["reauthRequired"].as<bool>());
+}
+
+TEST(pushedStateReachesOverallState) {
+    benchmark::MockOctoprintServer server;
+    CHECK(server.start());
+    server.setPush(true, 20);
+    host::PosixClient httpConnection;
+    host::PosixClient pushConnection;
+    OctoprintClient printer("key", httpConnection, IPAddress(127, 0, 0, 1), server.getPort());
+    TemperatureHistory<120> history;
+    printer.setTemperatureHistory(&history);
+    OctoprintPushClient push(printer, pushConnection);
+
+    CHECK(pollUntil(push, [&] { return push.isPushActive(); }));
+    // polled responses report a print time of 3762 s, pushed ones count up from 60 s
+    const uint32_t thermalGeneration = printer.getState().generations.thermal;
+    CHECK(pollUntil(push, [&] {
+        const long printTime = printer.getState().printJob.progressPrintTime;
+        return printer.getState().generations.thermal > thermalGeneration && printTime > 60 && printTime < 1000;
+    }));
+    CHECK(push.isPushActive());
+
+    const OverallState &state = printer.getState();
+    CHECK_STRING("Printing", state.printerState.printerStateText.c_str());
+    CHECK(state.printerState.hasState(Flags::Printing));
+    CHECK(state.printerState.hasState(Flags::Operational));
+    CHECK(state.printerState.hasState(Flags::SdReady));
+    CHECK(!state.printerState.hasState(Flags::Paused));
+
+    CHECK_STRING("benchy.gcode", state.printJob.jobFileName.c_str());
+    CHECK_EQUAL(3528451L, state.printJob.jobFileSize);
+    CHECK_EQUAL(state.printJob.progressPrintTime * 1000, state.printJob.progressFilepos);
+    CHECK_NEAR(state.printJob.progressPrintTime / 10.0, state.printJob.progressCompletion, 0.05);
+
+    const PrinterState::Heater *bed = state.printerState.temperature.findHeater("bed");
+    const PrinterState::Heater *tool0 = state.printerState.temperature.findHeater("tool0");
+    CHECK(bed != nullptr);
+    CHECK(tool0 != nullptr);
+    if (bed != nullptr) CHECK_NEAR(60, bed->targetCelsius, 0.001);
+    if (tool0 != nullptr) CHECK_NEAR(215, tool0->targetCelsius, 0.001);
+    CHECK_NEAR(215, state.printerState.temperature.tool0TargetCelsius, 0.001);
+    CHECK(state.printerState.temperature.tool0CurrentCelsius >= 214 &&
+          state.printerState.temperature.tool0CurrentCelsius < 216);
+    // the history message brings 60 samples, each current message one more
+    CHECK(history.getSamples().size() > 60);
+
+    server.requestReauth();
+    CHECK(pollUntil(push, [&] { return !push.isPushActive(); }));
+    server.stop();
+}
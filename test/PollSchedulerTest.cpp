@@ -0,0 +1,162 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "PollScheduler.h"
+#include "ScriptedServer.h"
+#include "TestSupport.h"
+#include <vector>
+
+using namespace octoprint;
+using octoprint::test::ScriptedServer;
+using octoprint::test::response;
+
+namespace {
+
+const char *const versionBody = R"({"api":"0.1","server":"1.9.3","text":"OctoPrint 1.9.3"})";
+
+const char *const printingBody = R"({"state":{"flags":{"operational":true,"printing":true},"text":"Printing"},)"
+                                 R"("temperature":{"bed":{"actual":60.1,"target":60.0}}})";
+
+const char *const idleBody = R"({"state":{"flags":{"operational":true,"ready":true},"text":"Operational"},)"
+                             R"("temperature":{"bed":{"actual":21.0,"target":0.0}}})";
+
+/** Intervals long enough that only pollNow() starts requests, the job is not polled. */
+PollSchedulerSettings manualSettings() {
+    PollSchedulerSettings settings;
+    settings.active = {60000, 0};
+    settings.idle = {60000, 0};
+    settings.disconnected = {60000, 0};
+    settings.unreachableMs = 60000;
+    return settings;
+}
+
+/** Polls everything now, until the scheduler has nothing left to start. */
+void pollRound(PollScheduler &scheduler) {
+    scheduler.pollNow();
+    // the poll() completing a request returns false, the next one may start another request
+    for (unsigned idleCount = 0, attempt = 0; idleCount < 2 && attempt < 100000; attempt++) {
+        idleCount = scheduler.poll() ? 0 : idleCount + 1;
+    }
+}
+
+/**
+ * Polls for the duration.
+ * @return the times at which count() went up, i.e. requests were started
+ */
+template<typename Counter>
+std::vector<unsigned long> pollFor(PollScheduler &scheduler, unsigned long durationMs, Counter count) {
+    std::vector<unsigned long> startedMs;
+    const unsigned long beginMs = millis();
+    size_t counted = count();
+    while (millis() - beginMs < durationMs) {
+        scheduler.poll();
+        if (count() != counted) {
+            counted = count();
+            startedMs.push_back(millis());
+        }
+        delay(1);
+    }
+    return startedMs;
+}
+
+} // namespace
+
+TEST(profileFollowsThePrinterState) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    PollScheduler scheduler(printer, manualSettings());
+    CHECK_EQUAL(PollProfile::Idle, scheduler.getProfile());
+
+    server.answer(response(200, versionBody));
+    server.answer(response(200, printingBody));
+    pollRound(scheduler);
+    CHECK(scheduler.isVersionFetched());
+    CHECK_EQUAL(2u, server.requests.size());
+    CHECK_EQUAL(PollProfile::Active, scheduler.getProfile());
+
+    server.answer(response(200, idleBody));
+    pollRound(scheduler);
+    CHECK_EQUAL(PollProfile::Idle, scheduler.getProfile());
+
+    server.answer(response(409, "Printer is not operational"));
+    pollRound(scheduler);
+    CHECK_EQUAL(PollProfile::Disconnected, scheduler.getProfile());
+
+    server.answer(response(200, printingBody));
+    pollRound(scheduler);
+    CHECK_EQUAL(PollProfile::Active, scheduler.getProfile());
+    CHECK_EQUAL(5u, server.requests.size());
+}
+
+TEST(errorStatusDoesNotKeepTheStaleProfile) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    PollScheduler scheduler(printer, manualSettings());
+
+    server.answer(response(200, versionBody));
+    server.answer(response(200, printingBody));
+    pollRound(scheduler);
+    CHECK_EQUAL(PollProfile::Active, scheduler.getProfile());
+
+    // a wrong api key, the printing flag of the last good response is still set
+    server.answer(response(401, "Invalid API key"));
+    pollRound(scheduler);
+    CHECK(printer.getState().printerState.hasState(PrinterState::OperationalStateFlags::Printing));
+    CHECK_EQUAL(PollProfile::Disconnected, scheduler.getProfile());
+
+    server.answer(response(200, printingBody));
+    pollRound(scheduler);
+    CHECK_EQUAL(PollProfile::Active, scheduler.getProfile());
+
+    server.answer(response(503, "Service Unavailable"));
+    pollRound(scheduler);
+    CHECK_EQUAL(PollProfile::Disconnected, scheduler.getProfile());
+}
+
+TEST(disconnectedIntervalBacksOff) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    PollSchedulerSettings settings;
+    settings.disconnected = {10, 0};
+    settings.maxBackoffShift = 3;
+    PollScheduler scheduler(printer, settings);
+    // every /api/printer after the version is answered with 404
+    server.answer(response(200, versionBody));
+
+    const std::vector<unsigned long> startedMs = pollFor(scheduler, 400, [&] { return server.requests.size(); });
+    CHECK_EQUAL(PollProfile::Disconnected, scheduler.getProfile());
+    // version and printer right away, then 10, 20, 40, 80, 80.. ms apart
+    CHECK(startedMs.size() >= 6);
+    CHECK(startedMs.size() <= 10);
+    const unsigned long minimumGapsMs[] = {0, 9, 19, 39, 79, 79};
+    for (size_t idx = 1; idx < startedMs.size() && idx < 6; idx++) {
+        CHECK(startedMs[idx] - startedMs[idx - 1] >= minimumGapsMs[idx]);
+    }
+}
+
+TEST(unreachableIntervalBacksOff) {
+    ScriptedServer server;
+    OctoprintClient printer("key", server.connection, IPAddress(127, 0, 0, 1), 5000);
+    RequestMetrics metrics;
+    printer.setMetrics(&metrics);
+    PollSchedulerSettings settings;
+    settings.unreachableMs = 20;
+    settings.maxBackoffShift = 2;
+    PollScheduler scheduler(printer, settings);
+    server.connection.connectResult = 0;
+
+    const std::vector<unsigned long> startedMs = pollFor(scheduler, 400, [&] {
+        return metrics.get(Operation::FetchOctoprintVersion).requests;
+    });
+    CHECK_EQUAL(PollProfile::Unreachable, scheduler.getProfile());
+    CHECK(!scheduler.isVersionFetched());
+    // recorded on completion: 20, 40, 80, 80.. ms apart
+    CHECK(startedMs.size() >= 4);
+    CHECK(startedMs.size() <= 8);
+    const unsigned long minimumGapsMs[] = {0, 19, 39, 79, 79};
+    for (size_t idx = 1; idx < startedMs.size() && idx < 5; idx++) {
+        CHECK(startedMs[idx] - startedMs[idx - 1] >= minimumGapsMs[idx]);
+    }
+    CHECK(server.requests.empty());
+}
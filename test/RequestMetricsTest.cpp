@@ -0,0 +1,87 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "RequestMetrics.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+
+namespace {
+
+RequestSample sampleWith(int httpStatusCode, RequestOutcome outcome = RequestOutcome::Complete) {
+    RequestSample sample;
+    sample.httpStatusCode = httpStatusCode;
+    sample.outcome = outcome;
+    return sample;
+}
+
+} // namespace
+
+TEST(statusCodesCountedAsHttpErrors) {
+    RequestMetrics metrics;
+    for (int statusCode : {200, 201, 204, 304, -1}) metrics.record(Operation::FetchFiles, sampleWith(statusCode));
+    CHECK_EQUAL(5u, metrics.get(Operation::FetchFiles).requests);
+    CHECK_EQUAL(0u, metrics.get(Operation::FetchFiles).httpErrors);
+
+    for (int statusCode : {101, 301, 404, 409, 500}) metrics.record(Operation::FetchFiles, sampleWith(statusCode));
+    CHECK_EQUAL(5u, metrics.get(Operation::FetchFiles).httpErrors);
+}
+
+TEST(outcomesAreCountedApart) {
+    RequestMetrics metrics;
+    metrics.record(Operation::FetchPrintJob, sampleWith(-1, RequestOutcome::Timeout));
+    metrics.record(Operation::FetchPrintJob, sampleWith(200, RequestOutcome::Truncated));
+    metrics.record(Operation::FetchPrintJob, sampleWith(-1, RequestOutcome::ConnectionFailed));
+    metrics.record(Operation::FetchPrintJob, sampleWith(-1, RequestOutcome::ConnectionClosed));
+    metrics.record(Operation::FetchPrintJob, sampleWith(-1, RequestOutcome::Malformed));
+    const EndpointMetrics &job = metrics.get(Operation::FetchPrintJob);
+    CHECK_EQUAL(1u, job.timeouts);
+    CHECK_EQUAL(1u, job.truncations);
+    CHECK_EQUAL(1u, job.connectionFailures);
+    CHECK_EQUAL(2u, job.incompleteResponses);
+    CHECK_EQUAL(0u, metrics.get(Operation::FetchPrinterBed).requests);
+}
+
+TEST(connectsOnlyOfEstablishedConnections) {
+    RequestMetrics metrics;
+    RequestSample reused = sampleWith(200);
+    metrics.record(Operation::FetchPrintJob, reused);
+
+    RequestSample connected = sampleWith(200);
+    connected.isConnected = true;
+    connected.connectUs = 1500;
+    metrics.record(Operation::FetchPrintJob, connected);
+    connected.connectUs = 500;
+    metrics.record(Operation::FetchPrintJob, connected);
+
+    const EndpointMetrics &job = metrics.get(Operation::FetchPrintJob);
+    CHECK_EQUAL(2u, job.connects);
+    CHECK_EQUAL(2000u, job.connectUsTotal);
+    CHECK_EQUAL(1500u, job.connectUsMax);
+}
+
+TEST(latencyPercentiles) {
+    LatencyHistogram histogram;
+    CHECK_EQUAL(0u, histogram.getPercentileUs(50));
+    for (unsigned idx = 0; idx < 90; idx++) histogram.record(300);
+    for (unsigned idx = 0; idx < 9; idx++) histogram.record(15000);
+    histogram.record(5000000);
+    CHECK_EQUAL(100u, histogram.getCount());
+    CHECK_EQUAL(500u, histogram.getPercentileUs(50));
+    CHECK_EQUAL(500u, histogram.getPercentileUs(90));
+    CHECK_EQUAL(20000u, histogram.getPercentileUs(99));
+    CHECK_EQUAL(UINT32_MAX, histogram.getPercentileUs(100));
+}
+
+TEST(totalMergesAllEndpoints) {
+    RequestMetrics metrics;
+    metrics.record(Operation::FetchPrintJob, sampleWith(404));
+    metrics.record(Operation::FetchFiles, sampleWith(500));
+    const EndpointMetrics total = metrics.getTotal();
+    CHECK_EQUAL(2u, total.requests);
+    CHECK_EQUAL(2u, total.httpErrors);
+    CHECK_EQUAL(2u, total.latency.getCount());
+    metrics.reset();
+    CHECK_EQUAL(0u, metrics.getTotal().requests);
+}
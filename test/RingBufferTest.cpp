@@ -0,0 +1,63 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "RingBuffer.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+
+TEST(pushBelowCapacityKeepsTheOrder) {
+    RingBuffer<int, 4> buffer;
+    CHECK(buffer.isEmpty());
+    buffer.push(1);
+    buffer.push(2);
+    buffer.push(3);
+    CHECK_EQUAL(3u, buffer.size());
+    CHECK(!buffer.isFull());
+    CHECK_EQUAL(1, buffer[0]);
+    CHECK_EQUAL(3, buffer[2]);
+    CHECK_EQUAL(3, buffer.newest());
+}
+
+TEST(pushIntoAFullBufferOverwritesTheOldest) {
+    RingBuffer<int, 3> buffer;
+    for (int value = 1; value <= 3; value++) buffer.push(value);
+    CHECK(buffer.isFull());
+
+    buffer.push(4);
+    CHECK_EQUAL(3u, buffer.size());
+    CHECK_EQUAL(2, buffer[0]);
+    CHECK_EQUAL(3, buffer[1]);
+    CHECK_EQUAL(4, buffer[2]);
+    CHECK_EQUAL(4, buffer.newest());
+}
+
+TEST(indexingWrapsAroundRepeatedly) {
+    RingBuffer<int, 3> buffer;
+    for (int value = 1; value <= 11; value++) buffer.push(value);
+    CHECK_EQUAL(3u, buffer.size());
+    CHECK_EQUAL(9, buffer[0]);
+    CHECK_EQUAL(10, buffer[1]);
+    CHECK_EQUAL(11, buffer[2]);
+}
+
+TEST(clearEmptiesAndRestartsTheBuffer) {
+    RingBuffer<int, 2> buffer;
+    for (int value = 1; value <= 5; value++) buffer.push(value);
+    buffer.clear();
+    CHECK(buffer.isEmpty());
+
+    buffer.push(6);
+    CHECK_EQUAL(1u, buffer.size());
+    CHECK_EQUAL(6, buffer[0]);
+    CHECK_EQUAL(6, buffer.newest());
+}
+
+TEST(singleElementCapacity) {
+    RingBuffer<int, 1> buffer;
+    buffer.push(1);
+    buffer.push(2);
+    CHECK_EQUAL(1u, buffer.size());
+    CHECK_EQUAL(2, buffer[0]);
+}
@@ -0,0 +1,126 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <deque>
+#include <functional>
+#include <string>
+
+namespace octoprint {
+namespace test {
+
+/**
+ * Client playing back a scripted response. Each part is handed out on its own, as if it arrived in a packet of its
+ * own, so that tests control where reads split the data. Written bytes are collected.
+ */
+struct ScriptedClient : public Client {
+
+    /** Queues bytes to be received. */
+    void receive(const std::string &part) {
+        if (!part.empty()) parts.push_back(part);
+    }
+
+    /** Queues bytes to be received in parts of partLength bytes. */
+    void receiveSplit(const std::string &data, size_t partLength) {
+        for (size_t begin = 0; begin < data.size(); begin += partLength) receive(data.substr(begin, partLength));
+    }
+
+    /** @param isClosing the peer closes the connection once all parts were read, otherwise it stays silent */
+    void setClosingWhenDrained(bool isClosing) {
+        isClosingWhenDrained = isClosing;
+    }
+
+    int connect(IPAddress, uint16_t) override {
+        return connectOpen();
+    }
+
+    int connect(const char *, uint16_t) override {
+        return connectOpen();
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        written.append(reinterpret_cast<const char *>(buffer), size);
+        if (onWrite) {
+            // a copy, the callback may replace itself
+            const std::function<void(ScriptedClient &)> callback = onWrite;
+            callback(*this);
+        }
+        return size;
+    }
+
+    int available() override {
+        return parts.empty() ? 0 : static_cast<int>(parts.front().size() - offset);
+    }
+
+    int read() override {
+        uint8_t c;
+        return (read(&c, 1) == 1) ? c : -1;
+    }
+
+    int read(uint8_t *buffer, size_t size) override {
+        if (parts.empty()) return -1;
+        const std::string &part = parts.front();
+        size_t run = part.size() - offset;
+        if (run > size) run = size;
+        memcpy(buffer, part.data() + offset, run);
+        offset += run;
+        if (offset == part.size()) {
+            parts.pop_front();
+            offset = 0;
+        }
+        return static_cast<int>(run);
+    }
+
+    int peek() override {
+        return parts.empty() ? -1 : static_cast<uint8_t>(parts.front()[offset]);
+    }
+
+    void flush() override {}
+
+    void stop() override {
+        isOpen = false;
+        isStopped = true;
+        parts.clear();
+        offset = 0;
+    }
+
+    uint8_t connected() override {
+        return isOpen && (!parts.empty() || !isClosingWhenDrained);
+    }
+
+    operator bool() override {
+        return connected();
+    }
+
+    using Print::write;
+
+    // bytes the code under test sent
+    std::string written;
+    // invoked after each write, e.g. to answer a request
+    std::function<void(ScriptedClient &client)> onWrite;
+    // result of connect()
+    int connectResult{1};
+    bool isStopped{false};
+
+private:
+    std::deque<std::string> parts;
+    size_t offset{0};
+    bool isOpen{true};
+    bool isClosingWhenDrained{true};
+
+    int connectOpen() {
+        isOpen = connectResult != 0;
+        isStopped = false;
+        return connectResult;
+    }
+};
+
+} // namespace test
+} // namespace octoprint
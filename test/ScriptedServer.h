@@ -0,0 +1,71 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "ScriptedClient.h"
+
+namespace octoprint {
+namespace test {
+
+/** @return a response with the given status and body, its length is announced by Content-Length */
+inline std::string response(int statusCode, const std::string &body, const std::string &headers = "") {
+    return "HTTP/1.1 " + std::to_string(statusCode) + " Status\r\n" + headers +
+           "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+/**
+ * Answers each complete request the client wrote with the next scripted response, or 404 when there is none.
+ */
+struct ScriptedServer {
+
+    ScriptedServer() {
+        connection.setClosingWhenDrained(false);
+        connection.onWrite = [this](ScriptedClient &client) {
+            const size_t headerEnd = client.written.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) return;
+            size_t bodyLength = 0;
+            const size_t lengthBegin = client.written.find("Content-Length: ");
+            if (lengthBegin < headerEnd) bodyLength = strtoul(client.written.c_str() + lengthBegin + 16, nullptr, 10);
+            if (client.written.size() < headerEnd + 4 + bodyLength) return;
+
+            requests.push_back(client.written.substr(0, headerEnd + 4 + bodyLength));
+            client.written.erase(0, headerEnd + 4 + bodyLength);
+            if (responses.empty()) {
+                client.receive(response(404, ""));
+            } else {
+                client.receive(responses.front());
+                responses.erase(responses.begin());
+            }
+        };
+    }
+
+    void answer(const std::string &text) {
+        responses.push_back(text);
+    }
+
+    /** @return the request line of a recorded request, e.g. "GET /api/job HTTP/1.1" */
+    std::string requestLine(size_t idx) const {
+        return (idx < requests.size()) ? requests[idx].substr(0, requests[idx].find("\r\n")) : "";
+    }
+
+    /** @return the body of a recorded request */
+    std::string requestBody(size_t idx) const {
+        return (idx < requests.size()) ? requests[idx].substr(requests[idx].find("\r\n\r\n") + 4) : "";
+    }
+
+    bool hasHeader(size_t idx, const std::string &line) const {
+        return idx < requests.size() && requests[idx].find("\r\n" + line + "\r\n") != std::string::npos;
+    }
+
+    ScriptedClient connection;
+    std::vector<std::string> requests;
+    std::vector<std::string> responses;
+};
+
+} // namespace test
+} // namespace octoprint
@@ -0,0 +1,159 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "StateChangeNotifier.h"
+#include "TestSupport.h"
+#include <vector>
+
+using namespace octoprint;
+using Flags = PrinterState::OperationalStateFlags;
+
+namespace {
+
+/**
+ * Applies changes to a state like a fetch does, bumping the generations of the changed sections, and notifies.
+ */
+struct Fetches {
+
+    void setFlags(Flags flags) {
+        const StateGenerations previous = state.generations;
+        state.printerState.setState(flags);
+        state.generations.printerState++;
+        notifier.notify(state, previous);
+    }
+
+    void setHeater(uint8_t idx, const char *name, float current, float target) {
+        const StateGenerations previous = state.generations;
+        PrinterState::Thermal &temperature = state.printerState.temperature;
+        strncpy(temperature.heaters[idx].name, name, sizeof(temperature.heaters[idx].name));
+        temperature.heaters[idx].currentCelsius = current;
+        temperature.heaters[idx].targetCelsius = target;
+        if (temperature.heatersCount <= idx) temperature.heatersCount = idx + 1;
+        state.generations.thermal++;
+        notifier.notify(state, previous);
+    }
+
+    void setCompletion(float completion) {
+        const StateGenerations previous = state.generations;
+        state.printJob.progressCompletion = completion;
+        state.generations.job++;
+        notifier.notify(state, previous);
+    }
+
+    OverallState state;
+    internal::StateChangeNotifier notifier;
+};
+
+Flags operator|(Flags lhs, Flags rhs) {
+    return static_cast<Flags>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+}
+
+} // namespace
+
+TEST(stateFlagsCallbackFiresOnChangedFlagsOnly) {
+    Fetches fetches;
+    std::vector<std::pair<Flags, Flags>> reported;
+    fetches.notifier.setStateFlagsCallback([&](Flags previous, Flags current) {
+        reported.emplace_back(previous, current);
+    });
+
+    fetches.setFlags(Flags::Operational);
+    fetches.setFlags(Flags::Operational);
+    fetches.setFlags(Flags::Operational | Flags::Printing);
+    CHECK_EQUAL(2u, reported.size());
+    CHECK_EQUAL(Flags::Undefined, reported[0].first);
+    CHECK_EQUAL(Flags::Operational, reported[0].second);
+    CHECK_EQUAL(Flags::Operational, reported[1].first);
+    CHECK_EQUAL(Flags::Operational | Flags::Printing, reported[1].second);
+
+    // another section changing does not report the flags again
+    fetches.setCompletion(10);
+    CHECK_EQUAL(2u, reported.size());
+}
+
+TEST(temperatureCallbackRespectsTheDeadband) {
+    Fetches fetches;
+    std::vector<float> reported;
+    fetches.notifier.setTemperatureCallback(1.0f, [&](const PrinterState::Thermal &temperature) {
+        reported.push_back(temperature.heaters[0].currentCelsius);
+    });
+
+    fetches.setHeater(0, "tool0", 200.0f, 215.0f);
+    CHECK_EQUAL(1u, reported.size());
+
+    fetches.setHeater(0, "tool0", 200.6f, 215.0f);
+    fetches.setHeater(0, "tool0", 199.2f, 215.0f);
+    CHECK_EQUAL(1u, reported.size());
+
+    // drifts are measured against the last reported value, not the last fetched one
+    fetches.setHeater(0, "tool0", 201.2f, 215.0f);
+    CHECK_EQUAL(2u, reported.size());
+    CHECK_NEAR(201.2, reported.back(), 1e-3);
+
+    // any target change is reported
+    fetches.setHeater(0, "tool0", 201.2f, 215.5f);
+    CHECK_EQUAL(3u, reported.size());
+
+    // a heater being discovered is reported
+    fetches.setHeater(1, "bed", 20.0f, 0.0f);
+    CHECK_EQUAL(4u, reported.size());
+}
+
+TEST(jobStartAndFinishFollowTheStateFlags) {
+    Fetches fetches;
+    unsigned startedCount = 0;
+    unsigned finishedCount = 0;
+    fetches.notifier.setJobStartedCallback([&](const internal::JobRequest &) { startedCount++; });
+    fetches.notifier.setJobFinishedCallback([&](const internal::JobRequest &) { finishedCount++; });
+    // the display text plays no part
+    fetches.state.printJob.printerState = "Offline after error";
+
+    fetches.setFlags(Flags::Operational | Flags::Ready);
+    CHECK_EQUAL(0u, startedCount);
+
+    fetches.setFlags(Flags::Operational | Flags::Printing);
+    fetches.setCompletion(5);
+    CHECK_EQUAL(1u, startedCount);
+    CHECK_EQUAL(0u, finishedCount);
+
+    // a pause keeps the job active
+    fetches.setFlags(Flags::Operational | Flags::Paused);
+    fetches.setFlags(Flags::Operational | Flags::Printing);
+    CHECK_EQUAL(1u, startedCount);
+    CHECK_EQUAL(0u, finishedCount);
+
+    fetches.setFlags(Flags::Operational | Flags::Ready);
+    CHECK_EQUAL(1u, finishedCount);
+    fetches.setFlags(Flags::Operational | Flags::Ready);
+    CHECK_EQUAL(1u, finishedCount);
+
+    fetches.setFlags(Flags::Operational | Flags::Printing);
+    CHECK_EQUAL(2u, startedCount);
+}
+
+TEST(progressCallbackFiresPerStepWhileAJobIsActive) {
+    Fetches fetches;
+    std::vector<float> reported;
+    fetches.notifier.setProgressCallback(10.0f, [&](const internal::JobRequest &job) {
+        reported.push_back(job.progressCompletion);
+    });
+
+    fetches.setCompletion(15);
+    CHECK(reported.empty());
+
+    fetches.setFlags(Flags::Operational | Flags::Printing);
+    for (float completion : {0.0f, 5.0f, 9.9f, 12.0f, 19.0f, 25.0f, 100.0f}) fetches.setCompletion(completion);
+    CHECK_EQUAL(5u, reported.size());
+    CHECK_NEAR(15, reported[0], 1e-3);
+    CHECK_NEAR(0, reported[1], 1e-3);
+    CHECK_NEAR(12, reported[2], 1e-3);
+    CHECK_NEAR(25, reported[3], 1e-3);
+    CHECK_NEAR(100, reported[4], 1e-3);
+
+    // a new job reports its first step again
+    fetches.setFlags(Flags::Operational | Flags::Ready);
+    fetches.setCompletion(0);
+    fetches.setFlags(Flags::Operational | Flags::Printing);
+    CHECK_EQUAL(6u, reported.size());
+}
@@ -0,0 +1,102 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "StateSnapshots.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+
+namespace {
+
+String errorBodyNumbered(uint32_t number) {
+    return String("body of publication ") + String(static_cast<unsigned long>(number)) + " padded to be allocated";
+}
+
+// every field a reader checks is derived from the same number, a torn copy mixes two of them
+OverallState stateNumbered(uint32_t number) {
+    OverallState state;
+    state.generations.printerState = number;
+    state.generations.thermal = number;
+    state.generations.job = number;
+    state.generations.version = number;
+    state.httpStatusCode = static_cast<int>(number);
+    state.printerState.temperature.bedCurrentCelsius = static_cast<float>(number % 1000);
+    state.printerState.printerStateText = String(static_cast<unsigned long>(number));
+    // long enough to live on the heap, its copy is not a single store
+    state.httpErrorBody = errorBodyNumbered(number);
+    return state;
+}
+
+bool isConsistent(const OverallState &state) {
+    const uint32_t number = state.generations.printerState;
+    const String text(static_cast<unsigned long>(number));
+    return state.generations.thermal == number && state.generations.job == number &&
+           state.generations.version == number && state.httpStatusCode == static_cast<int>(number) &&
+           state.printerState.temperature.bedCurrentCelsius == static_cast<float>(number % 1000) &&
+           state.printerState.printerStateText == text &&
+           state.httpErrorBody == errorBodyNumbered(number);
+}
+
+} // namespace
+
+TEST(readReturnsTheLatestPublication) {
+    StateSnapshots snapshots;
+    CHECK(snapshots.publish(stateNumbered(1)));
+    CHECK(snapshots.publish(stateNumbered(2)));
+    const OverallState snapshot = snapshots.read();
+    CHECK_EQUAL(2u, snapshot.generations.printerState);
+    CHECK(isConsistent(snapshot));
+}
+
+TEST(readBeforeAnyPublicationReturnsTheDefaultState) {
+    StateSnapshots snapshots;
+    OverallState snapshot = stateNumbered(7);
+    snapshots.read(snapshot);
+    CHECK_EQUAL(0u, snapshot.generations.printerState);
+    CHECK_EQUAL(0, snapshot.httpStatusCode);
+}
+
+TEST(concurrentReadersOnlySeeWholePublications) {
+    StateSnapshots snapshots;
+    // the default state is not numbered, readers must not see it
+    CHECK(snapshots.publish(stateNumbered(0)));
+    std::atomic<bool> isWriting{true};
+    std::atomic<uint32_t> tornReads{0};
+    std::atomic<uint32_t> reorderedReads{0};
+    std::atomic<uint32_t> reads{0};
+
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 3; reader++) {
+        readers.emplace_back([&] {
+            OverallState snapshot;
+            uint32_t lastNumber = 0;
+            while (isWriting.load()) {
+                snapshots.read(snapshot);
+                if (!isConsistent(snapshot)) tornReads++;
+                if (snapshot.generations.printerState < lastNumber) reorderedReads++;
+                lastNumber = snapshot.generations.printerState;
+                reads++;
+            }
+        });
+    }
+
+    uint32_t published = 0;
+    uint32_t skipped = 0;
+    for (uint32_t number = 1; number <= 200000; number++) {
+        if (snapshots.publish(stateNumbered(number))) published++;
+        else skipped++;
+    }
+    isWriting.store(false);
+    for (std::thread &reader : readers) reader.join();
+
+    CHECK_EQUAL(0u, tornReads.load());
+    CHECK_EQUAL(0u, reorderedReads.load());
+    CHECK(reads.load() > 0);
+    CHECK(published > 0);
+    CHECK_EQUAL(200000u, published + skipped);
+    CHECK(isConsistent(snapshots.read()));
+}
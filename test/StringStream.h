@@ -0,0 +1,42 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+
+namespace octoprint {
+namespace test {
+
+/**
+ * Stream reading from a string, e.g. a response body.
+ */
+struct StringStream : public Stream {
+
+    explicit StringStream(const std::string &text) : text(text) {}
+
+    int available() override {
+        return static_cast<int>(text.size() - position);
+    }
+
+    int read() override {
+        return (position < text.size()) ? static_cast<uint8_t>(text[position++]) : -1;
+    }
+
+    int peek() override {
+        return (position < text.size()) ? static_cast<uint8_t>(text[position]) : -1;
+    }
+
+    size_t write(uint8_t) override {
+        return 0;
+    }
+
+private:
+    std::string text;
+    size_t position{0};
+};
+
+} // namespace test
+} // namespace octoprint
@@ -0,0 +1,129 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "TemperatureHistory.h"
+#include "TestSupport.h"
+
+using namespace octoprint;
+
+namespace {
+
+// the bed reads value, its target value + 1, tool0 twice the value, everything else 0
+TemperatureSample sampleAt(uint32_t timestamp, float value) {
+    TemperatureSample sample;
+    sample.timestamp = timestamp;
+    sample.values[TemperatureSample::BedActual] = value;
+    sample.values[TemperatureSample::BedTarget] = value + 1;
+    sample.values[TemperatureSample::Tool0Actual] = 2 * value;
+    return sample;
+}
+
+} // namespace
+
+TEST(samplesAreKeptOldestFirst) {
+    TemperatureHistory<4> history;
+    CHECK(history.add(sampleAt(100, 20)));
+    CHECK(history.add(sampleAt(102, 21)));
+    CHECK_EQUAL(2u, history.getSamples().size());
+    CHECK_EQUAL(100u, history.getSamples()[0].timestamp);
+    CHECK_NEAR(21, history.getSamples().newest().values[TemperatureSample::BedActual], 0.001);
+}
+
+TEST(rawSamplesWrapAroundAtCapacity) {
+    TemperatureHistory<3> history;
+    for (uint32_t timestamp = 1; timestamp <= 7; timestamp++) CHECK(history.add(sampleAt(timestamp, timestamp)));
+    CHECK_EQUAL(3u, history.getSamples().size());
+    CHECK_EQUAL(5u, history.getSamples()[0].timestamp);
+    CHECK_EQUAL(7u, history.getSamples().newest().timestamp);
+}
+
+TEST(samplesNotNewerThanTheNewestAreDropped) {
+    TemperatureHistory<8> history;
+    CHECK(history.add(sampleAt(100, 20)));
+    CHECK(!history.add(sampleAt(100, 30)));
+    CHECK(!history.add(sampleAt(99, 30)));
+    CHECK_EQUAL(1u, history.getSamples().size());
+    CHECK_NEAR(20, history.getSamples().newest().values[TemperatureSample::BedActual], 0.001);
+}
+
+TEST(backfillOverlappingPolledSamplesAddsOnlyNewerOnes) {
+    TemperatureHistory<16, 4, 1, 2> history;
+    for (uint32_t timestamp = 10; timestamp <= 13; timestamp++) history.add(sampleAt(timestamp, timestamp));
+
+    uint32_t added = 0;
+    for (uint32_t timestamp = 8; timestamp <= 16; timestamp++) {
+        if (history.add(sampleAt(timestamp, 100))) added++;
+    }
+    CHECK_EQUAL(3u, added);
+    CHECK_EQUAL(7u, history.getSamples().size());
+    CHECK_NEAR(13, history.getSamples()[3].values[TemperatureSample::BedActual], 0.001);
+    CHECK_EQUAL(14u, history.getSamples()[4].timestamp);
+    // dropped samples do not reach the aggregates either
+    CHECK_EQUAL(3u, history.getTier(0).size());
+}
+
+TEST(firstTierAggregatesMinimumMaximumAndMean) {
+    TemperatureHistory<8, 4, 2, 3> history;
+    history.add(sampleAt(10, 20));
+    history.add(sampleAt(12, 26));
+    CHECK(history.getTier(0).isEmpty());
+    history.add(sampleAt(14, 23));
+
+    CHECK_EQUAL(1u, history.getTier(0).size());
+    const TemperatureAggregate &aggregate = history.getTier(0).newest();
+    CHECK_EQUAL(10u, aggregate.firstTimestamp);
+    CHECK_EQUAL(14u, aggregate.lastTimestamp);
+    CHECK_EQUAL(3u, aggregate.count);
+    CHECK_NEAR(20, aggregate.minimum[TemperatureSample::BedActual], 0.001);
+    CHECK_NEAR(26, aggregate.maximum[TemperatureSample::BedActual], 0.001);
+    CHECK_NEAR(23, aggregate.mean[TemperatureSample::BedActual], 0.001);
+    CHECK_NEAR(24, aggregate.mean[TemperatureSample::BedTarget], 0.001);
+    CHECK_NEAR(40, aggregate.minimum[TemperatureSample::Tool0Actual], 0.001);
+    CHECK_NEAR(52, aggregate.maximum[TemperatureSample::Tool0Actual], 0.001);
+    CHECK_NEAR(0, aggregate.mean[TemperatureSample::Tool1Actual], 0.001);
+}
+
+TEST(higherTiersAggregateTheTierBelow) {
+    TemperatureHistory<4, 8, 2, 2> history;
+    // tier 0 gets (1, 2) (3, 4) (5, 6) (7, 8), tier 1 (1..4) (5..8)
+    for (uint32_t timestamp = 1; timestamp <= 8; timestamp++) history.add(sampleAt(timestamp, timestamp));
+
+    CHECK_EQUAL(4u, history.getTier(0).size());
+    CHECK_NEAR(3.5, history.getTier(0)[1].mean[TemperatureSample::BedActual], 0.001);
+
+    CHECK_EQUAL(2u, history.getTier(1).size());
+    const TemperatureAggregate &first = history.getTier(1)[0];
+    CHECK_EQUAL(1u, first.firstTimestamp);
+    CHECK_EQUAL(4u, first.lastTimestamp);
+    CHECK_EQUAL(4u, first.count);
+    CHECK_NEAR(1, first.minimum[TemperatureSample::BedActual], 0.001);
+    CHECK_NEAR(4, first.maximum[TemperatureSample::BedActual], 0.001);
+    CHECK_NEAR(2.5, first.mean[TemperatureSample::BedActual], 0.001);
+    const TemperatureAggregate &second = history.getTier(1)[1];
+    CHECK_EQUAL(5u, second.firstTimestamp);
+    CHECK_EQUAL(4u, second.count);
+    CHECK_NEAR(6.5, second.mean[TemperatureSample::BedActual], 0.001);
+}
+
+TEST(tiersWrapAroundAtCapacity) {
+    TemperatureHistory<2, 2, 1, 2> history;
+    for (uint32_t timestamp = 1; timestamp <= 8; timestamp++) history.add(sampleAt(timestamp, timestamp));
+    CHECK_EQUAL(2u, history.getTier(0).size());
+    CHECK_EQUAL(5u, history.getTier(0)[0].firstTimestamp);
+    CHECK_EQUAL(8u, history.getTier(0)[1].lastTimestamp);
+}
+
+TEST(clearDiscardsPartialAggregates) {
+    TemperatureHistory<4, 4, 1, 2> history;
+    history.add(sampleAt(1, 100));
+    history.clear();
+    CHECK(history.getSamples().isEmpty());
+
+    // the sample before clear() must not be merged into the first aggregate
+    history.add(sampleAt(1, 10));
+    history.add(sampleAt(2, 20));
+    CHECK_EQUAL(1u, history.getTier(0).size());
+    CHECK_EQUAL(2u, history.getTier(0).newest().count);
+    CHECK_NEAR(20, history.getTier(0).newest().maximum[TemperatureSample::BedActual], 0.001);
+}
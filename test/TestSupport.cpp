@@ -0,0 +1,52 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "TestSupport.h"
+#include <cstdio>
+#include <vector>
+
+namespace octoprint {
+namespace test {
+
+namespace {
+
+struct Test {
+    const char *name;
+    TestFunction function;
+};
+
+std::vector<Test> &registeredTests() {
+    static std::vector<Test> tests;
+    return tests;
+}
+
+unsigned failuresCount = 0;
+
+} // namespace
+
+Registration::Registration(const char *name, TestFunction function) {
+    registeredTests().push_back(Test{name, function});
+}
+
+void fail(const char *file, int line, const std::string &message) {
+    failuresCount++;
+    printf("%s:%d: failed: %s\n", file, line, message.c_str());
+}
+
+} // namespace test
+} // namespace octoprint
+
+int main() {
+    using namespace octoprint::test;
+    unsigned failedTests = 0;
+    for (const Test &test : registeredTests()) {
+        const unsigned failuresBefore = failuresCount;
+        test.function();
+        const bool isPassed = failuresCount == failuresBefore;
+        if (!isPassed) failedTests++;
+        printf("[%s] %s\n", isPassed ? "  OK  " : "FAILED", test.name);
+    }
+    printf("%u of %zu tests failed\n", failedTests, registeredTests().size());
+    return failedTests == 0 ? 0 : 1;
+}
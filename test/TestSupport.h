@@ -0,0 +1,77 @@
+/**
+ * Author: https://github.com/rubienr
+ *
+ * Minimal harness of the host unit tests: TEST() registers a test, CHECK() records a failure and carries on.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace octoprint {
+namespace test {
+
+using TestFunction = void (*)();
+
+struct Registration {
+    Registration(const char *name, TestFunction function);
+};
+
+void fail(const char *file, int line, const std::string &message);
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, std::string>::type describe(T value) {
+    std::ostringstream text;
+    // unary plus prints chars and uint8_t as numbers
+    text << +value;
+    return text.str();
+}
+
+template<typename T>
+typename std::enable_if<std::is_enum<T>::value, std::string>::type describe(T value) {
+    return describe(static_cast<long long>(value));
+}
+
+inline std::string describe(const std::string &value) {
+    return "\"" + value + "\"";
+}
+
+} // namespace test
+} // namespace octoprint
+
+#define TEST(name) \
+    static void name(); \
+    static const ::octoprint::test::Registration name##Registration{#name, &name}; \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) ::octoprint::test::fail(__FILE__, __LINE__, #condition); \
+    } while (false)
+
+#define CHECK_EQUAL(expected, actual) \
+    do { \
+        const auto expectedValue = (expected); \
+        const auto actualValue = (actual); \
+        if (!(expectedValue == actualValue)) { \
+            ::octoprint::test::fail(__FILE__, __LINE__, std::string(#actual " is ") + \
+                    ::octoprint::test::describe(actualValue) + ", expected " + \
+                    ::octoprint::test::describe(expectedValue)); \
+        } \
+    } while (false)
+
+/** Compares null terminated strings, or anything converting to std::string. */
+#define CHECK_STRING(expected, actual) CHECK_EQUAL(std::string(expected), std::string(actual))
+
+#define CHECK_NEAR(expected, actual, tolerance) \
+    do { \
+        const double difference = static_cast<double>(actual) - static_cast<double>(expected); \
+        if (difference > (tolerance) || difference < -(tolerance)) { \
+            ::octoprint::test::fail(__FILE__, __LINE__, std::string(#actual " is ") + \
+                    ::octoprint::test::describe(static_cast<double>(actual)) + ", expected " + \
+                    ::octoprint::test::describe(static_cast<double>(expected))); \
+        } \
+    } while (false)
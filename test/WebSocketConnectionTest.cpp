@@ -0,0 +1,298 @@
+/**
+ * Author: https://github.com/rubienr
+ */
+
+#include "ScriptedClient.h"
+#include "TestSupport.h"
+#include "WebSocketConnection.h"
+#include <vector>
+
+using namespace octoprint::internal;
+using octoprint::test::ScriptedClient;
+
+namespace {
+
+constexpr unsigned long timeoutMs = 50;
+
+/** A frame as servers send it, unmasked. */
+std::string serverFrame(uint8_t opcode, const std::string &payload, bool isFinal = true) {
+    std::string frame;
+    frame += static_cast<char>((isFinal ? 0x80 : 0x00) | opcode);
+    const uint64_t length = payload.size();
+    if (length < 126) {
+        frame += static_cast<char>(length);
+    } else if (length <= 0xffff) {
+        frame += static_cast<char>(126);
+        frame += static_cast<char>(length >> 8);
+        frame += static_cast<char>(length);
+    } else {
+        frame += static_cast<char>(127);
+        for (int shift = 56; shift >= 0; shift -= 8) frame += static_cast<char>(length >> shift);
+    }
+    return frame + payload;
+}
+
+struct ClientFrame {
+    uint8_t opcode;
+    bool isFinal;
+    bool isMasked;
+    std::string payload;
+};
+
+/** Splits the bytes a client wrote into frames and unmasks their payloads. */
+std::vector<ClientFrame> clientFrames(const std::string &written) {
+    std::vector<ClientFrame> frames;
+    size_t position = 0;
+    while (position + 2 <= written.size()) {
+        ClientFrame frame;
+        const uint8_t first = static_cast<uint8_t>(written[position++]);
+        const uint8_t second = static_cast<uint8_t>(written[position++]);
+        frame.opcode = first & 0x0f;
+        frame.isFinal = (first & 0x80) != 0;
+        frame.isMasked = (second & 0x80) != 0;
+        uint64_t length = second & 0x7f;
+        const uint8_t lengthBytes = (length == 126) ? 2 : (length == 127) ? 8 : 0;
+        if (lengthBytes > 0) length = 0;
+        for (uint8_t idx = 0; idx < lengthBytes; idx++) {
+            length = (length << 8) | static_cast<uint8_t>(written[position++]);
+        }
+        uint8_t mask[4] = {};
+        for (uint8_t idx = 0; frame.isMasked && idx < 4; idx++) mask[idx] = static_cast<uint8_t>(written[position++]);
+        for (uint64_t idx = 0; idx < length && position < written.size(); idx++) {
+            frame.payload += static_cast<char>(static_cast<uint8_t>(written[position++]) ^ mask[idx % 4]);
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+/** @return the value of a header in the written request or an empty string */
+std::string requestHeader(const std::string &request, const std::string &name) {
+    const size_t begin = request.find("\r\n" + name + ": ");
+    if (begin == std::string::npos) return "";
+    const size_t valueBegin = begin + name.size() + 4;
+    return request.substr(valueBegin, request.find("\r\n", valueBegin) - valueBegin);
+}
+
+/**
+ * Answers the handshake once the request is complete.
+ * @param accept Sec-WebSocket-Accept to answer with, computed from the request's key if empty
+ */
+void answerHandshake(ScriptedClient &client, const std::string &status = "101 Switching Protocols",
+                     const std::string &accept = "") {
+    client.onWrite = [status, accept](ScriptedClient &server) {
+        if (server.written.find("\r\n\r\n") == std::string::npos) return;
+        server.onWrite = nullptr;
+        char expected[29];
+        computeWebSocketAccept(requestHeader(server.written, "Sec-WebSocket-Key").c_str(), expected);
+        server.receive("HTTP/1.1 " + status + "\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "sec-websocket-accept: " + (accept.empty() ? std::string(expected) : accept) + "\r\n"
+                       "\r\n");
+    };
+}
+
+/** Opens the connection and forgets the handshake request. */
+void open(ScriptedClient &client, WebSocketConnection &connection) {
+    client.setClosingWhenDrained(false);
+    answerHandshake(client);
+    CHECK(connection.handshake("octopi.local", "/sockjs/websocket"));
+    client.written.clear();
+}
+
+std::string readMessage(WebSocketConnection &connection) {
+    std::string message;
+    for (int c = connection.read(); c >= 0; c = connection.read()) message += static_cast<char>(c);
+    return message;
+}
+
+} // namespace
+
+TEST(acceptOfTheRfc6455Example) {
+    // RFC 6455 section 1.3
+    char accept[29];
+    computeWebSocketAccept("dGhlIHNhbXBsZSBub25jZQ==", accept);
+    CHECK_STRING("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=", accept);
+}
+
+TEST(handshakeRequest) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    answerHandshake(client);
+    WebSocketConnection connection(client, timeoutMs);
+    CHECK(connection.handshake("octopi.local", "/sockjs/websocket"));
+    CHECK(connection.isOpen());
+    CHECK_EQUAL(0u, client.written.find("GET /sockjs/websocket HTTP/1.1\r\n"));
+    CHECK_STRING("octopi.local", requestHeader(client.written, "Host"));
+    CHECK_STRING("websocket", requestHeader(client.written, "Upgrade"));
+    CHECK_STRING("13", requestHeader(client.written, "Sec-WebSocket-Version"));
+    // base64 of 16 random bytes
+    CHECK_EQUAL(24u, requestHeader(client.written, "Sec-WebSocket-Key").size());
+}
+
+TEST(handshakeWithWrongAcceptFails) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    answerHandshake(client, "101 Switching Protocols", "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+    WebSocketConnection connection(client, timeoutMs);
+    CHECK(!connection.handshake("octopi.local", "/sockjs/websocket"));
+    CHECK(!connection.isOpen());
+}
+
+TEST(handshakeWithoutSwitchingFails) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    answerHandshake(client, "200 OK");
+    WebSocketConnection connection(client, timeoutMs);
+    CHECK(!connection.handshake("octopi.local", "/sockjs/websocket"));
+}
+
+TEST(framesFollowingTheHandshakeRightAway) {
+    ScriptedClient client;
+    client.setClosingWhenDrained(false);
+    client.onWrite = [](ScriptedClient &server) {
+        if (server.written.find("\r\n\r\n") == std::string::npos) return;
+        server.onWrite = nullptr;
+        char accept[29];
+        computeWebSocketAccept(requestHeader(server.written, "Sec-WebSocket-Key").c_str(), accept);
+        server.receive(std::string("HTTP/1.1 101 Switching Protocols\r\nSec-WebSocket-Accept: ") + accept + "\r\n\r\n" +
+                       serverFrame(0x1, "o"));
+    };
+    WebSocketConnection connection(client, timeoutMs);
+    CHECK(connection.handshake("octopi.local", "/sockjs/websocket"));
+    CHECK(connection.beginMessage());
+    CHECK_STRING("o", readMessage(connection));
+}
+
+TEST(textMessage) {
+    ScriptedClient client;
+    WebSocketConnection connection(client, timeoutMs);
+    open(client, connection);
+    CHECK(!connection.beginMessage());
+
+    client.receive(serverFrame(0x1, "a[\"{}\"]"));
+    CHECK(connection.beginMessage());
+    CHECK_EQUAL(7, connection.available());
+    CHECK_EQUAL('a', connection.peek());
+    CHECK_STRING("a[\"{}\"]", readMessage(connection));
+    CHECK(!connection.beginMessage());
+}
+
+TEST(fragmentedMessageWithInterleavedPing) {
+    ScriptedClient client;
+    WebSocketConnection connection(client, timeoutMs);
+    open(client, connection);
+    client.receive(serverFrame(0x1, "frag", false));
+    client.receive(serverFrame(0x0, "men", false));
+    client.receive(serverFrame(0x9, "beat"));
+    client.receive(serverFrame(0x0, "ted"));
+    CHECK(connection.beginMessage());
+    CHECK_STRING("fragmented", readMessage(connection));
+
+    const std::vector<ClientFrame> frames = clientFrames(client.written);
+    CHECK_EQUAL(1u, frames.size());
+    if (frames.size() == 1) {
+        CHECK_EQUAL(0xa, frames[0].opcode);
+        CHECK(frames[0].isMasked);
+        CHECK_STRING("beat", frames[0].payload);
+    }
+}
+
+TEST(unreadRestOfAMessageIsSkipped) {
+    ScriptedClient client;
+    WebSocketConnection connection(client, timeoutMs);
+    open(client, connection);
+    client.receive(serverFrame(0x1, "first", false));
+    client.receive(serverFrame(0x0, " message"));
+    client.receive(serverFrame(0x2, "binary"));
+    client.receive(serverFrame(0x1, "second"));
+    CHECK(connection.beginMessage());
+    CHECK_EQUAL('f', connection.read());
+    CHECK(connection.beginMessage());
+    CHECK_STRING("second", readMessage(connection));
+}
+
+TEST(lengthsOf16And64Bits) {
+    for (size_t length : {125, 126, 300, 0xffff, 0x10000, 70000}) {
+        ScriptedClient client;
+        WebSocketConnection connection(client, timeoutMs);
+        open(client, connection);
+        std::string payload(length, 'x');
+        payload.back() = 'y';
+        client.receiveSplit(serverFrame(0x1, payload), 1000);
+        CHECK(connection.beginMessage());
+        CHECK_EQUAL(length, readMessage(connection).size());
+        CHECK(connection.isOpen());
+    }
+}
+
+TEST(sentTextIsMaskedWithTheMatchingLength) {
+    for (size_t length : {5, 126, 300, 70000}) {
+        ScriptedClient client;
+        WebSocketConnection connection(client, timeoutMs);
+        open(client, connection);
+        const std::string text(length, 't');
+        CHECK(connection.sendText(text.c_str()));
+        const std::vector<ClientFrame> frames = clientFrames(client.written);
+        CHECK_EQUAL(1u, frames.size());
+        if (frames.size() != 1) continue;
+        CHECK_EQUAL(0x1, frames[0].opcode);
+        CHECK(frames[0].isFinal);
+        CHECK(frames[0].isMasked);
+        CHECK(frames[0].payload == text);
+    }
+}
+
+TEST(closeFromTheServerIsEchoed) {
+    ScriptedClient client;
+    WebSocketConnection connection(client, timeoutMs);
+    open(client, connection);
+    // 1001 going away
+    client.receive(serverFrame(0x8, std::string("\x03\xe9", 2) + "bye"));
+    CHECK(!connection.beginMessage());
+    CHECK(!connection.isOpen());
+    CHECK(client.isStopped);
+
+    const std::vector<ClientFrame> frames = clientFrames(client.written);
+    CHECK_EQUAL(1u, frames.size());
+    if (frames.size() == 1) {
+        CHECK_EQUAL(0x8, frames[0].opcode);
+        CHECK(frames[0].payload == std::string("\x03\xe9", 2));
+    }
+}
+
+TEST(closeWithinAFragmentedMessageEndsIt) {
+    ScriptedClient client;
+    WebSocketConnection connection(client, timeoutMs);
+    open(client, connection);
+    client.receive(serverFrame(0x1, "part", false));
+    client.receive(serverFrame(0x8, ""));
+    CHECK(connection.beginMessage());
+    CHECK_STRING("part", readMessage(connection));
+    CHECK(!connection.isOpen());
+}
+
+TEST(closeFromTheClient) {
+    ScriptedClient client;
+    WebSocketConnection connection(client, timeoutMs);
+    open(client, connection);
+    connection.close();
+    CHECK(client.isStopped);
+    CHECK(!connection.sendText("late"));
+    const std::vector<ClientFrame> frames = clientFrames(client.written);
+    CHECK_EQUAL(1u, frames.size());
+    if (frames.size() == 1) {
+        CHECK_EQUAL(0x8, frames[0].opcode);
+        CHECK(frames[0].payload == std::string("\x03\xe8", 2));
+    }
+}
+
+TEST(oversizedControlFrameFailsTheConnection) {
+    ScriptedClient client;
+    WebSocketConnection connection(client, timeoutMs);
+    open(client, connection);
+    client.receive(serverFrame(0x9, std::string(126, 'p')));
+    CHECK(!connection.beginMessage());
+    CHECK(!connection.isOpen());
+}